@@ -24,6 +24,7 @@
 #include "descriptor.h"
 #include "qresult.h"
 #include "pgtypes.h"
+#include "lobj.h"
 #include "multibyte.h"
 
 #include "pgapifunc.h"
@@ -65,7 +66,7 @@ PGAPI_BindParameter(HSTMT hstmt,
 		extend_iparameter_bindings(ipdopts, ipar);
 	pdata_info = SC_get_PDTI(stmt);
 	if (pdata_info->allocated < ipar)
-		extend_putdata_info(pdata_info, ipar, FALSE);
+		extend_putdata_info(pdata_info, ipar, FALSE, SC_get_conn(stmt));
 
 	/* use zero based column numbers for the below part */
 	ipar--;
@@ -251,6 +252,7 @@ inolog("Bind column 0 is type %d not of type SQL_C_BOOKMARK", fCType);
 		opts->bindings[icol].returntype = SQL_C_CHAR;
 		opts->bindings[icol].precision = 0;
 		opts->bindings[icol].scale = 0;
+		opts->bindings[icol].plan.compiled = FALSE;
 		if (gdata_info->gdata[icol].ttlbuf)
 			free(gdata_info->gdata[icol].ttlbuf);
 		gdata_info->gdata[icol].ttlbuf = NULL;
@@ -280,6 +282,7 @@ inolog("Bind column 0 is type %d not of type SQL_C_BOOKMARK", fCType);
 				break;
 		}
 		opts->bindings[icol].scale = 0;
+		opts->bindings[icol].plan.compiled = FALSE;
 
 		mylog("       bound buffer[%d] = %p\n", icol, opts->bindings[icol].buffer);
 	}
@@ -482,6 +485,7 @@ create_empty_bindings(int num_columns)
 		new_bindings[i].buffer = NULL;
 		new_bindings[i].used =
 		new_bindings[i].indicator = NULL;
+		new_bindings[i].plan.compiled = FALSE;
 	}
 
 	return new_bindings;
@@ -801,6 +805,7 @@ reset_a_column_binding(ARDFields *self, int icol)
 		self->bindings[icol].used =
 		self->bindings[icol].indicator = NULL;
 		self->bindings[icol].returntype = SQL_C_CHAR;
+		self->bindings[icol].plan.compiled = FALSE;
 	}
 }
 
@@ -831,6 +836,8 @@ inolog("GDATA_unbind_cols freeall=%d allocated=%d gdata=%p", freeall, self->allo
 	}
 	self->fdata.ttlbuflen = self->fdata.ttlbufused = 0;
 	self->fdata.data_left = -1;
+	self->fdata.data_pos = 0;
+	self->fdata.pending_wchar = 0;
 	for (lf = 1; lf <= self->allocated; lf++)
 		reset_a_getdata_info(self, lf);
 	if (freeall)
@@ -845,6 +852,8 @@ inolog("GDATA_unbind_cols freeall=%d allocated=%d gdata=%p", freeall, self->allo
 void GetDataInfoInitialize(GetDataInfo *gdata_info)
 {
 	gdata_info->fdata.data_left = -1;
+	gdata_info->fdata.data_pos = 0;
+	gdata_info->fdata.pending_wchar = 0;
 	gdata_info->fdata.ttlbuf = NULL;
 	gdata_info->fdata.ttlbuflen = gdata_info->fdata.ttlbufused = 0;
 	gdata_info->allocated = 0;
@@ -863,6 +872,8 @@ create_empty_gdata(int num_columns)
 	for (i = 0; i < num_columns; i++)
 	{
 		new_gdata[i].data_left = -1;
+		new_gdata[i].data_pos = 0;
+		new_gdata[i].pending_wchar = 0;
 		new_gdata[i].ttlbuf = NULL;
 		new_gdata[i].ttlbuflen = 0;
 		new_gdata[i].ttlbufused = 0;
@@ -943,6 +954,8 @@ void	reset_a_getdata_info(GetDataInfo *gdata_info, int icol)
 	gdata_info->gdata[icol].ttlbuflen =
 	gdata_info->gdata[icol].ttlbufused = 0;
 	gdata_info->gdata[icol].data_left = -1;
+	gdata_info->gdata[icol].data_pos = 0;
+	gdata_info->gdata[icol].pending_wchar = 0;
 }
 
 void PutDataInfoInitialize(PutDataInfo *pdata_info)
@@ -951,7 +964,7 @@ void PutDataInfoInitialize(PutDataInfo *pdata_info)
 	pdata_info->pdata = NULL;
 }
 void
-extend_putdata_info(PutDataInfo *self, int num_params, BOOL shrink)
+extend_putdata_info(PutDataInfo *self, int num_params, BOOL shrink, ConnectionClass *conn)
 {
 	CSTR func = "extend_putdata_info";
 	PutDataClass	*new_pdata;
@@ -989,7 +1002,7 @@ extend_putdata_info(PutDataInfo *self, int num_params, BOOL shrink)
 		int	i;
 
 		for (i = self->allocated; i > num_params; i--)
-			reset_a_putdata_info(self, i);
+			reset_a_putdata_info(self, i, conn);
 		self->allocated = num_params;
 		if (0 == num_params)
 		{
@@ -1000,11 +1013,15 @@ extend_putdata_info(PutDataInfo *self, int num_params, BOOL shrink)
 
 	mylog("exit %s=%p\n", func, self->pdata);
 }
-void	reset_a_putdata_info(PutDataInfo *pdata_info, int ipar)
+void	reset_a_putdata_info(PutDataInfo *pdata_info, int ipar, ConnectionClass *conn)
 {
 	if (ipar < 1 || ipar > pdata_info->allocated)
 		return;
 	ipar--;
+	/* the temporary large object of bytea data at execution */
+	if (pdata_info->pdata[ipar].lobj_temporary && NULL != conn &&
+		!odbc_lo_unlink_if_exists(conn, pdata_info->pdata[ipar].lobj_oid))
+		mylog("%s: couldn't unlink large object %u\n", __FUNCTION__, pdata_info->pdata[ipar].lobj_oid);
 	if (pdata_info->pdata[ipar].EXEC_used)
 	{
 		free(pdata_info->pdata[ipar].EXEC_used);
@@ -1016,6 +1033,7 @@ void	reset_a_putdata_info(PutDataInfo *pdata_info, int ipar)
 		pdata_info->pdata[ipar].EXEC_buffer = NULL;
 	}
 	pdata_info->pdata[ipar].lobj_oid = 0;
+	pdata_info->pdata[ipar].lobj_temporary = FALSE;
 }
 
 void SC_param_next(const StatementClass *stmt, int *param_number, ParameterInfoClass **apara, ParameterImplClass **ipara)
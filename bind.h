@@ -12,6 +12,24 @@
 #include "psqlodbc.h"
 #include "descriptor.h"
 
+/*
+ * ConvertPlan -- the conversion of a bound column compiled for the type
+ * of the result column, see bind_convert_plan() in convert.c.
+ * 'convert' stores a value of the column at 'dest' and returns FALSE
+ * if it has to be converted by copy_and_convert_field() instead.
+ */
+typedef BOOL (*FieldConvertProc)(char *value, char *dest);
+typedef struct
+{
+	char	compiled;
+	char	binary;
+	SQLSMALLINT	ctype;		/* the returntype compiled for */
+	OID	pgtype;			/* the field type compiled for */
+	int	atttypmod;
+	FieldConvertProc	convert;	/* NULL if there's no plan */
+	SQLLEN	len;			/* the length of the converted value */
+}	ConvertPlan;
+
 /*
  * BindInfoClass -- stores information about a bound column
  */
@@ -27,6 +45,7 @@ struct BindInfoClass_
 					 * SQL_C_CHAR... etc) */
 	SQLSMALLINT	precision;	/* the precision for numeric or timestamp type */
 	SQLSMALLINT	scale;		/* the scale for numeric type */
+	ConvertPlan	plan;		/* the conversion of the fetched values */
 	/* area for work variables */
 	char	dummy_data;		/* currently not used */
 };
@@ -37,6 +56,10 @@ typedef struct
 	SQLLEN	ttlbufused;		/* used length of the buffer */
 	SQLLEN	data_left;		/* amount of data left to read
 					 * (SQLGetData) */
+	SQLLEN	data_pos;		/* position in the value of the data
+					 * left, when converted piece by piece */
+	SQLWCHAR pending_wchar;		/* the wide character converted but
+					 * not returned yet */
 }	GetDataClass;
 
 /*
@@ -60,6 +83,7 @@ typedef struct
 	SQLLEN	*EXEC_used;	/* amount of data */
 	char	*EXEC_buffer; 	/* the data */
 	OID	lobj_oid;
+	char	lobj_temporary;	/* lobj_oid holds bytea data (SQLPutData) */
 }	PutDataClass;
 
 /*
@@ -106,8 +130,8 @@ void	extend_getdata_info(GetDataInfo *gdata, int num_columns, BOOL shrink);
 void	reset_a_getdata_info(GetDataInfo *gdata, int icol);
 void	GDATA_unbind_cols(GetDataInfo *gdata, BOOL freeall);
 void	PutDataInfoInitialize(PutDataInfo *pdata);
-void	extend_putdata_info(PutDataInfo *pdata, int num_params, BOOL shrink);
-void	reset_a_putdata_info(PutDataInfo *pdata, int ipar);
+void	extend_putdata_info(PutDataInfo *pdata, int num_params, BOOL shrink, ConnectionClass *conn);
+void	reset_a_putdata_info(PutDataInfo *pdata, int ipar, ConnectionClass *conn);
 void	PDATA_free_params(PutDataInfo *pdata, char option);
 void	SC_param_next(const StatementClass*, int *param_number, ParameterInfoClass **, ParameterImplClass **);
 
@@ -166,4 +166,5 @@ CI_set_field_info(ColumnInfoClass *self, int field_num, char *new_name,
 	self->coli_array[field_num].display_size = 0;
 	self->coli_array[field_num].relid = new_relid;
 	self->coli_array[field_num].attid = new_attid;
+	self->coli_array[field_num].format = 0;
 }
@@ -38,6 +38,7 @@
 #include "environ.h"
 #include "statement.h"
 #include "qresult.h"
+#include "convert.h"
 #include "lobj.h"
 #include "dlg_specific.h"
 #include "loadlib.h"
@@ -48,13 +49,16 @@
 
 #define STMT_INCREMENT 16		/* how many statement holders to allocate
 								 * at a time */
+#define STMT_POOL_SIZE	16		/* how many dropped statements to keep
+								 * for reuse */
+/* the settings the driver expects of a session */
+#define	DRIVER_SESSION_SETTINGS	"set DateStyle to 'ISO';set extra_float_digits to 2"
 
-static void CC_lookup_lo(ConnectionClass *self);
+static BOOL CC_release_to_pool(ConnectionClass *self);
+static void CC_reset_stmt_slots(ConnectionClass *self);
 static char *CC_create_errormsg(ConnectionClass *self);
 static int  CC_close_eof_cursors(ConnectionClass *self);
 
-static void LIBPQ_update_transaction_status(ConnectionClass *self);
-
 extern GLOBAL_VALUES globals;
 
 
@@ -210,6 +214,9 @@ PGAPI_Disconnect(HDBC hdbc)
 	}
 
 	logs_on_off(-1, conn->connInfo.drivers.debug, conn->connInfo.drivers.commlog);
+	/* Keep the session for a later connection */
+	if (conn->connInfo.connection_pool)
+		CC_release_to_pool(conn);
 	mylog("%s: about to CC_cleanup\n", func);
 
 	/* Close the connection and free statements */
@@ -285,9 +292,21 @@ CC_conninfo_init(ConnInfo *conninfo, UInt4 option)
 	conninfo->accessible_only = -1;
 	conninfo->ignore_round_trip_time = -1;
 	conninfo->disable_keepalive = -1;
+	conninfo->pipeline_param_array = -1;
+	conninfo->copy_param_array = -1;
+	conninfo->binary_result = -1;
+	conninfo->stream_results = -1;
+	conninfo->fetch_ahead = -1;
+	conninfo->shared_colinfo = -1;
+	conninfo->catalog_notify = -1;
+	conninfo->connection_pool = -1;
 	conninfo->gssauth_use_gssapi = -1;
 	conninfo->keepalive_idle = -1;
 	conninfo->keepalive_interval = -1;
+	conninfo->insert_batch_rows = -1;
+	conninfo->insert_batch_bytes = -1;
+	conninfo->fetch_cache_bytes = -1;
+	conninfo->prepared_cache_size = -1;
 #ifdef	_HANDLE_ENLIST_IN_DTC_
 	conninfo->xa_opt = -1;
 #endif /* _HANDLE_ENLIST_IN_DTC_ */
@@ -337,10 +356,22 @@ CC_copy_conninfo(ConnInfo *ci, const ConnInfo *sci)
 	CORR_VALCPY(accessible_only);
 	CORR_VALCPY(ignore_round_trip_time);
 	CORR_VALCPY(disable_keepalive);
+	CORR_VALCPY(pipeline_param_array);
+	CORR_VALCPY(copy_param_array);
+	CORR_VALCPY(binary_result);
+	CORR_VALCPY(stream_results);
+	CORR_VALCPY(fetch_ahead);
+	CORR_VALCPY(shared_colinfo);
+	CORR_VALCPY(catalog_notify);
+	CORR_VALCPY(connection_pool);
 	CORR_VALCPY(gssauth_use_gssapi);
 	CORR_VALCPY(extra_opts);
 	CORR_VALCPY(keepalive_idle);
 	CORR_VALCPY(keepalive_interval);
+	CORR_VALCPY(insert_batch_rows);
+	CORR_VALCPY(insert_batch_bytes);
+	CORR_VALCPY(fetch_cache_bytes);
+	CORR_VALCPY(prepared_cache_size);
 #ifdef	_HANDLE_ENLIST_IN_DTC_
 	CORR_VALCPY(xa_opt);
 #endif
@@ -391,6 +422,9 @@ CC_initialize(ConnectionClass *rv, BOOL lockinit)
 	rv->status = CONN_NOT_CONNECTED;
 	rv->transact_status = CONN_IN_AUTOCOMMIT;		/* autocommit by default */
 	rv->unnamed_prepared_stmt = NULL;
+	rv->stream_res = NULL;
+	rv->async_stmt = NULL;
+	rv->fetch_ahead_res = NULL;
 
 	rv->stmts = (StatementClass **) malloc(sizeof(StatementClass *) * STMT_INCREMENT);
 	if (!rv->stmts)
@@ -398,6 +432,10 @@ CC_initialize(ConnectionClass *rv, BOOL lockinit)
 	memset(rv->stmts, 0, sizeof(StatementClass *) * STMT_INCREMENT);
 
 	rv->num_stmts = STMT_INCREMENT;
+	rv->free_stmt_slots = (Int2 *) malloc(sizeof(Int2) * STMT_INCREMENT);
+	if (!rv->free_stmt_slots)
+		goto cleanup;
+	CC_reset_stmt_slots(rv);
 	rv->descs = (DescriptorClass **) malloc(sizeof(DescriptorClass *) * STMT_INCREMENT);
 	if (!rv->descs)
 		goto cleanup;
@@ -461,6 +499,11 @@ CC_Destructor(ConnectionClass *self)
 		free(self->stmts);
 		self->stmts = NULL;
 	}
+	if (self->free_stmt_slots)
+	{
+		free(self->free_stmt_slots);
+		self->free_stmt_slots = NULL;
+	}
 	if (self->descs)
 	{
 		free(self->descs);
@@ -626,6 +669,25 @@ CC_set_autocommit(ConnectionClass *self, BOOL on)
 	return on;
 }
 
+/* Forget the cached plans */
+static void
+CC_clear_cached_plans(ConnectionClass *self)
+{
+	int	i;
+
+	for (i = 0; i < self->num_cached_plans; i++)
+	{
+		free(self->cached_plans[i].query);
+		if (self->cached_plans[i].param_types)
+			free(self->cached_plans[i].param_types);
+	}
+	if (self->cached_plans)
+		free(self->cached_plans);
+	self->cached_plans = NULL;
+	self->num_cached_plans = 0;
+	self->cached_plans_allocated = 0;
+}
+
 /* Clear cached table info */
 static void
 CC_clear_col_info(ConnectionClass *self, BOOL destroy)
@@ -659,6 +721,75 @@ CC_clear_col_info(ConnectionClass *self, BOOL destroy)
 	}
 }
 
+/* Clear the cached info of the table 'reloid' */
+static void
+CC_evict_col_info(ConnectionClass *self, OID reloid)
+{
+	int	i;
+	COL_INFO	*coli;
+
+	for (i = 0; i < self->ntables; i++)
+	{
+		if (coli = self->col_info[i], NULL == coli)
+			continue;
+		if (0 != reloid && coli->table_oid != reloid)
+			continue;
+		mylog("evicting col_info table=%u\n", coli->table_oid);
+		if (coli->refcnt == 0)
+			free_col_info_contents(coli)
+		else
+		{
+			/* freed when released, but no longer found */
+			coli->table_oid = 0;
+			NULL_THE_NAME(coli->table_name);
+			coli->acc_time = 0;
+		}
+	}
+	if (self->connInfo.shared_colinfo)
+		clearSharedColInfo(self, reloid);
+}
+
+/*
+ *	Evict the cached info of the tables whose changes are notified on
+ *	CATALOG_NOTIFY_CHANNEL. 'consume' tells to read the notifications
+ *	which arrived while the connection was idle.
+ */
+void
+CC_receive_catalog_notify(ConnectionClass *self, BOOL consume)
+{
+	PGnotify	*notify;
+	char		*oids, *ptr;
+
+	if (!self->pqconn)
+		return;
+	if (consume && !PQconsumeInput(self->pqconn))
+		return;
+	while (notify = PQnotifies(self->pqconn), NULL != notify)
+	{
+		if (strcmp(notify->relname, CATALOG_NOTIFY_CHANNEL) == 0)
+		{
+			mylog("%s: catalog changes '%s'\n", __FUNCTION__, notify->extra);
+			oids = notify->extra;
+			if (NULL == oids || '\0' == *oids)
+				CC_evict_col_info(self, 0);
+			else
+			{
+				for (ptr = oids; '\0' != *ptr;)
+				{
+					OID	reloid = (OID) strtoul(ptr, &ptr, 10);
+
+					if (0 != reloid)
+						CC_evict_col_info(self, reloid);
+					if (',' != *ptr)
+						break;
+					ptr++;
+				}
+			}
+		}
+		PQfreemem(notify);
+	}
+}
+
 /* This is called by SQLDisconnect also */
 char
 CC_cleanup(ConnectionClass *self, BOOL keepCommunication)
@@ -681,6 +812,9 @@ CC_cleanup(ConnectionClass *self, BOOL keepCommunication)
 		PQfinish(self->pqconn);
 		self->pqconn = NULL;
 	}
+	self->stream_res = NULL;
+	self->async_stmt = NULL;
+	self->fetch_ahead_res = NULL;
 
 	mylog("after PQfinish\n");
 
@@ -697,6 +831,15 @@ CC_cleanup(ConnectionClass *self, BOOL keepCommunication)
 			self->stmts[i] = NULL;
 		}
 	}
+	CC_reset_stmt_slots(self);
+	/* Free the statements kept for reuse */
+	while (stmt = self->pooled_stmts, NULL != stmt)
+	{
+		self->pooled_stmts = stmt->next_pooled;
+		stmt->hdbc = NULL;
+		SC_Destructor(stmt);
+	}
+	self->num_pooled_stmts = 0;
 	/* Free all the descs on this connection */
 	for (i = 0; i < self->num_descs; i++)
 	{
@@ -738,10 +881,18 @@ CC_cleanup(ConnectionClass *self, BOOL keepCommunication)
 			free(self->server_encoding);
 			self->server_encoding = NULL;
 		}
+		if (self->pool_key)
+		{
+			free(self->pool_key);
+			self->pool_key = NULL;
+		}
 		reset_current_schema(self);
 	}
 	/* Free cached table info */
 	CC_clear_col_info(self, TRUE);
+	/* The cached plans are gone with the session */
+	CC_clear_cached_plans(self);
+	clear_sql_templates(self);
 	if (self->num_discardp > 0 && self->discardp)
 	{
 		for (i = 0; i < self->num_discardp; i++)
@@ -989,8 +1140,12 @@ static char CC_initial_log(ConnectionClass *self, const char *func)
 	return 1;
 }
 
-static	char	CC_setenv(ConnectionClass *self);
 static int LIBPQ_connect(ConnectionClass *self);
+static BOOL CC_get_pooled_connection(ConnectionClass *self);
+/*
+ *	Returns 2 if the connection was taken from the pool, whose
+ *	session needs no probes.
+ */
 static char
 LIBPQ_CC_connect(ConnectionClass *self, char *salt_para)
 {
@@ -1002,9 +1157,11 @@ LIBPQ_CC_connect(ConnectionClass *self, char *salt_para)
 	if (0 == CC_initial_log(self, func))
 		return 0;
 
+	if (self->connInfo.connection_pool &&
+	    CC_get_pooled_connection(self))
+		return 2;
 	if (ret = LIBPQ_connect(self), ret <= 0)
 		return ret;
-	CC_setenv(self);
 
 	return 1;
 }
@@ -1015,6 +1172,8 @@ CC_connect(ConnectionClass *self, char *salt_para)
 	ConnInfo *ci = &(self->connInfo);
 	CSTR	func = "CC_connect";
 	char		ret, *saverr = NULL, retsend;
+	char		set_query[128];
+	BOOL		pooled;
 
 	mylog("%s: entering...\n", func);
 
@@ -1023,6 +1182,7 @@ CC_connect(ConnectionClass *self, char *salt_para)
 	ret = LIBPQ_CC_connect(self, salt_para);
 	if (ret <= 0)
 		return ret;
+	pooled = (2 == ret);
 
 	CC_set_translation(self);
 
@@ -1036,14 +1196,25 @@ CC_connect(ConnectionClass *self, char *salt_para)
 	 * rules.  Therefore, these functions call the corresponding local
 	 * function instead.
 	 */
+	/*
+	 * A pooled session has got the settings of the driver and the
+	 * results of the probes already. The rest is sent in one query.
+	 */
+	set_query[0] = '\0';
+	if (!pooled)
+		strcpy(set_query, DRIVER_SESSION_SETTINGS);
+	if (ci->catalog_notify)
+	{
+		if (set_query[0])
+			strcat(set_query, ";");
+		strcat(set_query, "LISTEN " CATALOG_NOTIFY_CHANNEL);
+	}
 inolog("CC_send_settings\n");
-	retsend = CC_send_settings(self);
+	retsend = CC_send_settings(self, set_query[0] ? set_query : NULL, !pooled);
 
 	if (CC_get_errornumber(self) > 0)
 		saverr = strdup(CC_get_errormsg(self));
 	CC_clear_error(self);			/* clear any error */
-	CC_lookup_lo(self);			/* a hack to get the oid of
-						   our large object oid type */
 
 	/* Multibyte handling */
 	CC_lookup_characterset(self);
@@ -1107,19 +1278,10 @@ CC_add_statement(ConnectionClass *self, StatementClass *stmt)
 	mylog("CC_add_statement: self=%p, stmt=%p\n", self, stmt);
 
 	CONNLOCK_ACQUIRE(self);
-	for (i = 0; i < self->num_stmts; i++)
-	{
-		if (!self->stmts[i])
-		{
-			stmt->hdbc = self;
-			self->stmts[i] = stmt;
-			break;
-		}
-	}
-
-	if (i >= self->num_stmts) /* no more room -- allocate more memory */
+	if (self->num_free_stmt_slots <= 0) /* no more room -- allocate more memory */
 	{
 		StatementClass **newstmts;
+		Int2 *newslots = NULL;
 		Int2 new_num_stmts;
 
 		new_num_stmts = STMT_INCREMENT + self->num_stmts;
@@ -1129,24 +1291,51 @@ CC_add_statement(ConnectionClass *self, StatementClass *stmt)
 				realloc(self->stmts, sizeof(StatementClass *) * new_num_stmts);
 		else
 			newstmts = NULL; /* num_stmts overflowed */
-		if (!newstmts)
-			ret = FALSE;
-		else
+		if (newstmts)
 		{
 			self->stmts = newstmts;
 			memset(&self->stmts[self->num_stmts], 0, sizeof(StatementClass *) * STMT_INCREMENT);
-
-			stmt->hdbc = self;
-			self->stmts[self->num_stmts] = stmt;
-
+			newslots = (Int2 *)
+				realloc(self->free_stmt_slots, sizeof(Int2) * new_num_stmts);
+		}
+		if (newslots)
+		{
+			self->free_stmt_slots = newslots;
+			for (i = new_num_stmts - 1; i >= self->num_stmts; i--)
+				self->free_stmt_slots[self->num_free_stmt_slots++] = i;
 			self->num_stmts = new_num_stmts;
 		}
 	}
+	if (self->num_free_stmt_slots > 0)
+	{
+		i = self->free_stmt_slots[--self->num_free_stmt_slots];
+		stmt->hdbc = self;
+		stmt->conn_slot = i;
+		self->stmts[i] = stmt;
+	}
+	else
+		ret = FALSE;
 	CONNLOCK_RELEASE(self);
 
 	return ret;
 }
 
+/*
+ *	Make all the slots of stmts free. The lowest indexes are on the
+ *	top of the stack.
+ */
+static void
+CC_reset_stmt_slots(ConnectionClass *self)
+{
+	int	i;
+
+	self->num_free_stmt_slots = 0;
+	if (!self->free_stmt_slots)
+		return;
+	for (i = self->num_stmts - 1; i >= 0; i--)
+		self->free_stmt_slots[self->num_free_stmt_slots++] = i;
+}
+
 static void
 CC_set_error_statements(ConnectionClass *self)
 {
@@ -1169,20 +1358,61 @@ CC_remove_statement(ConnectionClass *self, StatementClass *stmt)
 	char	ret = FALSE;
 
 	CONNLOCK_ACQUIRE(self);
-	for (i = 0; i < self->num_stmts; i++)
+	i = stmt->conn_slot;
+	if (i >= 0 && i < self->num_stmts &&
+	    self->stmts[i] == stmt && stmt->status != STMT_EXECUTING)
 	{
-		if (self->stmts[i] == stmt && stmt->status != STMT_EXECUTING)
-		{
-			self->stmts[i] = NULL;
-			ret = TRUE;
-			break;
-		}
+		self->stmts[i] = NULL;
+		stmt->conn_slot = -1;
+		self->free_stmt_slots[self->num_free_stmt_slots++] = i;
+		ret = TRUE;
+	}
+	CONNLOCK_RELEASE(self);
+
+	return ret;
+}
+
+/*
+ *	Keep a dropped statement for reuse by CC_get_pooled_statement().
+ *	The statement must have been reinitialized. Returns FALSE if the
+ *	pool is full.
+ */
+char
+CC_pool_statement(ConnectionClass *self, StatementClass *stmt)
+{
+	char	ret = FALSE;
+
+	CONNLOCK_ACQUIRE(self);
+	if (self->num_pooled_stmts < STMT_POOL_SIZE)
+	{
+		stmt->next_pooled = self->pooled_stmts;
+		self->pooled_stmts = stmt;
+		self->num_pooled_stmts++;
+		ret = TRUE;
 	}
 	CONNLOCK_RELEASE(self);
+	mylog("CC_pool_statement: self=%p, stmt=%p pooled=%d\n", self, stmt, ret);
 
 	return ret;
 }
 
+StatementClass *
+CC_get_pooled_statement(ConnectionClass *self)
+{
+	StatementClass	*stmt;
+
+	CONNLOCK_ACQUIRE(self);
+	if (stmt = self->pooled_stmts, NULL != stmt)
+	{
+		self->pooled_stmts = stmt->next_pooled;
+		stmt->next_pooled = NULL;
+		self->num_pooled_stmts--;
+	}
+	CONNLOCK_RELEASE(self);
+
+	return stmt;
+}
+
 char CC_get_escape(const ConnectionClass *self)
 {
 	const char	   *scf;
@@ -1552,6 +1782,7 @@ CC_send_query_append(ConnectionClass *self, const char *query, QueryInfo *qi, UD
 			   *res = NULL;
 	BOOL	ignore_abort_on_conn = ((flag & IGNORE_ABORT_ON_CONN) != 0),
 		create_keyset = ((flag & CREATE_KEYSET) != 0),
+		stream, async,
 		issue_begin = ((flag & GO_INTO_TRANSACTION) != 0 && !CC_is_in_trans(self)),
 		rollback_on_error, query_rollback, end_with_commit;
 
@@ -1591,6 +1822,8 @@ CC_send_query_append(ConnectionClass *self, const char *query, QueryInfo *qi, UD
 		CC_on_abort(self, CONN_DEAD);
 		return NULL;
 	}
+	if (CC_async_busy(self, stmt, func))
+		return NULL;
 
 	ENTER_INNER_CONN_CS(self, func_cs_count);
 /* Indicate that we are sending a query to the backend */
@@ -1599,6 +1832,8 @@ CC_send_query_append(ConnectionClass *self, const char *query, QueryInfo *qi, UD
 		CLEANUP_FUNC_CONN_CS(func_cs_count, self);
 		return NULL;
 	}
+	CC_complete_stream(self);
+	CC_complete_fetch_ahead(self);
 
 	/*
 	 *	In case the round trip time can be ignored, the query
@@ -1607,10 +1842,10 @@ CC_send_query_append(ConnectionClass *self, const char *query, QueryInfo *qi, UD
 	 */
 	if (appendq && (self->connInfo.extra_opts & BIT_IGNORE_ROUND_TRIP_TIME) != 0)
 	{
-		res = CC_send_query_append(self, query, qi, flag, stmt, NULL);
+		res = CC_send_query_append(self, query, qi, flag & (~ASYNC_QUERY), stmt, NULL);
 		if (QR_command_maybe_successful(res))
 		{
-			cmdres = CC_send_query_append(self, appendq, qi, flag & (~(GO_INTO_TRANSACTION)), stmt, NULL);
+			cmdres = CC_send_query_append(self, appendq, qi, flag & (~(GO_INTO_TRANSACTION | ASYNC_QUERY)), stmt, NULL);
 			if (QR_command_maybe_successful(cmdres))
 				res->next = cmdres;
 			else
@@ -1630,6 +1865,12 @@ CC_send_query_append(ConnectionClass *self, const char *query, QueryInfo *qi, UD
 	if (rollback_on_error)
 		rollback_on_error = consider_rollback;
 	query_rollback = (rollback_on_error && !end_with_commit && PG_VERSION_GE(self, 8.0));
+	/*
+	 * The rows can be left on the connection only if nothing has to be
+	 * done after the query.
+	 */
+	stream = ((flag & STREAM_RESULT) != 0 && stmt && !appendq && !rollback_on_error && !end_with_commit);
+	async = ((flag & ASYNC_QUERY) != 0 && stmt && !rollback_on_error);
 	if (!query_rollback && consider_rollback && !end_with_commit)
 	{
 		if (stmt)
@@ -1716,13 +1957,27 @@ CC_send_query_append(ConnectionClass *self, const char *query, QueryInfo *qi, UD
 	nrarg.res = NULL;
 	PQsetNoticeReceiver(self->pqconn, receive_libpq_notice, &nrarg);
 
-	if (!PQsendQuery(self->pqconn, query_buf))
+	if (async && stmt == self->async_stmt)
+		mylog("%s: the query was sent by the previous call\n", func);
+	else if (!PQsendQuery(self->pqconn, query_buf))
 	{
 		char *errmsg = PQerrorMessage(self->pqconn);
 		CC_set_error(self, CONNECTION_SERVER_NOT_REACHED, errmsg, func);
 		goto cleanup;
 	}
-	PQsetSingleRowMode(self->pqconn);
+	else
+		PQsetSingleRowMode(self->pqconn);
+	if (async)
+	{
+		if (!CC_async_result_ready(self))
+		{
+			/* SC_execute() returns SQL_STILL_EXECUTING */
+			mylog("%s: the result hasn't arrived yet\n", func);
+			self->async_stmt = stmt;
+			goto cleanup;
+		}
+		self->async_stmt = NULL;
+	}
 
 	cmdres = qi ? qi->result_in : NULL;
 	if (cmdres)
@@ -1791,7 +2046,11 @@ inolog("Discarded the first SAVEPOINT\n");
 				 */
 				else if (strnicmp(cmdbuffer, "DROP TABLE", 10) == 0 ||
 						 strnicmp(cmdbuffer, "ALTER TABLE", 11) == 0)
+				{
 					CC_clear_col_info(self, FALSE);
+					if (self->connInfo.shared_colinfo)
+						clearSharedColInfo(self, 0);
+				}
 				else
 				{
 					ptr = strrchr(cmdbuffer, ' ');
@@ -1867,14 +2126,22 @@ inolog("Discarded the first SAVEPOINT\n");
 						if (cursor && cursor[0])
 							QR_set_synchronize_keys(res);
 					}
+					else if (stream && !query_completed)
+					{
+						QR_set_cache_size(res, self->connInfo.drivers.fetch_max);
+						QR_set_streaming(res);
+					}
 					if (!CC_from_PGresult(res, stmt, self, cursor, &pgres))
 					{
+						QR_set_no_streaming(res);
 						if (QR_command_maybe_successful(res))
 							retres = NULL;
 						else
 							retres = cmdres;
 						aborted = TRUE;
 					}
+					else if (QR_is_streaming(res))
+						self->stream_res = res;
 					query_completed = TRUE;
 				}
 				else
@@ -1927,11 +2194,16 @@ inolog("Discarded the first SAVEPOINT\n");
 			PQclear(pgres);
 			pgres = NULL;
 		}
+		/* the rest of the rows are read by the fetches */
+		if (NULL != self->stream_res)
+			break;
 	}
 
 cleanup:
 	if (self->pqconn)
 		PQsetNoticeReceiver(self->pqconn, receive_libpq_notice, NULL);
+	if (self->connInfo.catalog_notify)
+		CC_receive_catalog_notify(self, FALSE);
 	if (pgres != NULL)
 	{
 		PQclear(pgres);
@@ -2034,7 +2306,8 @@ cleanup:
 	 * libpq, we can get rid of the transaction_status field altogether
 	 * and always ask libpq for it.
 	 */
-	LIBPQ_update_transaction_status(self);
+	if (NULL == self->stream_res && NULL == self->async_stmt)
+		LIBPQ_update_transaction_status(self);
 
 	return retres;
 }
@@ -2068,6 +2341,10 @@ CC_send_function(ConnectionClass *self, const char *fn_name, void *result_buf, i
 	/* Finish the pending extended query first */
 #define	return DONT_CALL_RETURN_FROM_HERE???
 	ENTER_INNER_CONN_CS(self, func_cs_count);
+	if (CC_async_busy(self, NULL, "CC_send_function"))
+		goto cleanup;
+	CC_complete_stream(self);
+	CC_complete_fetch_ahead(self);
 
 	snprintf(sqlbuffer, sizeof(sqlbuffer), "SELECT pg_catalog.%s%s", fn_name,
 			 func_param_str[nargs]);
@@ -2140,50 +2417,98 @@ cleanup:
 }
 
 
-static	char
-CC_setenv(ConnectionClass *self)
-{
-	HSTMT		hstmt;
-	StatementClass *stmt;
-	RETCODE		result;
-	char		status = TRUE;
-	CSTR func = "CC_setenv";
+/*
+ *	The probes of a new session, sent with its settings. The large
+ *	object type is a hack to get the oid of our Large Object oid type.
+ *	If a real Large Object oid type is made part of Postgres, it will
+ *	go away and the define 'PG_TYPE_LO' will be updated.
+ */
+#define	PROBE_QUERY	"select oid, typbasetype from pg_type where typname = '" PG_TYPE_LO_NAME "';show max_identifier_length"
 
+/* Set the results of PROBE_QUERY */
+static void
+CC_set_probes(ConnectionClass *self, QResultClass *res)
+{
+	if (QR_command_maybe_successful(res) && QR_get_num_cached_tuples(res) > 0)
+	{
+		OID	basetype;
 
-	mylog("%s: entering...\n", func);
+		self->lobj_type = QR_get_value_backend_int(res, 0, 0, NULL);
+		basetype = QR_get_value_backend_int(res, 0, 1, NULL);
+		if (PG_TYPE_OID == basetype)
+			self->lo_is_domain = 1;
+		else if (0 != basetype)
+			self->lobj_type = 0;
+	}
+	res = res->next;
+	if (QR_command_maybe_successful(res) && QR_get_num_cached_tuples(res) > 0)
+		self->max_identifier_length = QR_get_value_backend_int(res, 0, 0, NULL);
+	mylog("Got the large object oid: %d\n", self->lobj_type);
+	qlog("    [ Large Object oid = %d ]\n", self->lobj_type);
+}
 
 /*
- *	This function must use the local odbc API functions since the odbc state
- *	has not transitioned to "connected" yet.
+ *	Send the probes of the session if 'probe', 'set_query' and the
+ *	connection settings in one query.
+ *	Returns FALSE if any of them fails, in which case none of them
+ *	takes effect.
  */
-
-	result = PGAPI_AllocStmt(self, &hstmt, 0);
-	if (!SQL_SUCCEEDED(result))
+static BOOL
+CC_send_startup_query(ConnectionClass *self, const char *set_query, BOOL probe, BOOL with_settings)
+{
+	ConnInfo	*ci = &(self->connInfo);
+	const char	*parts[4];
+	QResultClass	*res;
+	char		*query;
+	size_t		qlen = 1;
+	int		i, nparts = 0;
+	BOOL		ret;
+
+	if (probe)
+		parts[nparts++] = PROBE_QUERY;
+	if (set_query)
+		parts[nparts++] = set_query;
+	if (with_settings)
+	{
+		if (NAME_IS_VALID(ci->drivers.conn_settings))
+			parts[nparts++] = GET_NAME(ci->drivers.conn_settings);
+		if (NAME_IS_VALID(ci->conn_settings))
+			parts[nparts++] = GET_NAME(ci->conn_settings);
+	}
+	if (0 == nparts)
+		return TRUE;
+	for (i = 0; i < nparts; i++)
+		qlen += strlen(parts[i]) + 1;
+	if (query = malloc(qlen), NULL == query)
 		return FALSE;
-	stmt = (StatementClass *) hstmt;
-
-	stmt->internal = TRUE;		/* ensure no BEGIN/COMMIT/ABORT stuff */
-
-	/* Set the Datestyle to the format the driver expects it to be in */
-	result = PGAPI_ExecDirect(hstmt, (SQLCHAR *) "set DateStyle to 'ISO'", SQL_NTS, 0);
-	if (!SQL_SUCCEEDED(result))
-		status = FALSE;
-
-	mylog("%s: result %d, status %d from set DateStyle\n", func, result, status);
-
-	result = PGAPI_ExecDirect(hstmt, (SQLCHAR *) "set extra_float_digits to 2", SQL_NTS, 0);
-	if (!SQL_SUCCEEDED(result))
-		status = FALSE;
-
-	mylog("%s: result %d, status %d from set extra_float_digits\n", func, result, status);
+	query[0] = '\0';
+	for (i = 0; i < nparts; i++)
+	{
+		if (i > 0)
+			strcat(query, ";");
+		strcat(query, parts[i]);
+	}
 
-	PGAPI_FreeStmt(hstmt, SQL_DROP);
+	res = CC_send_query(self, query, NULL, IGNORE_ABORT_ON_CONN | ROLLBACK_ON_ERROR, NULL);
+	ret = QR_command_maybe_successful(res);
+	if (ret && probe)
+		CC_set_probes(self, res);
+	QR_Destructor(res);
+	mylog("%s: %s from '%s'\n", __FUNCTION__, ret ? "succeeded" : "failed", query);
+	free(query);
 
-	return status;
+	return ret;
 }
 
+/*
+ *	Send the probes of the session if 'probe', the settings of the
+ *	driver 'set_query' and the connection settings of the driver and
+ *	the data source in one round trip. If any of them fails, the
+ *	connection settings are sent again one by one, so that a failing
+ *	setting doesn't prevent the others.
+ */
 char
-CC_send_settings(ConnectionClass *self)
+CC_send_settings(ConnectionClass *self, const char *set_query, BOOL probe)
 {
 	ConnInfo   *ci = &(self->connInfo);
 
@@ -2194,6 +2519,7 @@ CC_send_settings(ConnectionClass *self)
 	char		status = TRUE;
 	char	   *cs,
 			   *ptr;
+	BOOL		has_settings, with_settings;
 #ifdef	HAVE_STRTOK_R
 	char	*last;
 #endif /* HAVE_STRTOK_R */
@@ -2202,6 +2528,25 @@ CC_send_settings(ConnectionClass *self)
 
 	mylog("%s: entering...\n", func);
 
+	has_settings = (NAME_IS_VALID(ci->drivers.conn_settings) ||
+			NAME_IS_VALID(ci->conn_settings));
+	/* ODBC escapes in the connection settings need to be converted */
+	with_settings = has_settings &&
+		!(NAME_IS_VALID(ci->drivers.conn_settings) &&
+		  strchr(GET_NAME(ci->drivers.conn_settings), '{')) &&
+		!(NAME_IS_VALID(ci->conn_settings) &&
+		  strchr(GET_NAME(ci->conn_settings), '{'));
+	if (CC_send_startup_query(self, set_query, probe, with_settings))
+	{
+		if (with_settings || !has_settings)
+			return TRUE;
+	}
+	else if (!with_settings ||
+		 !CC_send_startup_query(self, set_query, probe, FALSE))
+		status = FALSE;
+	if (!has_settings)
+		return status;
+
 /*
  *	This function must use the local odbc API functions since the odbc state
  *	has not transitioned to "connected" yet.
@@ -2282,39 +2627,6 @@ CC_send_settings(ConnectionClass *self)
 }
 
 
-/*
- *	This function is just a hack to get the oid of our Large Object oid type.
- *	If a real Large Object oid type is made part of Postgres, this function
- *	will go away and the define 'PG_TYPE_LO' will be updated.
- */
-static void
-CC_lookup_lo(ConnectionClass *self)
-{
-	QResultClass	*res;
-	CSTR func = "CC_lookup_lo";
-
-	mylog("%s: entering...\n", func);
-
-	res = CC_send_query(self, "select oid, typbasetype from pg_type where typname = '"  PG_TYPE_LO_NAME "'",
-		NULL, IGNORE_ABORT_ON_CONN | ROLLBACK_ON_ERROR, NULL);
-	if (QR_command_maybe_successful(res) && QR_get_num_cached_tuples(res) > 0)
-	{
-		OID	basetype;
-
-		self->lobj_type = QR_get_value_backend_int(res, 0, 0, NULL);
-		basetype = QR_get_value_backend_int(res, 0, 1, NULL);
-		if (PG_TYPE_OID == basetype)
-			self->lo_is_domain = 1;
-		else if (0 != basetype)
-			self->lobj_type = 0;
-	}
-	QR_Destructor(res);
-	mylog("Got the large object oid: %d\n", self->lobj_type);
-	qlog("    [ Large Object oid = %d ]\n", self->lobj_type);
-	return;
-}
-
-
 /*
  *	This function initializes the version of PostgreSQL from
  *	connInfo.protocol that we're connected to.
@@ -2386,6 +2698,148 @@ int	CC_mark_a_object_to_discard(ConnectionClass *conn, int type, const char *pla
 	return 1;
 }
 
+/* DEALLOCATE the plan now, or at the end of the failed transaction */
+void	CC_deallocate_plan(ConnectionClass *conn, const char *plan_name)
+{
+	if (CC_is_in_error_trans(conn))
+	{
+		CC_mark_a_object_to_discard(conn, 's', plan_name);
+	}
+	else
+	{
+		QResultClass	*res;
+		char dealloc_stmt[128];
+
+		snprintf(dealloc_stmt, sizeof(dealloc_stmt), "DEALLOCATE \"%s\"", plan_name);
+		res = CC_send_query(conn, dealloc_stmt, NULL, IGNORE_ABORT_ON_CONN | ROLLBACK_ON_ERROR, NULL);
+		QR_Destructor(res);
+	}
+}
+
+static UInt4
+plan_query_hash(const char *query)
+{
+	UInt4	hash = 0;
+
+	for (; *query; query++)
+		hash = hash * 31 + (UCHAR) *query;
+	return hash;
+}
+
+/*
+ *	Look for a cached plan of the query prepared with the parameter types.
+ *	The plan is used by the caller until CC_release_cached_plan().
+ */
+const char *CC_find_cached_plan(ConnectionClass *conn, const char *query, Int2 num_params, const OID *param_types)
+{
+	UInt4	hash = plan_query_hash(query);
+	int	i;
+	CachedPlan	*plan;
+
+	for (i = 0, plan = conn->cached_plans; i < conn->num_cached_plans; i++, plan++)
+	{
+		if (plan->hash != hash ||
+		    plan->num_params != num_params ||
+		    strcmp(plan->query, query) != 0)
+			continue;
+		if (num_params > 0 &&
+		    memcmp(plan->param_types, param_types, sizeof(OID) * num_params) != 0)
+			continue;
+		plan->refcnt++;
+		plan->last_used = ++conn->plan_counter;
+		return plan->plan_name;
+	}
+	return NULL;
+}
+
+void	CC_new_cached_plan_name(ConnectionClass *conn, char *plan_name, size_t len)
+{
+	snprintf(plan_name, len, "_PC%u", ++conn->plan_counter);
+}
+
+/*
+ *	Add the plan just prepared to the cache. It's used by the caller.
+ */
+void	CC_add_cached_plan(ConnectionClass *conn, const char *plan_name, const char *query, Int2 num_params, const OID *param_types)
+{
+	CachedPlan	*plan;
+
+	if (conn->num_cached_plans >= conn->cached_plans_allocated)
+	{
+		Int4	new_alloc = conn->cached_plans_allocated > 0 ? conn->cached_plans_allocated * 2 : 16;
+		CachedPlan	*cached_plans;
+
+		if (cached_plans = (CachedPlan *) realloc(conn->cached_plans, sizeof(CachedPlan) * new_alloc), NULL == cached_plans)
+			return;
+		conn->cached_plans = cached_plans;
+		conn->cached_plans_allocated = new_alloc;
+	}
+	plan = conn->cached_plans + conn->num_cached_plans;
+	if (plan->query = strdup(query), NULL == plan->query)
+		return;
+	plan->param_types = NULL;
+	if (num_params > 0)
+	{
+		if (plan->param_types = (OID *) malloc(sizeof(OID) * num_params), NULL == plan->param_types)
+		{
+			free(plan->query);
+			return;
+		}
+		memcpy(plan->param_types, param_types, sizeof(OID) * num_params);
+	}
+	plan->hash = plan_query_hash(query);
+	plan->num_params = num_params;
+	strncpy_null(plan->plan_name, plan_name, sizeof(plan->plan_name));
+	plan->refcnt = 1;
+	plan->last_used = ++conn->plan_counter;
+	conn->num_cached_plans++;
+	mylog("%s: cached %s for %s\n", __FUNCTION__, plan_name, query);
+}
+
+/*
+ *	The statement no longer uses the plan. Returns FALSE if the plan
+ *	isn't a cached one. The least recently used plans are deallocated
+ *	when more than PreparedCacheSize plans are unused.
+ */
+BOOL	CC_release_cached_plan(ConnectionClass *conn, const char *plan_name)
+{
+	int	i, num_unused = 0, lru;
+	CachedPlan	*plan;
+	BOOL	found = FALSE;
+
+	for (i = 0, plan = conn->cached_plans; i < conn->num_cached_plans; i++, plan++)
+	{
+		if (!found && strcmp(plan->plan_name, plan_name) == 0)
+		{
+			plan->refcnt--;
+			found = TRUE;
+		}
+		if (plan->refcnt <= 0)
+			num_unused++;
+	}
+	if (!found)
+		return FALSE;
+	while (num_unused > conn->connInfo.prepared_cache_size)
+	{
+		for (i = 0, lru = -1, plan = conn->cached_plans; i < conn->num_cached_plans; i++, plan++)
+		{
+			if (plan->refcnt <= 0 &&
+			    (lru < 0 || plan->last_used < conn->cached_plans[lru].last_used))
+				lru = i;
+		}
+		plan = conn->cached_plans + lru;
+		mylog("%s: evicting %s\n", __FUNCTION__, plan->plan_name);
+		if (CONN_CONNECTED == conn->status)
+			CC_deallocate_plan(conn, plan->plan_name);
+		free(plan->query);
+		if (plan->param_types)
+			free(plan->param_types);
+		*plan = conn->cached_plans[--conn->num_cached_plans];
+		num_unused--;
+	}
+	return TRUE;
+}
+
 int	CC_discard_marked_objects(ConnectionClass *conn)
 {
 	int	i, cnt;
@@ -2410,7 +2864,66 @@ int	CC_discard_marked_objects(ConnectionClass *conn)
 	return 1;
 }
 
-static void
+/*
+ * Read the rest of the rows of a streamed result (see STREAM_RESULT)
+ * into the result, so that the connection can be used for another query.
+ * All of them are held in memory then, as if the result hadn't been
+ * streamed.
+ */
+void
+CC_complete_stream(ConnectionClass *self)
+{
+	if (NULL != self->stream_res)
+	{
+		mylog("CC_complete_stream: reading the rest of %p\n", self->stream_res);
+		QR_read_stream(self->stream_res, TRUE);
+	}
+}
+
+/*
+ * Receive the result of the FETCH sent ahead (see BIT_FETCH_AHEAD) so
+ * that the connection can be used for another query. The rows are kept
+ * in the result until they are needed.
+ */
+void
+CC_complete_fetch_ahead(ConnectionClass *self)
+{
+	if (NULL != self->fetch_ahead_res)
+	{
+		mylog("CC_complete_fetch_ahead: receiving the rows of %p\n", self->fetch_ahead_res);
+		QR_receive_fetch_ahead(self->fetch_ahead_res);
+	}
+}
+
+/*
+ * The connection can't be used by other statements while the query of
+ * a statement executed asynchronously (SQL_ATTR_ASYNC_ENABLE) is
+ * running. Returns TRUE, with an error set, in that case.
+ */
+BOOL
+CC_async_busy(ConnectionClass *self, StatementClass *stmt, const char *func)
+{
+	if (NULL == self->async_stmt)
+		return FALSE;
+	if (NULL != stmt && SC_get_ancestor(stmt) == self->async_stmt)
+		return FALSE;
+	CC_set_error(self, CONN_IN_USE, "The connection is busy with an asynchronous query", func);
+	return TRUE;
+}
+
+/*
+ * Has the result of the query sent by PQsendQuery*() arrived, so that
+ * PQgetResult() doesn't block ?
+ */
+BOOL
+CC_async_result_ready(ConnectionClass *self)
+{
+	if (!PQconsumeInput(self->pqconn))
+		return TRUE;	/* let PQgetResult() report the error */
+	return !PQisBusy(self->pqconn);
+}
+
+void
 LIBPQ_update_transaction_status(ConnectionClass *self)
 {
 	if (!self->pqconn)
@@ -2451,6 +2964,293 @@ LIBPQ_update_transaction_status(ConnectionClass *self)
 	}
 }
 
+/* Set the server version and the user name of a new session */
+static void
+LIBPQ_set_server_info(ConnectionClass *self)
+{
+	PGconn	*pqconn = self->pqconn;
+	int	pversion;
+
+	pversion = PQserverVersion(pqconn);
+	self->pg_version_major = pversion / 10000;
+	self->pg_version_minor = (pversion % 10000) / 100;
+	sprintf(self->pg_version, "%d.%d.%d",  self->pg_version_major, self->pg_version_minor, pversion % 100);
+
+	mylog("Server version=%s\n", self->pg_version);
+
+	if (!CC_get_username(self)[0])
+	{
+		mylog("PQuser=%s\n", PQuser(pqconn));
+		strncpy_null(self->connInfo.username, PQuser(pqconn), sizeof(self->connInfo.username));
+	}
+}
+
+/*
+ *	The pool of the connections of the process (Extra Opts 0x4000).
+ *
+ *	SQLDisconnect keeps the libpq connection of an idle session in the
+ *	pool, after rolling back the transaction in progress if any and
+ *	resetting the session with DISCARD ALL. A later connection to the
+ *	same server and database as the same user, with exactly the same
+ *	password and connection options, takes it instead of connecting
+ *	again. Only
+ *	the settings of the driver are sent then, in one query which also
+ *	checks the connection is still alive. The results of the probes of
+ *	the session (the large object type, the server encoding and
+ *	max_identifier_length) are kept with it.
+ */
+#define	CONN_POOL_MAX		32	/* idle connections kept */
+#define	CONN_POOL_IDLE_TIMEOUT	300	/* seconds an idle connection is kept */
+
+typedef struct PooledConn_
+{
+	struct PooledConn_	*next;	/* the most recently pooled first */
+	char		*key;
+	char		*password;	/* compared exactly before the reuse */
+	PGconn		*pqconn;
+	time_t		pooled_time;
+	Int4		lobj_type;
+	char		lo_is_domain;
+	char		*server_encoding;
+	Int2		max_identifier_length;
+} PooledConn;
+
+static PooledConn	*conn_pool = NULL;
+static int	num_pooled_conns = 0;
+
+/*
+ *	The key of the connections which may share sessions. The password
+ *	isn't part of it but is kept with the pooled connection.
+ */
+static char *
+makeConnPoolKey(const ConnectionClass *self)
+{
+	const ConnInfo	*ci = &(self->connInfo);
+	char		*key;
+	size_t		keylen;
+	int		len;
+
+	/* the names and 4 integers with the separators */
+	keylen = strlen(ci->server) + strlen(ci->port) + strlen(ci->database)
+		+ strlen(ci->username) + strlen(ci->sslmode) + 4 * 12 + 8;
+	if (key = malloc(keylen), NULL == key)
+		return NULL;
+	len = snprintf(key, keylen, "%s:%s/%s;%s;%s;%d,%d,%d,%d",
+		ci->server, ci->port, ci->database, ci->username,
+		ci->sslmode,
+		ci->gssauth_use_gssapi, ci->disable_keepalive,
+		ci->keepalive_idle, ci->keepalive_interval);
+	if (len < 0 || len >= (int) keylen)
+	{
+		free(key);
+		return NULL;
+	}
+	return key;
+}
+
+static void
+freePooledConn(PooledConn *pooled)
+{
+	PQfinish(pooled->pqconn);
+	if (pooled->server_encoding)
+		free(pooled->server_encoding);
+	free(pooled->password);
+	free(pooled->key);
+	free(pooled);
+}
+
+/*
+ *	Keep the libpq connection of 'self' in the pool at SQLDisconnect,
+ *	if the session can be reset. The connection is given up by 'self'
+ *	then.
+ */
+static BOOL
+CC_release_to_pool(ConnectionClass *self)
+{
+	PGconn		*pqconn;
+	PGresult	*pgres;
+	PooledConn	*pooled = NULL, **prev, *evicted = NULL;
+	BOOL		ok = FALSE;
+
+	/* No other thread may use the connection while it is reset */
+	ENTER_CONN_CS(self);
+	pqconn = self->pqconn;
+	if (NULL == pqconn || NULL == self->pool_key ||
+	    CONN_CONNECTED != self->status ||
+	    CONNECTION_OK != PQstatus(pqconn))
+		goto cleanup;
+	/* DISCARD ALL is available as of 8.3 */
+	if (!PG_VERSION_GE(self, 8.3))
+		goto cleanup;
+	/* the rows still being received */
+	if (NULL != self->stream_res ||
+	    NULL != self->async_stmt ||
+	    NULL != self->fetch_ahead_res)
+		goto cleanup;
+#ifdef	_HANDLE_ENLIST_IN_DTC_
+	if (CC_is_dtc_enlisted(self))
+		goto cleanup;
+#endif /* _HANDLE_ENLIST_IN_DTC_ */
+	switch (PQtransactionStatus(pqconn))
+	{
+		case PQTRANS_IDLE:
+			break;
+		case PQTRANS_INTRANS:
+		case PQTRANS_INERROR:
+			pgres = PQexec(pqconn, "ROLLBACK");
+			ok = (PGRES_COMMAND_OK == PQresultStatus(pgres));
+			PQclear(pgres);
+			if (!ok)
+				goto cleanup;
+			break;
+		default:
+			goto cleanup;
+	}
+	/*
+	 * Drop the prepared statements, the cursors, the temporary tables,
+	 * the settings and the LISTENs of the session.
+	 */
+	pgres = PQexec(pqconn, "DISCARD ALL");
+	ok = (PGRES_COMMAND_OK == PQresultStatus(pgres));
+	PQclear(pgres);
+	if (!ok)
+		goto cleanup;
+
+	ok = FALSE;
+	if (pooled = (PooledConn *) malloc(sizeof(PooledConn)), NULL == pooled)
+		goto cleanup;
+	if (pooled->password = strdup(SAFE_NAME(self->connInfo.password)), NULL == pooled->password)
+	{
+		free(pooled);
+		goto cleanup;
+	}
+	pooled->key = self->pool_key;
+	self->pool_key = NULL;
+	pooled->pqconn = pqconn;
+	self->pqconn = NULL;
+	pooled->pooled_time = time(NULL);
+	pooled->lobj_type = self->lobj_type;
+	pooled->lo_is_domain = self->lo_is_domain;
+	pooled->server_encoding = self->server_encoding;
+	self->server_encoding = NULL;
+	pooled->max_identifier_length = self->max_identifier_length;
+	mylog("%s: pooling %p for %s\n", __FUNCTION__, pqconn, pooled->key);
+
+	shortterm_common_lock();
+	pooled->next = conn_pool;
+	conn_pool = pooled;
+	if (++num_pooled_conns > CONN_POOL_MAX)
+	{
+		/* close the connection pooled the longest */
+		for (prev = &conn_pool; NULL != (*prev)->next; prev = &(*prev)->next)
+			;
+		evicted = *prev;
+		*prev = NULL;
+		num_pooled_conns--;
+	}
+	shortterm_common_unlock();
+	ok = TRUE;
+
+cleanup:
+	LEAVE_CONN_CS(self);
+	if (evicted)
+		freePooledConn(evicted);
+
+	return ok;
+}
+
+/*
+ *	Take a connection with the key of 'self' from the pool. The
+ *	connections idle for too long are closed on the way.
+ */
+static BOOL
+CC_get_pooled_connection(ConnectionClass *self)
+{
+	PooledConn	*pooled = NULL, *expired = NULL, *wk, **prev;
+	PGresult	*pgres;
+	time_t		now = time(NULL);
+	char		query[128];
+	BOOL		ok;
+
+	if (NULL == self->pool_key &&
+	    NULL == (self->pool_key = makeConnPoolKey(self)))
+		return FALSE;
+	shortterm_common_lock();
+	for (prev = &conn_pool; NULL != (wk = *prev);)
+	{
+		if (now - wk->pooled_time > CONN_POOL_IDLE_TIMEOUT)
+		{
+			*prev = wk->next;
+			wk->next = expired;
+			expired = wk;
+			num_pooled_conns--;
+		}
+		else if (NULL == pooled &&
+			 strcmp(wk->key, self->pool_key) == 0 &&
+			 strcmp(wk->password, SAFE_NAME(self->connInfo.password)) == 0)
+		{
+			*prev = wk->next;
+			pooled = wk;
+			num_pooled_conns--;
+		}
+		else
+			prev = &wk->next;
+	}
+	shortterm_common_unlock();
+	while (NULL != (wk = expired))
+	{
+		expired = wk->next;
+		freePooledConn(wk);
+	}
+	if (NULL == pooled)
+		return FALSE;
+
+	strcpy(query, DRIVER_SESSION_SETTINGS);
+#ifdef	UNICODE_SUPPORT
+	if (CC_is_in_unicode_driver(self))
+		strcat(query, ";set client_encoding to 'UTF8'");
+#endif /* UNICODE_SUPPORT */
+	pgres = PQexec(pooled->pqconn, query);
+	ok = (PGRES_COMMAND_OK == PQresultStatus(pgres));
+	PQclear(pgres);
+	if (!ok)
+	{
+		mylog("%s: the pooled connection is lost: %s", __FUNCTION__, PQerrorMessage(pooled->pqconn));
+		freePooledConn(pooled);
+		return FALSE;
+	}
+	mylog("%s: reusing %p for %s\n", __FUNCTION__, pooled->pqconn, pooled->key);
+	self->pqconn = pooled->pqconn;
+	LIBPQ_set_server_info(self);
+	self->lobj_type = pooled->lobj_type;
+	self->lo_is_domain = pooled->lo_is_domain;
+	if (self->server_encoding)
+		free(self->server_encoding);
+	self->server_encoding = pooled->server_encoding;
+	self->max_identifier_length = pooled->max_identifier_length;
+	free(pooled->password);
+	free(pooled->key);
+	free(pooled);
+
+	return TRUE;
+}
+
+/* Close the pooled connections when the driver is unloaded */
+void
+CC_close_pooled_connections(void)
+{
+	PooledConn	*wk;
+
+	shortterm_common_lock();
+	while (NULL != (wk = conn_pool))
+	{
+		conn_pool = wk->next;
+		freePooledConn(wk);
+	}
+	num_pooled_conns = 0;
+	shortterm_common_unlock();
+}
+
 #define        PROTOCOL3_OPTS_MAX      20
 
 static int
@@ -2579,18 +3379,7 @@ inolog("status=%d\n", pqret);
 	}
 	mylog("protocol=%d\n", pversion);
 
-	pversion = PQserverVersion(pqconn);
-	self->pg_version_major = pversion / 10000;
-	self->pg_version_minor = (pversion % 10000) / 100;
-	sprintf(self->pg_version, "%d.%d.%d",  self->pg_version_major, self->pg_version_minor, pversion % 100);
-
-	mylog("Server version=%s\n", self->pg_version);
-
-	if (!CC_get_username(self)[0])
-	{
-		mylog("PQuser=%s\n", PQuser(pqconn));
-		strncpy_null(self->connInfo.username, PQuser(pqconn), sizeof(self->connInfo.username));
-	}
+	LIBPQ_set_server_info(self);
 
 	ret = 1;
 
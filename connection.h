@@ -243,10 +243,22 @@ typedef struct
 	signed char	accessible_only;
 	signed char	ignore_round_trip_time;
 	signed char	disable_keepalive;
+	signed char	pipeline_param_array;
+	signed char	copy_param_array;
+	signed char	binary_result;
+	signed char	stream_results;
+	signed char	fetch_ahead;
+	signed char	shared_colinfo;
+	signed char	catalog_notify;
+	signed char	connection_pool;
 	signed char	gssauth_use_gssapi;
 	UInt4		extra_opts;
 	Int4		keepalive_idle;
 	Int4		keepalive_interval;
+	Int4		insert_batch_rows;
+	Int4		insert_batch_bytes;
+	Int4		fetch_cache_bytes;
+	Int4		prepared_cache_size;
 #ifdef	_HANDLE_ENLIST_IN_DTC_
 	signed char	xa_opt;
 #endif /* _HANDLE_ENLIST_IN_DTC_ */
@@ -295,11 +307,16 @@ struct col_info
 	pgNAME		table_name;
 	OID		table_oid;
 	time_t		acc_time;
+	struct SharedColInfo_	*shared;	/* the process-wide entry the
+						 * result is borrowed from */
 };
 #define free_col_info_contents(coli) \
 { \
-	if (NULL != coli->result) \
+	if (NULL != coli->shared) \
+		releaseSharedColInfo(coli->shared); \
+	else if (NULL != coli->result) \
 		QR_Destructor(coli->result); \
+	coli->shared = NULL; \
 	coli->result = NULL; \
 	NULL_THE_NAME(coli->schema_name); \
 	NULL_THE_NAME(coli->table_name); \
@@ -308,6 +325,31 @@ struct col_info
 	coli->acc_time = 0; \
 }
 #define col_info_initialize(coli) (memset(coli, 0, sizeof(COL_INFO)))
+void	releaseSharedColInfo(struct SharedColInfo_ *shared);
+void	clearSharedColInfo(const ConnectionClass *conn, OID reloid);
+
+/*
+ *	The channel the catalog changes are notified on (Extra Opts 0x2000).
+ *	The payload is the comma separated list of the oids of the changed
+ *	tables, or empty if any table may have changed.
+ */
+#define	CATALOG_NOTIFY_CHANNEL	"psqlodbc_catalog"
+
+/*
+ *	A statement prepared at the server, which outlives the statement
+ *	handles (PreparedCacheSize). It's looked up by the query and the
+ *	parameter types it was prepared with.
+ */
+typedef struct
+{
+	char		*query;
+	UInt4		hash;		/* of the query */
+	Int2		num_params;
+	OID		*param_types;
+	char		plan_name[16];
+	Int4		refcnt;		/* count of the statements using it */
+	UInt4		last_used;
+} CachedPlan;
 
  /* Translation DLL entry points */
 #ifdef WIN32
@@ -342,6 +384,10 @@ struct ConnectionClass_
 	ConnInfo	connInfo;
 	StatementClass	**stmts;
 	Int2		num_stmts;
+	Int2		*free_stmt_slots;	/* stack of the free indexes of stmts */
+	Int2		num_free_stmt_slots;
+	StatementClass	*pooled_stmts;	/* dropped statements kept for reuse */
+	Int2		num_pooled_stmts;
 	Int2		ncursors;
 	PGconn	   *pqconn;
 	Int4		lobj_type;
@@ -367,14 +413,28 @@ struct ConnectionClass_
 	char		lo_is_domain;
 	char		*original_client_encoding;
 	char		*server_encoding;
+	char		*pool_key;	/* the key of the connection in the
+					 * connection pool */
 	Int2		ccsc;
 	Int2		mb_maxbyte_per_char;
 	UInt4		isolation;
 	char		*current_schema;
 	StatementClass *unnamed_prepared_stmt;
+	QResultClass	*stream_res;	/* the result whose rows are still being received */
+	StatementClass	*async_stmt;	/* the statement whose query is running asynchronously */
+	QResultClass	*fetch_ahead_res;	/* the result whose next FETCH was sent ahead */
 	Int2		max_identifier_length;
 	Int2		num_discardp;
 	char		**discardp;
+	CachedPlan	*cached_plans;	/* the statements prepared at the server
+					 * kept by the connection (PreparedCacheSize) */
+	Int4		num_cached_plans;
+	Int4		cached_plans_allocated;
+	UInt4		plan_counter;	/* to name the cached plans and order their uses */
+	struct SqlTemplate_	**sql_templates;	/* the statements converted by
+					 * copy_statement_with_parameters() */
+	Int2		num_sql_templates;
+	UInt4		template_counter;	/* to order the uses of the templates */
 	int		num_descs;
 	DescriptorClass	**descs;
 	pgNAME		schemaIns;
@@ -448,9 +508,12 @@ char		CC_abort(ConnectionClass *self);
 char		CC_set_autocommit(ConnectionClass *self, BOOL on);
 int		CC_set_translation(ConnectionClass *self);
 char		CC_connect(ConnectionClass *self, char *salt);
+void		CC_close_pooled_connections(void);
 char		CC_add_statement(ConnectionClass *self, StatementClass *stmt);
 char		CC_remove_statement(ConnectionClass *self, StatementClass *stmt)
 ;
+char		CC_pool_statement(ConnectionClass *self, StatementClass *stmt);
+StatementClass	*CC_get_pooled_statement(ConnectionClass *self);
 char		CC_add_descriptor(ConnectionClass *self, DescriptorClass *desc);
 char		CC_remove_descriptor(ConnectionClass *self, DescriptorClass *desc);
 void		CC_set_error(ConnectionClass *self, int number, const char *message, const char *func);
@@ -461,9 +524,15 @@ QResultClass *CC_send_query_append(ConnectionClass *self, const char *query, Que
 void		handle_pgres_error(ConnectionClass *self, const PGresult *pgres,
 				   const char *comment,
 				   QResultClass *res, BOOL fatal);
+void		LIBPQ_update_transaction_status(ConnectionClass *self);
+void		CC_complete_stream(ConnectionClass *self);
+void		CC_complete_fetch_ahead(ConnectionClass *self);
+void		CC_receive_catalog_notify(ConnectionClass *self, BOOL consume);
+BOOL		CC_async_busy(ConnectionClass *self, StatementClass *stmt, const char *func);
+BOOL		CC_async_result_ready(ConnectionClass *self);
 void		CC_clear_error(ConnectionClass *self);
 int		CC_send_function(ConnectionClass *conn, const char *fn_name, void *result_buf, int *actual_result_len, int result_is_int, LO_ARG *argv, int nargs);
-char		CC_send_settings(ConnectionClass *self);
+char		CC_send_settings(ConnectionClass *self, const char *set_query, BOOL probe);
 void		CC_initialize_pg_version(ConnectionClass *conn);
 void		CC_log_error(const char *func, const char *desc, const ConnectionClass *self);
 int			CC_send_cancel_request(const ConnectionClass *conn);
@@ -473,6 +542,11 @@ void		CC_on_abort_partial(ConnectionClass *conn);
 void		ProcessRollback(ConnectionClass *conn, BOOL undo, BOOL partial);
 const char	*CC_get_current_schema(ConnectionClass *conn);
 int             CC_mark_a_object_to_discard(ConnectionClass *conn, int type, const char *plan);
+void		CC_deallocate_plan(ConnectionClass *conn, const char *plan_name);
+const char	*CC_find_cached_plan(ConnectionClass *conn, const char *query, Int2 num_params, const OID *param_types);
+void		CC_new_cached_plan_name(ConnectionClass *conn, char *plan_name, size_t len);
+void		CC_add_cached_plan(ConnectionClass *conn, const char *plan_name, const char *query, Int2 num_params, const OID *param_types);
+BOOL		CC_release_cached_plan(ConnectionClass *conn, const char *plan_name);
 int             CC_discard_marked_objects(ConnectionClass *conn);
 
 int		CC_get_max_idlen(ConnectionClass *self);
@@ -490,6 +564,8 @@ enum {
 	,GO_INTO_TRANSACTION	= (1L << 2) /* issue BEGIN in advance */
 	,ROLLBACK_ON_ERROR	= (1L << 3) /* rollback the query when an error occurs */
 	,END_WITH_COMMIT	= (1L << 4) /* the query ends with COMMIT command */
+	,STREAM_RESULT		= (1L << 5) /* leave the rows beyond a cache on the connection */
+	,ASYNC_QUERY		= (1L << 6) /* don't wait for the result (SQL_ATTR_ASYNC_ENABLE) */
 };
 /* CC_on_abort options */
 #define	NO_TRANS		1L
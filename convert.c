@@ -19,8 +19,8 @@
 
 #include "convert.h"
 #include "misc.h"
-#ifdef	WIN32
 #include <float.h>
+#ifdef	WIN32
 #define	HAVE_LOCALE_H
 #endif /* WIN32 */
 
@@ -173,6 +173,8 @@ static int convert_lo(StatementClass *stmt, const void *value, SQLSMALLINT fCTyp
 	 PTR rgbValue, SQLLEN cbValueMax, SQLLEN *pcbValue);
 static int conv_from_octal(const char *s);
 static SQLLEN pg_bin2hex(const char *src, char *dst, SQLLEN length);
+static void pg_hex2bin_piece(const char *src, char *dst, SQLLEN count);
+static const ConvertPlan *bind_convert_plan(const StatementClass *stmt, BindInfoClass *bic, OID field_type, int atttypmod, BOOL binary);
 #ifdef	UNICODE_SUPPORT
 static SQLLEN pg_bin2whex(const char *src, SQLWCHAR *dst, SQLLEN length);
 #endif /* UNICODE_SUPPORT */
@@ -714,7 +716,7 @@ static void set_client_decimal_point(char *num, BOOL) {}
 
 /*	This is called by SQLFetch() */
 int
-copy_and_convert_field_bindinfo(StatementClass *stmt, OID field_type, int atttypmod, void *value, int col)
+copy_and_convert_field_bindinfo(StatementClass *stmt, OID field_type, int atttypmod, void *value, int col, BOOL binary)
 {
 	ARDFields *opts = SC_get_ARDF(stmt);
 	BindInfoClass *bic;
@@ -724,6 +726,33 @@ copy_and_convert_field_bindinfo(StatementClass *stmt, OID field_type, int atttyp
 		extend_column_bindings(opts, col + 1);
 	bic = &(opts->bindings[col]);
 	SC_set_current_col(stmt, -1);
+	if (NULL != value && NULL != bic->buffer)
+	{
+		const ConvertPlan *plan = bind_convert_plan(stmt, bic, field_type, atttypmod, binary);
+		SQLLEN	rgbValueOffset, pcbValueOffset;
+
+		if (opts->bind_size > 0)
+			rgbValueOffset = pcbValueOffset = opts->bind_size * stmt->bind_row;
+		else
+		{
+			rgbValueOffset = plan->len * stmt->bind_row;
+			pcbValueOffset = sizeof(SQLLEN) * stmt->bind_row;
+		}
+		if (NULL != plan->convert &&
+			plan->convert(value, bic->buffer + offset + rgbValueOffset))
+		{
+			if (bic->indicator)
+				*LENADDR_SHIFT(bic->indicator, offset + pcbValueOffset) = 0;
+			if (bic->used)
+				*LENADDR_SHIFT(bic->used, offset + pcbValueOffset) = plan->len;
+			return COPY_OK;
+		}
+	}
+	if (binary)
+		return copy_and_convert_binary_field(stmt, field_type, atttypmod, value,
+			bic->returntype, bic->precision,
+			(PTR) (bic->buffer + offset), bic->buflen,
+			LENADDR_SHIFT(bic->used, offset), LENADDR_SHIFT(bic->indicator, offset));
 	return copy_and_convert_field(stmt, field_type, atttypmod, value,
 		bic->returntype, bic->precision,
 		(PTR) (bic->buffer + offset), bic->buflen,
@@ -794,6 +823,348 @@ static double get_double_value(const char *str)
 	return atof(str);
 }
 
+/*
+ *	Conversion plans of the bound columns.
+ *
+ *	copy_and_convert_field() works out the conversion of every value
+ *	from the field type, the C type and the connection options. For the
+ *	most common numeric, date and timestamp conversions, the work is done
+ *	once per binding and result column by bind_convert_plan(), which
+ *	picks a FieldConvertProc storing the canonical text output of the
+ *	server directly. Anything else it doesn't recognize, like NULLs,
+ *	NaN/Infinity or BC dates, is left to copy_and_convert_field().
+ */
+
+/* parse a decimal integer of at most 'maxdigits' digits */
+static BOOL
+parse_plan_integer(const char *str, int maxdigits, SQLLEN *val)
+{
+	const char *p = str;
+	BOOL	negative = FALSE;
+	SQLLEN	v = 0;
+
+	if ('-' == *p)
+	{
+		negative = TRUE;
+		p++;
+	}
+	for (str = p; isdigit((UCHAR) *p); p++)
+	{
+		if (p - str >= maxdigits)
+			return FALSE;
+		v = v * 10 + (*p - '0');
+	}
+	if (p == str || '\0' != *p)
+		return FALSE;
+	*val = negative ? -v : v;
+	return TRUE;
+}
+
+static BOOL
+plan_convert_short(char *value, char *dest)
+{
+	SQLLEN	v;
+
+	if (!parse_plan_integer(value, 9, &v))
+		return FALSE;
+	*((SQLSMALLINT *) dest) = (int) v;
+	return TRUE;
+}
+
+static BOOL
+plan_convert_long(char *value, char *dest)
+{
+	SQLLEN	v;
+
+	if (!parse_plan_integer(value, 9, &v))
+		return FALSE;
+	*((SQLINTEGER *) dest) = (SQLINTEGER) v;
+	return TRUE;
+}
+
+#ifdef ODBCINT64
+static BOOL
+plan_convert_bigint(char *value, char *dest)
+{
+	SQLLEN	v;
+
+	if (sizeof(SQLLEN) < 8 || !parse_plan_integer(value, 18, &v))
+		return FALSE;
+	*((SQLBIGINT *) dest) = v;
+	return TRUE;
+}
+#endif /* ODBCINT64 */
+
+/* NaN and Infinity are left to get_double_value() */
+#define	is_plan_number(str) (isdigit((UCHAR) (str)[0]) || ('-' == (str)[0] && isdigit((UCHAR) (str)[1])))
+
+static BOOL
+plan_convert_float(char *value, char *dest)
+{
+	if (!is_plan_number(value))
+		return FALSE;
+	*((SFLOAT *) dest) = (float) strtod(value, NULL);
+	return TRUE;
+}
+
+static BOOL
+plan_convert_double(char *value, char *dest)
+{
+	if (!is_plan_number(value))
+		return FALSE;
+	*((SDOUBLE *) dest) = strtod(value, NULL);
+	return TRUE;
+}
+
+/* the value of 'n' digits at 'str', or -1 if they aren't all digits */
+static int
+plan_digits(const char *str, int n)
+{
+	int	i, v = 0;
+
+	for (i = 0; i < n; i++)
+	{
+		if (!isdigit((UCHAR) str[i]))
+			return -1;
+		v = v * 10 + (str[i] - '0');
+	}
+	return v;
+}
+
+/* Accepts "YYYY-MM-DD" only */
+static BOOL
+plan_convert_date(char *value, char *dest)
+{
+	DATE_STRUCT	*ds = (DATE_STRUCT *) dest;
+	int	y, m, d;
+
+	if ((y = plan_digits(value, 4)) < 0 || '-' != value[4] ||
+		(m = plan_digits(value + 5, 2)) < 0 || '-' != value[7] ||
+		(d = plan_digits(value + 8, 2)) < 0 || '\0' != value[10])
+		return FALSE;
+	ds->year = y;
+	ds->month = m;
+	ds->day = d;
+	return TRUE;
+}
+
+/*
+ *	Accepts "YYYY-MM-DD HH:MM:SS[.fraction][{+|-}zone]" the same way
+ *	timestamp2stime() does without the time zone.
+ */
+static BOOL
+plan_convert_timestamp(char *value, char *dest)
+{
+	TIMESTAMP_STRUCT *ts = (TIMESTAMP_STRUCT *) dest;
+	const char *p;
+	int	y, m, d, hh, mm, ss, i;
+	SQLUINTEGER	fr = 0;
+
+	if ((y = plan_digits(value, 4)) < 0 || '-' != value[4] ||
+		(m = plan_digits(value + 5, 2)) < 0 || '-' != value[7] ||
+		(d = plan_digits(value + 8, 2)) < 0 || ' ' != value[10] ||
+		(hh = plan_digits(value + 11, 2)) < 0 || ':' != value[13] ||
+		(mm = plan_digits(value + 14, 2)) < 0 || ':' != value[16] ||
+		(ss = plan_digits(value + 17, 2)) < 0)
+		return FALSE;
+	p = value + 19;
+	if ('.' == *p)
+	{
+		for (p++, i = 0; isdigit((UCHAR) *p); p++, i++)
+		{
+			if (i < 9)
+				fr = fr * 10 + (*p - '0');
+		}
+		for (; i < 9; i++)
+			fr *= 10;
+	}
+	if ('+' == *p || '-' == *p)
+	{
+		for (p++; isdigit((UCHAR) *p) || ':' == *p; p++)
+			;
+	}
+	if ('\0' != *p)
+		return FALSE;
+	ts->year = y;
+	ts->month = m;
+	ts->day = d;
+	ts->hour = hh;
+	ts->minute = mm;
+	ts->second = ss;
+	ts->fraction = fr;
+	return TRUE;
+}
+
+/*
+ *	Compile the conversion plan of the binding 'bic' for the result
+ *	column, unless it is compiled for it already.
+ */
+static const ConvertPlan *
+bind_convert_plan(const StatementClass *stmt, BindInfoClass *bic, OID field_type, int atttypmod, BOOL binary)
+{
+	const ConnectionClass *conn = SC_get_conn(stmt);
+	ConvertPlan	*plan = &bic->plan;
+	SQLSMALLINT	fCType = bic->returntype;
+	FieldConvertProc	convert = NULL;
+	SQLLEN		len = 0;
+
+	if (plan->compiled &&
+		plan->ctype == fCType &&
+		plan->pgtype == field_type &&
+		plan->atttypmod == atttypmod &&
+		plan->binary == binary)
+		return plan;
+
+	plan->compiled = TRUE;
+	plan->ctype = fCType;
+	plan->pgtype = field_type;
+	plan->atttypmod = atttypmod;
+	plan->binary = binary;
+	if (binary || NULL != conn->DataSourceToDriver)
+		goto done;
+	if (SQL_C_DEFAULT == fCType)
+		fCType = pgtype_attr_to_ctype(conn, field_type, atttypmod);
+	switch (field_type)
+	{
+		case PG_TYPE_INT2:
+		case PG_TYPE_INT4:
+		case PG_TYPE_INT8:
+		case PG_TYPE_FLOAT4:
+		case PG_TYPE_FLOAT8:
+		case PG_TYPE_NUMERIC:
+			switch (fCType)
+			{
+				case SQL_C_SSHORT:
+				case SQL_C_SHORT:
+					convert = plan_convert_short;
+					len = 2;
+					break;
+				case SQL_C_SLONG:
+				case SQL_C_LONG:
+					convert = plan_convert_long;
+					len = 4;
+					break;
+#ifdef ODBCINT64
+				case SQL_C_SBIGINT:
+					convert = plan_convert_bigint;
+					len = 8;
+					break;
+#endif /* ODBCINT64 */
+				case SQL_C_FLOAT:
+				case SQL_C_DOUBLE:
+#ifdef	HAVE_LOCALE_H
+					/*
+					 * strtod() expects the decimal point of the locale,
+					 * which is assumed not to change while fetching.
+					 */
+					if ('.' != get_current_decimal_point())
+						break;
+#endif /* HAVE_LOCALE_H */
+					if (SQL_C_FLOAT == fCType)
+					{
+						convert = plan_convert_float;
+						len = 4;
+					}
+					else
+					{
+						convert = plan_convert_double;
+						len = 8;
+					}
+					break;
+			}
+			break;
+		case PG_TYPE_DATE:
+			switch (fCType)
+			{
+				case SQL_C_DATE:
+				case SQL_C_TYPE_DATE:
+					convert = plan_convert_date;
+					len = 6;
+					break;
+			}
+			break;
+		case PG_TYPE_DATETIME:
+		case PG_TYPE_TIMESTAMP_NO_TMZONE:
+		case PG_TYPE_TIMESTAMP:
+			switch (fCType)
+			{
+				case SQL_C_TIMESTAMP:
+				case SQL_C_TYPE_TIMESTAMP:
+					convert = plan_convert_timestamp;
+					len = 16;
+					break;
+			}
+			break;
+	}
+done:
+	plan->convert = convert;
+	plan->len = len;
+	mylog("%s: type=%d ctype=%d planned=%d\n", __FUNCTION__, field_type, bic->returntype, NULL != convert);
+	return plan;
+}
+
+/*
+ *	Convert the field 'col' of 'nrows' rows into the column-wise bound
+ *	buffer of the column. 'tuples' points to the first row, the rows being
+ *	'num_fields' fields apart. On a failure, *failed_row is set to the row
+ *	of the first error or truncation.
+ */
+int
+copy_and_convert_column(StatementClass *stmt, OID field_type, int atttypmod,
+		const TupleField *tuples, int num_fields, SQLLEN nrows,
+		int col, BOOL binary, SQLLEN *failed_row)
+{
+	ARDFields *opts = SC_get_ARDF(stmt);
+	BindInfoClass *bic;
+	SQLULEN	offset = opts->row_offset_ptr ? *opts->row_offset_ptr : 0;
+	const ConvertPlan *plan;
+	FieldConvertProc	convert;
+	char	*buffer, *value;
+	SQLLEN	*used, *indicator, row;
+	int	retval, result = COPY_OK;
+
+	if (opts->allocated <= col)
+		extend_column_bindings(opts, col + 1);
+	bic = &(opts->bindings[col]);
+	buffer = bic->buffer + offset;
+	used = LENADDR_SHIFT(bic->used, offset);
+	indicator = LENADDR_SHIFT(bic->indicator, offset);
+	plan = bind_convert_plan(stmt, bic, field_type, atttypmod, binary);
+	convert = plan->convert;
+	for (row = 0; row < nrows; row++, tuples += num_fields)
+	{
+		value = tuples[col].value;
+		if (NULL != convert && NULL != value &&
+			convert(value, buffer + row * plan->len))
+		{
+			if (indicator)
+				indicator[row] = 0;
+			if (used)
+				used[row] = plan->len;
+			continue;
+		}
+		stmt->bind_row = (SQLSETPOSIROW) row;
+		retval = copy_and_convert_field_bindinfo(stmt, field_type, atttypmod, value, col, binary);
+		switch (retval)
+		{
+			case COPY_OK:
+			case COPY_NO_DATA_FOUND:
+				break;
+			case COPY_RESULT_TRUNCATED:
+				if (COPY_OK == result)
+				{
+					result = retval;
+					*failed_row = row;
+				}
+				break;
+			default:
+				*failed_row = row;
+				return retval;
+		}
+	}
+	return result;
+}
+
 static int char2guid(const char *str, SQLGUID *g)
 {
 	/*
@@ -827,7 +1198,7 @@ copy_and_convert_field(StatementClass *stmt,
 	ARDFields	*opts = SC_get_ARDF(stmt);
 	GetDataInfo	*gdata = SC_get_GDTI(stmt);
 	SQLLEN		len = 0,
-				copy_len = 0, needbuflen = 0;
+				copy_len = 0, needbuflen = 0, data_offset;
 	SIMPLE_TIME std_time;
 	time_t		stmt_t = SC_get_time(stmt);
 	struct tm  *tim;
@@ -843,7 +1214,7 @@ copy_and_convert_field(StatementClass *stmt,
 	int			bind_size = opts->bind_size;
 	int			result = COPY_OK;
 	const ConnectionClass	*conn = SC_get_conn(stmt);
-	BOOL		changed;
+	BOOL		changed, hex_format;
 	BOOL	text_handling, localize_needed;
 	const char *neut_str = value;
 	char		booltemp[3];
@@ -1223,6 +1594,7 @@ inolog("2stime fr=%d\n", std_time.fr);
 		/* Special character formatting as required */
 
 		BOOL	hex_bin_format = FALSE;
+		BOOL	wchar_by_piece = FALSE;
 		/*
 		 * These really should return error if cbValueMax is not big
 		 * enough.
@@ -1313,7 +1685,15 @@ inolog("2stime fr=%d\n", std_time.fr);
 					pgdc = &gdata->gdata[stmt->current_col];
 #ifdef	UNICODE_SUPPORT
 				if (fCType == SQL_C_WCHAR)
+				{
 					wconverted = TRUE;
+					/*
+					 * Convert only the piece each call returns, except
+					 * for the escape format of bytea.
+					 */
+					if (PG_TYPE_BYTEA != field_type || hex_bin_format)
+						wchar_by_piece = TRUE;
+				}
 #endif /* UNICODE_SUPPORT */
 				if (pgdc->data_left < 0)
 				{
@@ -1327,7 +1707,8 @@ inolog("2stime fr=%d\n", std_time.fr);
 							len = convert_from_pgbinary(neut_str, NULL, 0);
 							len *= 2;
 						}
-						changed = TRUE;
+						/* the hex format is returned as it is */
+						changed = !hex_bin_format;
 #ifdef	UNICODE_SUPPORT
 						if (fCType == SQL_C_WCHAR)
 							len *= WCLEN;
@@ -1394,7 +1775,7 @@ inolog("2stime fr=%d\n", std_time.fr);
 						default:
 							needbuflen++;
 					}
-					if (changed || needbuflen > cbValueMax)
+					if (changed && !wchar_by_piece)
 					{
 						if (needbuflen > (SQLLEN) pgdc->ttlbuflen)
 						{
@@ -1404,28 +1785,15 @@ inolog("2stime fr=%d\n", std_time.fr);
 #ifdef	UNICODE_SUPPORT
 						if (fCType == SQL_C_WCHAR)
 						{
-							if (PG_TYPE_BYTEA == field_type && !hex_bin_format)
-							{
-								len = convert_from_pgbinary(neut_str, pgdc->ttlbuf, pgdc->ttlbuflen);
-								len = pg_bin2whex(pgdc->ttlbuf, (SQLWCHAR *) pgdc->ttlbuf, len);
-							}
-							else
-								utf8_to_ucs2_lf(neut_str, SQL_NTS, lf_conv, (SQLWCHAR *) pgdc->ttlbuf, len / WCLEN, FALSE);
+							len = convert_from_pgbinary(neut_str, pgdc->ttlbuf, pgdc->ttlbuflen);
+							len = pg_bin2whex(pgdc->ttlbuf, (SQLWCHAR *) pgdc->ttlbuf, len);
 						}
 						else
 #endif /* UNICODE_SUPPORT */
 						if (PG_TYPE_BYTEA == field_type)
 						{
-							if (hex_bin_format)
-							{
-								len = strlen(neut_str);
-								strncpy_null(pgdc->ttlbuf, neut_str, pgdc->ttlbuflen);
-							}
-							else
-							{
-								len = convert_from_pgbinary(neut_str, pgdc->ttlbuf, pgdc->ttlbuflen);
-								len = pg_bin2hex(pgdc->ttlbuf, pgdc->ttlbuf, len);
-							}
+							len = convert_from_pgbinary(neut_str, pgdc->ttlbuf, pgdc->ttlbuflen);
+							len = pg_bin2hex(pgdc->ttlbuf, pgdc->ttlbuf, len);
 						}
 						else
 #ifdef	WIN_UNICODE_SUPPORT
@@ -1443,17 +1811,25 @@ inolog("2stime fr=%d\n", std_time.fr);
 					}
 					else
 					{
+						/*
+						 * The following calls return the rest of the
+						 * value from the tuple, without a copy.
+						 */
 						if (pgdc->ttlbuf)
 						{
 							free(pgdc->ttlbuf);
 							pgdc->ttlbuf = NULL;
 						}
+						pgdc->ttlbuflen = needbuflen;
+						pgdc->ttlbufused = len;
 						ptr = neut_str;
 					}
+					pgdc->data_pos = 0;
+					pgdc->pending_wchar = 0;
 				}
 				else
 				{
-					ptr = pgdc->ttlbuf;
+					ptr = pgdc->ttlbuf ? pgdc->ttlbuf : neut_str;
 					len = pgdc->ttlbufused;
 				}
 
@@ -1463,7 +1839,8 @@ inolog("2stime fr=%d\n", std_time.fr);
 				{
 					if (pgdc->data_left > 0)
 					{
-						ptr += len - pgdc->data_left;
+						if (!wchar_by_piece)
+							ptr += len - pgdc->data_left;
 						len = pgdc->data_left;
 						needbuflen = len + (pgdc->ttlbuflen - pgdc->ttlbufused);
 					}
@@ -1498,6 +1875,24 @@ inolog("2stime fr=%d\n", std_time.fr);
 					else
 						copy_len = len;
 
+#ifdef	UNICODE_SUPPORT
+					if (wchar_by_piece)
+					{
+						SQLLEN	wcopy_len = copy_len;
+
+						/* Convert the next piece from the position left */
+						copy_len = WCLEN * utf8_to_ucs2_next(neut_str,
+							conn->connInfo.lf_conversion,
+							(SQLWCHAR *) rgbValueBindRow, copy_len / WCLEN,
+							&pgdc->data_pos, &pgdc->pending_wchar);
+						/* the value ended early, being invalid */
+						if (copy_len < wcopy_len)
+							pgdc->data_left = copy_len;
+						for (i = 0; i < terminatorlen && copy_len + i < cbValueMax; i++)
+							rgbValueBindRow[copy_len + i] = '\0';
+						already_copied = TRUE;
+					}
+#endif /* UNICODE_SUPPORT */
 					if (!already_copied)
 					{
 						/* Copy the data */
@@ -1812,6 +2207,11 @@ inolog("SQL_C_VARBOOKMARK value=%d\n", ival);
 					pgdc = &gdata->gdata[stmt->current_col];
 				if (!pgdc->ttlbuf)
 					pgdc->ttlbuflen = 0;
+				/*
+				 * The hex format is decoded piece by piece from the
+				 * tuple, the escape format as a whole.
+				 */
+				hex_format = (0 == strnicmp(neut_str, "\\x", 2));
 				if (pgdc->data_left < 0)
 				{
 					if (cbValueMax <= 0)
@@ -1820,17 +2220,29 @@ inolog("SQL_C_VARBOOKMARK value=%d\n", ival);
 						result = COPY_RESULT_TRUNCATED;
 						break;
 					}
-					if (len = strlen(neut_str), len >= (int) pgdc->ttlbuflen)
+					if (hex_format)
 					{
-						pgdc->ttlbuf = realloc(pgdc->ttlbuf, len + 1);
-						pgdc->ttlbuflen = len + 1;
+						if (pgdc->ttlbuf)
+						{
+							free(pgdc->ttlbuf);
+							pgdc->ttlbuf = NULL;
+						}
+						len = strlen(neut_str + 2) / 2;
+					}
+					else
+					{
+						if (len = strlen(neut_str), len >= (int) pgdc->ttlbuflen)
+						{
+							pgdc->ttlbuf = realloc(pgdc->ttlbuf, len + 1);
+							pgdc->ttlbuflen = len + 1;
+						}
+						len = convert_from_pgbinary(neut_str, pgdc->ttlbuf, pgdc->ttlbuflen);
 					}
-					len = convert_from_pgbinary(neut_str, pgdc->ttlbuf, pgdc->ttlbuflen);
 					pgdc->ttlbufused = len;
 				}
 				else
 					len = pgdc->ttlbufused;
-				ptr = pgdc->ttlbuf;
+				data_offset = 0;
 
 				if (stmt->current_col >= 0)
 				{
@@ -1840,7 +2252,7 @@ inolog("SQL_C_VARBOOKMARK value=%d\n", ival);
 					 */
 					if (pgdc->data_left > 0)
 					{
-						ptr += len - pgdc->data_left;
+						data_offset = len - pgdc->data_left;
 						len = pgdc->data_left;
 					}
 
@@ -1855,7 +2267,10 @@ inolog("SQL_C_VARBOOKMARK value=%d\n", ival);
 					copy_len = (len > cbValueMax) ? cbValueMax : len;
 
 					/* Copy the data */
-					memcpy(rgbValueBindRow, ptr, copy_len);
+					if (hex_format)
+						pg_hex2bin_piece(neut_str + 2 + 2 * data_offset, rgbValueBindRow, copy_len);
+					else
+						memcpy(rgbValueBindRow, pgdc->ttlbuf + data_offset, copy_len);
 
 					/* Adjust data_left for next time */
 					if (stmt->current_col >= 0)
@@ -1920,6 +2335,373 @@ inolog("SQL_C_VARBOOKMARK value=%d\n", ival);
 
 }
 
+/*
+ *	Values received in binary format.
+ *
+ *	libpq lets us request the same format for all the columns of a
+ *	result, so binary format is requested only if every column is of
+ *	a type binary_result_supported() accepts. Text-like types have the
+ *	same representation in both formats. Integer and floating point
+ *	values bound to a matching C type are stored directly, the others
+ *	are converted to the text the server would have sent and passed to
+ *	copy_and_convert_field().
+ */
+BOOL
+binary_result_supported(OID type)
+{
+	switch (type)
+	{
+		case PG_TYPE_BOOL:
+		case PG_TYPE_INT2:
+		case PG_TYPE_INT4:
+		case PG_TYPE_OID:
+		case PG_TYPE_FLOAT4:
+		case PG_TYPE_DATE:
+		case PG_TYPE_UUID:
+		case PG_TYPE_NAME:
+		case PG_TYPE_TEXT:
+		case PG_TYPE_BPCHAR:
+		case PG_TYPE_VARCHAR:
+#ifdef ODBCINT64
+		case PG_TYPE_INT8:
+		case PG_TYPE_FLOAT8:
+		case PG_TYPE_TIMESTAMP_NO_TMZONE:
+#endif /* ODBCINT64 */
+			return TRUE;
+	}
+	return FALSE;
+}
+
+#define	POSTGRES_EPOCH_JDATE	2451545		/* julian day of 2000-01-01 */
+
+static Int2
+binary_int2(const UCHAR *p)
+{
+	return (Int2) ((p[0] << 8) | p[1]);
+}
+
+static Int4
+binary_int4(const UCHAR *p)
+{
+	return (Int4) (((UInt4) p[0] << 24) | ((UInt4) p[1] << 16) |
+				   ((UInt4) p[2] << 8) | (UInt4) p[3]);
+}
+
+static float
+binary_float4(const UCHAR *p)
+{
+	UInt4	i = (UInt4) binary_int4(p);
+	float	f;
+
+	memcpy(&f, &i, sizeof(f));
+	return f;
+}
+
+#ifdef ODBCINT64
+static SQLBIGINT
+binary_int8(const UCHAR *p)
+{
+	return (SQLBIGINT) (((SQLUBIGINT) (UInt4) binary_int4(p) << 32) |
+						(UInt4) binary_int4(p + 4));
+}
+
+static double
+binary_float8(const UCHAR *p)
+{
+	SQLBIGINT	i = binary_int8(p);
+	double		d;
+
+	memcpy(&d, &i, sizeof(d));
+	return d;
+}
+#endif /* ODBCINT64 */
+
+/* julian day to gregorian date, the same algorithm as the server's */
+static void
+j2date(int jd, int *year, int *month, int *day)
+{
+	unsigned int julian, quad, extra;
+	int		y;
+
+	julian = jd;
+	julian += 32044;
+	quad = julian / 146097;
+	extra = (julian - quad * 146097) * 4 + 3;
+	julian += 60 + quad * 3 + extra / 146097;
+	quad = julian / 1461;
+	julian -= quad * 1461;
+	y = julian * 4 / 1461;
+	julian = ((y != 0) ? ((julian + 305) % 365) : ((julian + 306) % 366))
+		+ 123;
+	y += quad * 4;
+	*year = y - 4800;
+	quad = julian * 2141 / 65536;
+	*day = julian - 7834 * quad / 256;
+	*month = (quad + 10) % 12 + 1;
+}
+
+/* days since 2000-01-01 in DateStyle ISO */
+static void
+binary_date_to_text(int days, const char *timestr, char *buf, size_t bufsize)
+{
+	int		y, m, d;
+
+	j2date(days + POSTGRES_EPOCH_JDATE, &y, &m, &d);
+	if (y > 0)
+		snprintf(buf, bufsize, "%04d-%02d-%02d%s", y, m, d, timestr);
+	else
+		snprintf(buf, bufsize, "%04d-%02d-%02d%s BC", 1 - y, m, d, timestr);
+}
+
+/*
+ * the shortest representation which reads back as the same value, as
+ * servers 12 and later send it
+ */
+static void
+binary_float_to_text(double v, BOOL is_float4, char *buf, size_t bufsize)
+{
+	int		digits;
+
+	if (v != v)
+		snprintf(buf, bufsize, "%s", NAN_STRING);
+	else if (v >= HUGE_VAL)
+		snprintf(buf, bufsize, "%s", INFINITY_STRING);
+	else if (v <= -HUGE_VAL)
+		snprintf(buf, bufsize, "%s", MINFINITY_STRING);
+	else
+	{
+		for (digits = is_float4 ? FLT_DIG : DBL_DIG;; digits++)
+		{
+			snprintf(buf, bufsize, "%.*g", digits, v);
+			if (is_float4)
+			{
+				if (digits >= FLT_DIG + 3 ||
+					(float) strtod(buf, NULL) == (float) v)
+					break;
+			}
+			else if (digits >= DBL_DIG + 2 ||
+					 strtod(buf, NULL) == v)
+				break;
+		}
+		set_server_decimal_point(buf, SQL_NTS);
+	}
+}
+
+static const char *
+binary_value_to_text(OID field_type, const UCHAR *value, char *buf, size_t bufsize)
+{
+	int		i;
+
+	switch (field_type)
+	{
+		case PG_TYPE_BOOL:
+			snprintf(buf, bufsize, "%s", value[0] ? "t" : "f");
+			break;
+		case PG_TYPE_INT2:
+			snprintf(buf, bufsize, "%d", binary_int2(value));
+			break;
+		case PG_TYPE_INT4:
+			snprintf(buf, bufsize, "%d", binary_int4(value));
+			break;
+		case PG_TYPE_OID:
+			snprintf(buf, bufsize, "%u", (UInt4) binary_int4(value));
+			break;
+		case PG_TYPE_FLOAT4:
+			binary_float_to_text(binary_float4(value), TRUE, buf, bufsize);
+			break;
+		case PG_TYPE_DATE:
+			i = binary_int4(value);
+			if (INT_MAX == i)
+				snprintf(buf, bufsize, "infinity");
+			else if (INT_MIN == i)
+				snprintf(buf, bufsize, "-infinity");
+			else
+				binary_date_to_text(i, "", buf, bufsize);
+			break;
+		case PG_TYPE_UUID:
+			buf[0] = '\0';
+			for (i = 0; i < 16; i++)
+				snprintf(buf + strlen(buf), bufsize - strlen(buf),
+						 (4 == i || 6 == i || 8 == i || 10 == i) ? "-%02x" : "%02x",
+						 value[i]);
+			break;
+#ifdef ODBCINT64
+		case PG_TYPE_INT8:
+			snprintf(buf, bufsize, FORMATI64, binary_int8(value));
+			break;
+		case PG_TYPE_FLOAT8:
+			binary_float_to_text(binary_float8(value), FALSE, buf, bufsize);
+			break;
+		case PG_TYPE_TIMESTAMP_NO_TMZONE:
+			{
+				const SQLBIGINT	usecs_per_day = (SQLBIGINT) 86400 * 1000000;
+				const SQLBIGINT	max_ts = (SQLBIGINT) (~(SQLUBIGINT) 0 >> 1);
+				SQLBIGINT	ts = binary_int8(value), days, usecs;
+				int			secs, fsec;
+				char		timestr[32];
+
+				if (max_ts == ts)
+				{
+					snprintf(buf, bufsize, "infinity");
+					break;
+				}
+				else if (-max_ts - 1 == ts)
+				{
+					snprintf(buf, bufsize, "-infinity");
+					break;
+				}
+				days = ts / usecs_per_day;
+				usecs = ts % usecs_per_day;
+				if (usecs < 0)
+				{
+					usecs += usecs_per_day;
+					days--;
+				}
+				secs = (int) (usecs / 1000000);
+				fsec = (int) (usecs % 1000000);
+				snprintf(timestr, sizeof(timestr), " %02d:%02d:%02d",
+						 secs / 3600, secs / 60 % 60, secs % 60);
+				if (fsec > 0)
+				{
+					size_t	tlen;
+
+					snprintf(timestr + strlen(timestr), sizeof(timestr) - strlen(timestr), ".%06d", fsec);
+					for (tlen = strlen(timestr); '0' == timestr[tlen - 1]; tlen--)
+						timestr[tlen - 1] = '\0';
+				}
+				binary_date_to_text((int) days, timestr, buf, bufsize);
+			}
+			break;
+#endif /* ODBCINT64 */
+		default:
+			/* text-like types */
+			return (const char *) value;
+	}
+	return buf;
+}
+
+/*	This is called instead of copy_and_convert_field() for binary columns */
+int
+copy_and_convert_binary_field(StatementClass *stmt,
+		OID field_type, int atttypmod,
+		void *valuei,
+		SQLSMALLINT fCType, int precision,
+		PTR rgbValue, SQLLEN cbValueMax,
+		SQLLEN *pcbValue, SQLLEN *pIndicator)
+{
+	const UCHAR *value = valuei;
+	char		textbuf[64];
+
+	if (NULL == value)
+		return copy_and_convert_field(stmt, field_type, atttypmod, NULL,
+				fCType, precision, rgbValue, cbValueMax, pcbValue, pIndicator);
+
+	/*
+	 * Store fixed-width numbers into bound columns directly. SQLGetData()
+	 * is left to copy_and_convert_field() which keeps track of the
+	 * columns already got.
+	 */
+	if (stmt->current_col < 0 && NULL != rgbValue)
+	{
+		ARDFields  *opts = SC_get_ARDF(stmt);
+		SQLSETPOSIROW	bind_row = stmt->bind_row;
+		int			bind_size = opts->bind_size;
+		SQLLEN		pcbValueOffset;
+		SQLSMALLINT	sval;
+		SQLINTEGER	ival;
+		SFLOAT		fval;
+		SDOUBLE		dval;
+#ifdef ODBCINT64
+		SQLBIGINT	bval;
+#endif /* ODBCINT64 */
+		const void *src = NULL;
+		SQLLEN		len = 0;
+
+		switch (fCType)
+		{
+			case SQL_C_SSHORT:
+			case SQL_C_SHORT:
+				if (PG_TYPE_INT2 != field_type)
+					break;
+				sval = binary_int2(value);
+				src = &sval;
+				len = sizeof(sval);
+				break;
+			case SQL_C_SLONG:
+			case SQL_C_LONG:
+				if (PG_TYPE_INT2 == field_type)
+					ival = binary_int2(value);
+				else if (PG_TYPE_INT4 == field_type)
+					ival = binary_int4(value);
+				else
+					break;
+				src = &ival;
+				len = sizeof(ival);
+				break;
+#ifdef ODBCINT64
+			case SQL_C_SBIGINT:
+				if (PG_TYPE_INT2 == field_type)
+					bval = binary_int2(value);
+				else if (PG_TYPE_INT4 == field_type)
+					bval = binary_int4(value);
+				else if (PG_TYPE_INT8 == field_type)
+					bval = binary_int8(value);
+				else
+					break;
+				src = &bval;
+				len = sizeof(bval);
+				break;
+#endif /* ODBCINT64 */
+			case SQL_C_FLOAT:
+				if (PG_TYPE_FLOAT4 == field_type)
+					fval = binary_float4(value);
+#ifdef ODBCINT64
+				else if (PG_TYPE_FLOAT8 == field_type)
+					fval = (SFLOAT) binary_float8(value);
+#endif /* ODBCINT64 */
+				else
+					break;
+				src = &fval;
+				len = sizeof(fval);
+				break;
+			case SQL_C_DOUBLE:
+				/* float4 isn't here, the text form rounds differently */
+				if (PG_TYPE_INT2 == field_type)
+					dval = binary_int2(value);
+				else if (PG_TYPE_INT4 == field_type)
+					dval = binary_int4(value);
+#ifdef ODBCINT64
+				else if (PG_TYPE_INT8 == field_type)
+					dval = (SDOUBLE) binary_int8(value);
+				else if (PG_TYPE_FLOAT8 == field_type)
+					dval = binary_float8(value);
+#endif /* ODBCINT64 */
+				else
+					break;
+				src = &dval;
+				len = sizeof(dval);
+				break;
+		}
+		if (NULL != src)
+		{
+			if (bind_size > 0)
+				pcbValueOffset = bind_size * bind_row;
+			else
+				pcbValueOffset = bind_row * sizeof(SQLLEN);
+			memcpy((char *) rgbValue + (bind_size > 0 ? bind_size : len) * bind_row, src, len);
+			if (pIndicator)
+				*LENADDR_SHIFT(pIndicator, pcbValueOffset) = 0;
+			if (pcbValue)
+				*LENADDR_SHIFT(pcbValue, pcbValueOffset) = len;
+			return COPY_OK;
+		}
+	}
+
+	return copy_and_convert_field(stmt, field_type, atttypmod,
+			(void *) binary_value_to_text(field_type, value, textbuf, sizeof(textbuf)),
+			fCType, precision, rgbValue, cbValueMax, pcbValue, pIndicator);
+}
+
 
 /*--------------------------------------------------------------------
  *	Functions/Macros to get rid of query size limit.
@@ -2013,6 +2795,55 @@ typedef enum
 #define	FLGB_BINARY_AS_POSSIBLE	(1L << 9)
 #define	FLGB_LITERAL_EXTENSION	(1L << 10)
 #define	FLGB_HEX_BIN_FORMAT	(1L << 11)
+
+/*
+ * A statement converted by copy_statement_with_parameters() is kept by
+ * the connection as a template, so that the next executions of the same
+ * statement only resolve the parameters instead of scanning it again.
+ * The body is the converted statement after the declare cursor prefix,
+ * without the values of the parameters, and the slots are the positions
+ * in the body where the values go.
+ */
+typedef struct
+{
+	size_t	pos;
+	size_t	len;		/* of the value while recording */
+	Int2	param_number;
+}	TemplateSlot;
+
+typedef struct SqlTemplate_
+{
+	/* the key */
+	char	*statement;
+	UInt4	hash;
+	int	statement_type;
+	UInt4	flags;		/* FLGP_USING_CURSOR and TEMPLATE_KEY_FLAGS */
+	int	ccsc;
+	char	escape_in_literal;
+	/* the result of the scan */
+	int	result_statement_type;
+	UInt4	result_flags;	/* FLGP_xxxx */
+	po_ind_t	join_info;
+	char	*body;
+	Int2	num_slots;
+	Int2	slots_allocated;
+	TemplateSlot	*slots;
+	/* while recording */
+	const struct _QueryBuild *owner;
+	BOOL	cacheable;
+	/* while cached */
+	Int4	refcnt;
+	UInt4	last_used;
+}	SqlTemplate;
+
+#define	TEMPLATE_KEY_FLAGS	(FLGB_CONVERT_LF | FLGB_DISCARD_OUTPUT | FLGB_LITERAL_EXTENSION | FLGB_HEX_BIN_FORMAT)
+#define	SQL_TEMPLATE_CACHE_SIZE	32	/* per connection */
+#define	QB_no_template(qb) \
+do { \
+	if ((qb)->tmpl) \
+		(qb)->tmpl->cacheable = FALSE; \
+} while (0)
+
 typedef struct _QueryBuild {
 	char   *query_statement;
 	size_t	str_alsize;
@@ -2038,6 +2869,7 @@ typedef struct _QueryBuild {
 
 	ConnectionClass	*conn; /* mainly needed for LO handling */
 	StatementClass	*stmt; /* needed to set error info in ENLARGE_.. */
+	SqlTemplate	*tmpl; /* being recorded */
 }	QueryBuild;
 
 #define INIT_MIN_ALLOC	4096
@@ -2059,6 +2891,7 @@ QB_initialize(QueryBuild *qb, size_t size, StatementClass *stmt, ResolveParamMod
 	qb->num_discard_params = 0;
 	qb->brace_level = 0;
 	qb->parenthesize_the_first = FALSE;
+	qb->tmpl = NULL;
 
 	/* Copy options from statement */
 	qb->apdopts = SC_get_APDF(stmt);
@@ -2762,31 +3595,264 @@ RETCODE	prepareParameters(StatementClass *stmt, BOOL fake_params)
 
 	switch (stmt->prepared)
 	{
-		case PREPARED_TEMPORARILY:
-			if (conn->unnamed_prepared_stmt == stmt)
-				return SQL_SUCCESS;
-			else
-				break;
-		case NOT_YET_PREPARED:
-		case PREPARING_PERMANENTLY:
-		case PREPARING_TEMPORARILY:
-			break;
-		default:
-			return SQL_SUCCESS;
+		case PREPARED_TEMPORARILY:
+			if (conn->unnamed_prepared_stmt == stmt)
+				return SQL_SUCCESS;
+			else
+				break;
+		case NOT_YET_PREPARED:
+		case PREPARING_PERMANENTLY:
+		case PREPARING_TEMPORARILY:
+			break;
+		default:
+			return SQL_SUCCESS;
+	}
+
+inolog("prepareParameters\n");
+
+	if (prepareParametersNoDesc(stmt, fake_params) == SQL_ERROR)
+		return SQL_ERROR;
+	return desc_params_and_sync(stmt);
+}
+
+/*
+ *	This function inserts parameters into an SQL statements.
+ *	It will also modify a SELECT statement for use with declare/fetch cursors.
+ *	This function does a dynamic memory allocation to get rid of query size limit!
+ */
+static void remove_declare_cursor(QueryBuild *qb, QueryParse *qp);
+
+static void
+SqlTemplate_free(SqlTemplate *tmpl)
+{
+	if (tmpl->statement)
+		free(tmpl->statement);
+	if (tmpl->body)
+		free(tmpl->body);
+	if (tmpl->slots)
+		free(tmpl->slots);
+	free(tmpl);
+}
+
+void
+clear_sql_templates(ConnectionClass *conn)
+{
+	int	i;
+
+	for (i = 0; i < conn->num_sql_templates; i++)
+		SqlTemplate_free(conn->sql_templates[i]);
+	if (conn->sql_templates)
+		free(conn->sql_templates);
+	conn->sql_templates = NULL;
+	conn->num_sql_templates = 0;
+}
+
+/* The statement and the options its conversion depends on */
+static void
+QB_template_key(SqlTemplate *key, const QueryBuild *qb, const QueryParse *qp)
+{
+	const char	*p;
+
+	memset(key, 0, sizeof(SqlTemplate));
+	key->statement = (char *) qp->statement;
+	for (p = qp->statement; *p; p++)
+		key->hash = key->hash * 31 + (UCHAR) *p;
+	key->statement_type = qp->statement_type;
+	key->flags = (qp->flags & FLGP_USING_CURSOR) | (qb->flags & TEMPLATE_KEY_FLAGS);
+	key->ccsc = qb->ccsc;
+	key->escape_in_literal = CC_get_escape(qb->conn);
+}
+
+/*
+ *	Look for the template of the statement. It's used by the caller
+ *	until release_sql_template().
+ */
+static SqlTemplate *
+find_sql_template(ConnectionClass *conn, const SqlTemplate *key)
+{
+	SqlTemplate	*tmpl, *found = NULL;
+	int	i;
+
+	CONNLOCK_ACQUIRE(conn);
+	for (i = 0; i < conn->num_sql_templates; i++)
+	{
+		tmpl = conn->sql_templates[i];
+		if (tmpl->hash == key->hash &&
+		    tmpl->statement_type == key->statement_type &&
+		    tmpl->flags == key->flags &&
+		    tmpl->ccsc == key->ccsc &&
+		    tmpl->escape_in_literal == key->escape_in_literal &&
+		    strcmp(tmpl->statement, key->statement) == 0)
+		{
+			tmpl->refcnt++;
+			tmpl->last_used = ++conn->template_counter;
+			found = tmpl;
+			break;
+		}
+	}
+	CONNLOCK_RELEASE(conn);
+
+	return found;
+}
+
+static void
+release_sql_template(ConnectionClass *conn, SqlTemplate *tmpl)
+{
+	CONNLOCK_ACQUIRE(conn);
+	tmpl->refcnt--;
+	CONNLOCK_RELEASE(conn);
+}
+
+/*
+ *	Record where the value of the parameter just resolved by
+ *	inner_process_tokens() went. The statement can't be kept as a
+ *	template if the value was written into a copy of the QueryBuild
+ *	(the arguments of an escaped function) or had an effect on the
+ *	text around it (a discarded output parameter).
+ */
+static void
+QB_add_template_slot(QueryBuild *qb, const QueryParse *qp, size_t npos, int retval)
+{
+	SqlTemplate	*tmpl = qb->tmpl;
+	TemplateSlot	*slot;
+
+	if (!tmpl->cacheable)
+		return;
+	if (tmpl->owner != qb || SQL_SUCCESS != retval)
+	{
+		tmpl->cacheable = FALSE;
+		return;
+	}
+	if (tmpl->num_slots >= tmpl->slots_allocated)
+	{
+		Int2	new_alloc = tmpl->slots_allocated > 0 ? tmpl->slots_allocated * 2 : 16;
+		TemplateSlot	*slots;
+
+		if (new_alloc <= 0 ||
+		    (slots = (TemplateSlot *) realloc(tmpl->slots, sizeof(TemplateSlot) * new_alloc)) == NULL)
+		{
+			tmpl->cacheable = FALSE;
+			return;
+		}
+		tmpl->slots = slots;
+		tmpl->slots_allocated = new_alloc;
+	}
+	slot = tmpl->slots + tmpl->num_slots++;
+	/* relative to the declare cursor prefix, which may be removed later */
+	slot->pos = npos - qp->declare_pos;
+	slot->len = qb->npos - npos;
+	slot->param_number = qb->param_number;
+}
+
+/*
+ *	Complete the template recorded while converting the statement and
+ *	keep it in the cache of the connection, replacing the least recently
+ *	used one if the cache is full. Only the statements with parameters
+ *	are kept.
+ */
+static void
+QB_end_template(QueryBuild *qb, const QueryParse *qp, BOOL keep)
+{
+	ConnectionClass	*conn = qb->conn;
+	SqlTemplate	*tmpl = qb->tmpl;
+	const char	*converted = qb->query_statement + qp->declare_pos;
+	size_t		from, opos;
+	int		i, lru;
+
+	qb->tmpl = NULL;
+	if (!keep || !tmpl->cacheable || 0 == tmpl->num_slots)
+		goto discard;
+	if (tmpl->statement = strdup(qp->statement), NULL == tmpl->statement)
+		goto discard;
+	if (tmpl->body = malloc(qb->npos - qp->declare_pos + 1), NULL == tmpl->body)
+		goto discard;
+	/* cut the values of the parameters out of the converted statement */
+	for (i = 0, from = opos = 0; i < tmpl->num_slots; i++)
+	{
+		TemplateSlot	*slot = tmpl->slots + i;
+
+		memcpy(tmpl->body + opos, converted + from, slot->pos - from);
+		opos += (slot->pos - from);
+		from = slot->pos + slot->len;
+		slot->pos = opos;
+		slot->len = 0;
+	}
+	strcpy(tmpl->body + opos, converted + from);
+	tmpl->result_statement_type = qp->statement_type;
+	tmpl->result_flags = qp->flags;
+	tmpl->join_info = qb->stmt->join_info;
+	tmpl->owner = NULL;
+	tmpl->refcnt = 0;
+
+	CONNLOCK_ACQUIRE(conn);
+	if (NULL == conn->sql_templates)
+		conn->sql_templates = (SqlTemplate **) malloc(sizeof(SqlTemplate *) * SQL_TEMPLATE_CACHE_SIZE);
+	if (NULL == conn->sql_templates)
+		lru = -1;
+	else if (conn->num_sql_templates < SQL_TEMPLATE_CACHE_SIZE)
+		lru = conn->num_sql_templates++;
+	else
+	{
+		for (i = 0, lru = -1; i < conn->num_sql_templates; i++)
+		{
+			if (conn->sql_templates[i]->refcnt <= 0 &&
+			    (lru < 0 || conn->sql_templates[i]->last_used < conn->sql_templates[lru]->last_used))
+				lru = i;
+		}
+		if (lru >= 0)
+			SqlTemplate_free(conn->sql_templates[lru]);
+	}
+	if (lru >= 0)
+	{
+		tmpl->last_used = ++conn->template_counter;
+		conn->sql_templates[lru] = tmpl;
 	}
-
-inolog("prepareParameters\n");
-
-	if (prepareParametersNoDesc(stmt, fake_params) == SQL_ERROR)
-		return SQL_ERROR;
-	return desc_params_and_sync(stmt);
+	CONNLOCK_RELEASE(conn);
+	if (lru >= 0)
+	{
+		mylog("%s: %d slots for %s\n", __FUNCTION__, tmpl->num_slots, tmpl->statement);
+		return;
+	}
+discard:
+	SqlTemplate_free(tmpl);
 }
 
 /*
- *	This function inserts parameters into an SQL statements.
- *	It will also modify a SELECT statement for use with declare/fetch cursors.
- *	This function does a dynamic memory allocation to get rid of query size limit!
+ *	Build the converted statement from its template instead of calling
+ *	inner_process_tokens(). Only the parameters are resolved.
  */
+static int
+QB_apply_template(QueryBuild *qb, QueryParse *qp, const SqlTemplate *tmpl)
+{
+	RETCODE	retval = SQL_SUCCESS;
+	size_t	from = 0;
+	int	i;
+	BOOL	isnull, isbinary;
+	OID	dummy;
+
+	if (0 == (tmpl->result_flags & FLGP_USING_CURSOR))
+		remove_declare_cursor(qb, qp);
+	for (i = 0; i < tmpl->num_slots; i++)
+	{
+		const TemplateSlot	*slot = tmpl->slots + i;
+
+		CVT_APPEND_DATA(qb, tmpl->body + from, slot->pos - from);
+		from = slot->pos;
+		qb->param_number = slot->param_number - 1;
+		retval = ResolveOneParam(qb, NULL, &isnull, &isbinary, &dummy);
+		if (retval < 0)
+			goto cleanup;
+	}
+	CVT_APPEND_STR(qb, tmpl->body + from);
+	qp->opos = qp->stmt_len;
+	qp->flags = tmpl->result_flags;
+	qp->statement_type = tmpl->result_statement_type;
+	qb->stmt->join_info |= tmpl->join_info;
+	retval = SQL_SUCCESS;
+cleanup:
+	return retval;
+}
+
 int
 copy_statement_with_parameters(StatementClass *stmt, BOOL buildPrepareStatement)
 {
@@ -2800,6 +3866,7 @@ copy_statement_with_parameters(StatementClass *stmt, BOOL buildPrepareStatement)
 	ConnectionClass *conn = SC_get_conn(stmt);
 	ConnInfo   *ci = &(conn->connInfo);
 	const		char *bestitem = NULL;
+	SqlTemplate	*tmpl = NULL;
 
 inolog("%s: enter prepared=%d\n", func, stmt->prepared);
 	if (!stmt->statement)
@@ -2951,16 +4018,51 @@ inolog("type=%d concur=%d\n", stmt->options.cursor_type, stmt->options.scroll_co
 		}
 	}
 
-	for (qp->opos = 0; qp->opos < qp->stmt_len; qp->opos++)
+	/*
+	 * Use the template of the statement if it was converted before,
+	 * else record one while converting it.
+	 */
+	if (0 == (qb->flags & FLGB_CREATE_KEYSET) &&
+	    qb->num_output_params <= 0 &&
+	    qb->proc_return <= 0)
+	{
+		SqlTemplate	key;
+
+		QB_template_key(&key, qb, qp);
+		if (tmpl = find_sql_template(conn, &key), NULL != tmpl)
+		{
+			retval = QB_apply_template(qb, qp, tmpl);
+			release_sql_template(conn, tmpl);
+			if (SQL_ERROR == retval)
+			{
+				QB_replace_SC_error(stmt, qb, func);
+				QB_Destructor(qb);
+				return retval;
+			}
+		}
+		else if (qb->tmpl = (SqlTemplate *) malloc(sizeof(SqlTemplate)), NULL != qb->tmpl)
+		{
+			*qb->tmpl = key;
+			qb->tmpl->statement = NULL;
+			qb->tmpl->owner = qb;
+			qb->tmpl->cacheable = TRUE;
+		}
+	}
+
+	for (qp->opos = (tmpl ? qp->stmt_len : 0); qp->opos < qp->stmt_len; qp->opos++)
 	{
 		retval = inner_process_tokens(qp, qb);
 		if (SQL_ERROR == retval)
 		{
+			if (qb->tmpl)
+				QB_end_template(qb, qp, FALSE);
 			QB_replace_SC_error(stmt, qb, func);
 			QB_Destructor(qb);
 			return retval;
 		}
 	}
+	if (qb->tmpl)
+		QB_end_template(qb, qp, TRUE);
 	/* make sure new_statement is always null-terminated */
 	CVT_TERMINATE(qb);
 
@@ -3186,6 +4288,7 @@ inner_process_tokens(QueryParse *qp, QueryBuild *qb)
 	BOOL		isnull;
 	BOOL		isbinary;
 	Oid			dummy;
+	size_t		npos;
 
 	if (stmt->ntab > 0)
 		bestitem = GET_NAME(stmt->ti[0]->bestitem);
@@ -3347,6 +4450,8 @@ inner_process_tokens(QueryParse *qp, QueryBuild *qb)
 		BOOL		converted = FALSE;
 		COL_INFO	*coli;
 
+		QB_no_template(qb);	/* depends on the last insert */
+
 #ifdef	NOT_USED  /* lastval() isn't always appropriate */
 		if (PG_VERSION_GE(conn, 8.1))
 		{
@@ -3530,7 +4635,10 @@ inner_process_tokens(QueryParse *qp, QueryBuild *qb)
 	/*
 	 * It's a '?' parameter alright
 	 */
+	npos = qb->npos;
 	retval = ResolveOneParam(qb, qp, &isnull, &isbinary, &dummy);
+	if (qb->tmpl)
+		QB_add_template_slot(qb, qp, npos, retval);
 	if (retval < 0)
 		return retval;
 
@@ -3676,6 +4784,315 @@ cleanup:
 	return ret;
 }
 
+/*
+ * Find the VALUES list of a single-row INSERT statement which has been
+ * converted for the server, e.g.
+ *
+ *	INSERT INTO t (a, b) VALUES ($1, $2)
+ *
+ * so that more rows can be added to it. All of the num_params parameter
+ * markers must be in the list and nothing but a semicolon may follow it.
+ * Anything the simple scanner below can't be sure about (comments,
+ * dollar quotes, backslashes) makes it give up.
+ *
+ * On success, the offset and length of the parenthesized list are
+ * returned in *pos and *len, if not NULL.
+ */
+BOOL
+find_insert_values_list(const char *query, int num_params, size_t *pos, size_t *len)
+{
+	const char *p, *lstart = NULL;
+	char		in_quote = '\0';
+	int			depth = 0, nparams = 0;
+
+	if (NULL == query || num_params <= 0)
+		return FALSE;
+	for (p = query; *p; p++)
+	{
+		if (in_quote)
+		{
+			if (*p == in_quote)
+				in_quote = '\0';
+			else if (*p == '\\')
+				return FALSE;
+			continue;
+		}
+		switch (*p)
+		{
+			case '\'':
+			case '"':
+				in_quote = *p;
+				continue;
+			case '\\':
+				return FALSE;
+			case '-':
+				if (p[1] == '-')
+					return FALSE;
+				continue;
+			case '/':
+				if (p[1] == '*')
+					return FALSE;
+				continue;
+			case '$':
+				if (!isdigit((UCHAR) p[1]) || !lstart)
+					return FALSE;
+				nparams++;
+				continue;
+			case '(':
+				depth++;
+				continue;
+			case ')':
+				if (--depth < 0)
+					return FALSE;
+				if (0 == depth && NULL != lstart)
+				{
+					const char *lend = p + 1;
+
+					/* only a single row list at the end is allowed */
+					for (p++; isspace((UCHAR) *p) || ';' == *p; p++)
+						;
+					if (*p || nparams != num_params)
+						return FALSE;
+					if (pos)
+						*pos = lstart - query;
+					if (len)
+						*len = lend - lstart;
+					return TRUE;
+				}
+				continue;
+		}
+		if (0 == depth && NULL == lstart &&
+			strnicmp(p, "values", 6) == 0 &&
+			p > query && !isalnum((UCHAR) p[-1]) && '_' != p[-1] &&
+			(isspace((UCHAR) p[6]) || '(' == p[6]))
+		{
+			for (p += 6; isspace((UCHAR) *p); p++)
+				;
+			if ('(' != *p)
+				return FALSE;
+			lstart = p;
+			depth++;
+		}
+	}
+
+	return FALSE;
+}
+
+/*
+ * Build a multi-row INSERT statement from a single-row one by repeating
+ * its VALUES list (found by find_insert_values_list()) nrows times. The
+ * parameter markers of the n-th list are renumbered to follow the ones
+ * of the preceding lists.
+ *
+ * The result is malloc'd.
+ */
+char *
+build_multirow_insert(const char *query, size_t pos, size_t len,
+					  int num_params, int nrows)
+{
+	char	   *newq, *np;
+	const char *p, *lend = query + pos + len;
+	size_t		alloc_len;
+	int			i, pnum;
+
+	/* the parameter numbers grow at most by log10(num_params * nrows) digits */
+	alloc_len = strlen(query) + (len + 2 + num_params * 10) * nrows;
+	if (NULL == (newq = malloc(alloc_len)))
+		return NULL;
+	memcpy(newq, query, pos);
+	np = newq + pos;
+	for (i = 0; i < nrows; i++)
+	{
+		if (i > 0)
+		{
+			*np++ = ',';
+			*np++ = ' ';
+		}
+		for (p = query + pos; p < lend; p++)
+		{
+			if ('\'' == *p || '"' == *p)
+			{
+				const char *q = strchr(p + 1, *p);
+
+				memcpy(np, p, q - p + 1);
+				np += q - p + 1;
+				p = q;
+			}
+			else if ('$' == *p)
+			{
+				pnum = atoi(p + 1);
+				np += sprintf(np, "$%d", pnum + i * num_params);
+				while (isdigit((UCHAR) p[1]))
+					p++;
+			}
+			else
+				*np++ = *p;
+		}
+	}
+	strcpy(np, lend);
+
+	return newq;
+}
+
+/*
+ * Build a "COPY ... FROM STDIN" statement equivalent to a single-row
+ * INSERT statement converted for the server, e.g.
+ *
+ *	INSERT INTO t (a, b) VALUES ($1, $2)	->	COPY t (a, b) FROM STDIN
+ *
+ * This is only possible if the column list is specified and the VALUES
+ * list consists of the parameter markers $1..$num_params in order.
+ *
+ * Returns a malloc'd string, or NULL if the statement can't be converted.
+ */
+char *
+build_copy_from_insert(const char *query, int num_params)
+{
+	const char *p, *tstart, *tend, *lend;
+	char	   *copyq;
+	char		in_quote = '\0';
+	size_t		lpos, llen, tlen;
+	int			pnum;
+
+	if (!find_insert_values_list(query, num_params, &lpos, &llen))
+		return NULL;
+
+	/* INSERT INTO */
+	for (p = query; isspace((UCHAR) *p); p++)
+		;
+	if (strnicmp(p, "insert", 6) != 0 || !isspace((UCHAR) p[6]))
+		return NULL;
+	for (p += 6; isspace((UCHAR) *p); p++)
+		;
+	if (strnicmp(p, "into", 4) != 0 || !isspace((UCHAR) p[4]))
+		return NULL;
+	for (p += 4; isspace((UCHAR) *p); p++)
+		;
+
+	/* the table name and the column list */
+	tstart = p;
+	for (; *p; p++)
+	{
+		if (in_quote)
+		{
+			if (*p == in_quote)
+				in_quote = '\0';
+		}
+		else if ('"' == *p)
+			in_quote = *p;
+		else if ('(' == *p || isspace((UCHAR) *p))
+			break;
+	}
+	for (; isspace((UCHAR) *p); p++)
+		;
+	if ('(' != *p)
+		return NULL;	/* no column list, or an alias */
+	for (; *p; p++)
+	{
+		if (in_quote)
+		{
+			if (*p == in_quote)
+				in_quote = '\0';
+		}
+		else if ('"' == *p)
+			in_quote = *p;
+		else if (')' == *p)
+			break;
+	}
+	if (')' != *p)
+		return NULL;
+	tend = p + 1;
+	for (p++; isspace((UCHAR) *p); p++)
+		;
+	if (strnicmp(p, "values", 6) != 0)
+		return NULL;
+
+	/* each value must be the parameter of its position */
+	p = query + lpos + 1;
+	lend = query + lpos + llen - 1;
+	for (pnum = 1; pnum <= num_params; pnum++)
+	{
+		for (; isspace((UCHAR) *p); p++)
+			;
+		if ('$' != *p || atoi(p + 1) != pnum)
+			return NULL;
+		for (p++; isdigit((UCHAR) *p); p++)
+			;
+		for (; isspace((UCHAR) *p); p++)
+			;
+		if (*p != (pnum < num_params ? ',' : ')') || p > lend)
+			return NULL;
+		p++;
+	}
+
+	tlen = tend - tstart;
+	if (NULL == (copyq = malloc(tlen + 32)))
+		return NULL;
+	memcpy(copyq, "COPY ", 5);
+	memcpy(copyq + 5, tstart, tlen);
+	strcpy(copyq + 5 + tlen, " FROM STDIN");
+
+	return copyq;
+}
+
+/*
+ * Append a parameter value built by build_libpq_bind_params() to a
+ * line of COPY text format data. 'buf' must have room for 4 * len + 4
+ * bytes. Binary values are bytea and are written in the hex format.
+ *
+ * Returns the number of bytes written.
+ */
+size_t
+copy_text_from_param(char *buf, const char *value, int len, int format)
+{
+	static const char hextbl[] = "0123456789abcdef";
+	char	   *bp = buf;
+	int			i;
+
+	if (NULL == value)
+	{
+		memcpy(bp, "\\N", 2);
+		return 2;
+	}
+	if (1 == format)
+	{
+		/* the backslash of \x needs to be escaped itself */
+		memcpy(bp, "\\\\x", 3);
+		bp += 3;
+		for (i = 0; i < len; i++)
+		{
+			*bp++ = hextbl[((UCHAR) value[i]) >> 4];
+			*bp++ = hextbl[((UCHAR) value[i]) & 0xf];
+		}
+		return bp - buf;
+	}
+	for (i = 0; i < len; i++)
+	{
+		switch (value[i])
+		{
+			case '\\':
+				*bp++ = '\\';
+				*bp++ = '\\';
+				break;
+			case '\n':
+				*bp++ = '\\';
+				*bp++ = 'n';
+				break;
+			case '\r':
+				*bp++ = '\\';
+				*bp++ = 'r';
+				break;
+			case '\t':
+				*bp++ = '\\';
+				*bp++ = 't';
+				break;
+			default:
+				*bp++ = value[i];
+		}
+	}
+	return bp - buf;
+}
+
 
 /*
  * With SQL_MAX_NUMERIC_LEN = 16, the highest representable number is
@@ -4029,7 +5446,7 @@ inolog("ipara=%p paramType=%d %d proc_return=%d\n", ipara, ipara ? ipara->paramT
 	if (apara->data_at_exec)
 	{
 		if (pdata->allocated != apdopts->allocated)
-			extend_putdata_info(pdata, apdopts->allocated, TRUE);
+			extend_putdata_info(pdata, apdopts->allocated, TRUE, conn);
 		used = pdata->pdata[param_number].EXEC_used ? *pdata->pdata[param_number].EXEC_used : SQL_NTS;
 		buffer = pdata->pdata[param_number].EXEC_buffer;
 		if (pdata->pdata[param_number].lobj_oid)
@@ -4119,11 +5536,52 @@ inolog("ipara=%p paramType=%d %d proc_return=%d\n", ipara, ipara ? ipara->paramT
 			CVT_APPEND_CHAR(qb, '?');
 			return SQL_SUCCESS;
 		}
+	}
 
-		/* shouldn't happen */
-		qb->errormsg = "unexpected NULL parameter value";
-		qb->errornumber = STMT_EXEC_ERROR;
-		return SQL_ERROR;
+	/*
+	 * The data at execution was written to a large object by SQLPutData().
+	 * A large object parameter is its oid. A bytea one is read from the
+	 * temporary large object by the server.
+	 */
+	if (handling_large_object)
+	{
+		const PutDataClass	*current_pdata = &pdata->pdata[param_number];
+
+		lobj_oid = current_pdata->lobj_oid;
+		if (!current_pdata->lobj_temporary)
+		{
+			sprintf(param_string, "%u", lobj_oid);
+			lastadd = "::lo";
+			buf = param_string;
+		}
+		else if (!req_bind)
+		{
+			sprintf(param_string, "pg_catalog.lo_get(%u)", lobj_oid);
+			need_quotes = FALSE;
+			buf = param_string;
+		}
+		else
+		{
+			/* the value of a bind parameter must be sent as it is */
+			QResultClass	*res = odbc_lo_get(conn, lobj_oid, 0, (Int4) used);
+			const char	*hex;
+
+			if (NULL == res ||
+				NULL == (hex = QR_get_value_backend_text(res, 0, 0)) ||
+				NULL == (allocbuf = malloc(strlen(hex) + 3)))
+			{
+				QR_Destructor(res);
+				qb->errormsg = "Couldn't read the large object of the parameter";
+				qb->errornumber = STMT_EXEC_ERROR;
+				retval = SQL_ERROR;
+				goto cleanup;
+			}
+			snprintf(allocbuf, strlen(hex) + 3, "\\x%s", hex);
+			QR_Destructor(res);
+			buf = allocbuf;
+		}
+		used = strlen(buf);
+		goto output;
 	}
 
 	/* replace DEFAULT with something we can use */
@@ -4724,6 +6182,7 @@ mylog("cvt_null_date_string=%d pgtype=%d buf=%p\n", conn->connInfo.cvt_null_date
 	if (used == SQL_NTS)
 		used = strlen(buf);
 
+output:
 	/*
 	 * Ok, we now have the final string representation in 'buf', length 'used'.
 	 * We're ready to output the final string, with quotes and other
@@ -4913,6 +6372,7 @@ convert_escape(QueryParse *qp, QueryBuild *qb)
 	/* '?=' to accept return values exists ? */
 	if (F_OldChar(qp) == '?')
 	{
+		QB_no_template(qb);
 		qb->param_number++;
 		qb->proc_return = 1;
 		if (qb->stmt)
@@ -4939,6 +6399,8 @@ convert_escape(QueryParse *qp, QueryBuild *qb)
 		size_t funclen;
 		const char *nextdel;
 
+		QB_no_template(qb);	/* depends on the output parameters */
+
 		if (SQL_ERROR == QB_start_brace(qb))
 		{
 			retval = SQL_ERROR;
@@ -5665,6 +7127,143 @@ pg_hex2bin(const char *src, char *dst, SQLLEN length)
 	return length;
 }
 
+/*
+ *	Decode 'count' bytes from the hex digits at 'src'. Unlike pg_hex2bin(),
+ *	no null is appended, so that a piece of a value can be decoded into
+ *	the application's buffer as it is.
+ */
+static void
+pg_hex2bin_piece(const char *src, char *dst, SQLLEN count)
+{
+	UCHAR		chr;
+	SQLLEN		i;
+	int		val, j;
+
+	for (i = 0; i < count; i++)
+	{
+		dst[i] = 0;
+		for (j = 0; j < 2; j++)
+		{
+			chr = *src++;
+			if (chr >= 'a' && chr <= 'f')
+				val = chr - 'a' + 10;
+			else if (chr >= 'A' && chr <= 'F')
+				val = chr - 'A' + 10;
+			else
+				val = chr - '0';
+			dst[i] = (dst[i] << 4) + val;
+		}
+	}
+}
+
+/*
+ *	Look up the size and the first 'wanted' bytes (in hex) of a large
+ *	object in the result of odbc_lo_get_heads().
+ */
+static BOOL
+find_lo_head(QResultClass *res, OID oid, Int4 wanted, SQLLEN *size, const char **hex)
+{
+	SQLLEN		i;
+	const char *value;
+	const char *bytes;
+
+	if (!res)
+		return FALSE;
+	for (i = 0; i < QR_get_num_cached_tuples(res); i++)
+	{
+		value = QR_get_value_backend_text(res, i, 0);
+		if (NULL == value || ATOI32U(value) != oid)
+			continue;
+		value = QR_get_value_backend_text(res, i, 1);
+		bytes = QR_get_value_backend_text(res, i, 2);
+		if (NULL == value || NULL == bytes)
+			continue;
+#ifdef ODBCINT64
+		*size = (SQLLEN) ATOI64(value);
+#else
+		*size = atol(value);
+#endif /* ODBCINT64 */
+		if ((SQLLEN) strlen(bytes) < 2 * (*size < wanted ? *size : wanted))
+			continue;
+		*hex = bytes;
+		return TRUE;
+	}
+	return FALSE;
+}
+
+/*
+ *	convert_lo() for 9.4 or later servers. The size and the first bytes
+ *	of the large object are read in one query, or taken from the ones
+ *	read for the whole rowset by SC_fetch_columnwise(), and the following
+ *	SQLGetData calls read the next bytes with lo_get(). The large object
+ *	isn't opened, so no transaction is needed either.
+ */
+static int
+convert_lo_get(StatementClass *stmt, OID oid, int factor, PTR rgbValue,
+			   SQLLEN cbValueMax, SQLLEN *pcbValue, GetDataClass *gdata)
+{
+	CSTR	func = "convert_lo_get";
+	ConnectionClass *conn = SC_get_conn(stmt);
+	QResultClass *res = NULL;
+	const char *hex = NULL;
+	SQLLEN		left, offset;
+	Int4		wanted, retval;
+
+	if (0 >= cbValueMax)
+		wanted = 0;
+	else
+		wanted = (Int4) (factor > 1 ? (cbValueMax - 1) / factor : cbValueMax);
+	if (!gdata || gdata->data_left == -1)
+	{
+		if (!find_lo_head(stmt->lobj_heads, oid, wanted, &left, &hex))
+		{
+			res = odbc_lo_get_heads(conn, &oid, &wanted, 1, 0);
+			if (!find_lo_head(res, oid, wanted, &left, &hex))
+			{
+				QR_Destructor(res);
+				SC_set_error(stmt, STMT_EXEC_ERROR, "Error reading from large object.", func);
+				return COPY_GENERAL_ERROR;
+			}
+		}
+		stmt->lobj_size = left;
+		offset = 0;
+	}
+	else if ((left = gdata->data_left) == 0)
+		return COPY_NO_DATA_FOUND;
+	else
+		offset = stmt->lobj_size - left;
+	mylog("lo data left = " FORMAT_LEN "\n", left);
+
+	if (!hex && wanted > 0 && left > 0)
+	{
+		res = odbc_lo_get(conn, oid, (Int4) offset, wanted);
+		if (!res || NULL == (hex = QR_get_value_backend_text(res, 0, 0)))
+		{
+			QR_Destructor(res);
+			SC_set_error(stmt, STMT_EXEC_ERROR, "Error reading from large object.", func);
+			return COPY_GENERAL_ERROR;
+		}
+	}
+	retval = 0;
+	if (hex)
+	{
+		retval = (Int4) (strlen(hex) / 2);
+		if (retval > wanted)
+			retval = wanted;
+		pg_hex2bin_piece(hex, (char *) rgbValue, retval);
+	}
+	QR_Destructor(res);
+	if (factor > 1 && cbValueMax > 0)
+		pg_bin2hex((char *) rgbValue, (char *) rgbValue, retval);
+
+	if (pcbValue)
+		*pcbValue = left * factor;
+	if (gdata)
+		gdata->data_left = left - retval;
+
+	return retval < left ? COPY_RESULT_TRUNCATED : COPY_OK;
+}
+
 /*-------
  *	1. get oid (from 'value')
  *	2. open the large object
@@ -5721,6 +7320,8 @@ convert_lo(StatementClass *stmt, const void *value, SQLSMALLINT fCType, PTR rgbV
 		gdata = &gdata_info->gdata[stmt->current_col];
 		left = gdata->data_left;
 	}
+	if (PG_VERSION_GE(conn, 9.4) && stmt->lobj_fd < 0)
+		return convert_lo_get(stmt, oid, factor, rgbValue, cbValueMax, pcbValue, gdata);
 
 	/*
 	 * if this is the first call for this column, open the large object
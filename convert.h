@@ -22,14 +22,22 @@ extern "C" {
 #define COPY_GENERAL_ERROR						4
 #define COPY_NO_DATA_FOUND						5
 
-int	copy_and_convert_field_bindinfo(StatementClass *stmt, OID field_type, int atttypmod, void *value, int col);
+int	copy_and_convert_field_bindinfo(StatementClass *stmt, OID field_type, int atttypmod, void *value, int col, BOOL binary);
+int	copy_and_convert_column(StatementClass *stmt, OID field_type, int atttypmod, const TupleField *tuples, int num_fields, SQLLEN nrows, int col, BOOL binary, SQLLEN *failed_row);
 int	copy_and_convert_field(StatementClass *stmt,
 			OID field_type, int atttypmod,
 			void *value,
 			SQLSMALLINT fCType, int precision,
 			PTR rgbValue, SQLLEN cbValueMax, SQLLEN *pcbValue, SQLLEN *pIndicator);
+int	copy_and_convert_binary_field(StatementClass *stmt,
+			OID field_type, int atttypmod,
+			void *value,
+			SQLSMALLINT fCType, int precision,
+			PTR rgbValue, SQLLEN cbValueMax, SQLLEN *pcbValue, SQLLEN *pIndicator);
+BOOL	binary_result_supported(OID type);
 
 int		copy_statement_with_parameters(StatementClass *stmt, BOOL);
+void		clear_sql_templates(ConnectionClass *conn);
 SQLLEN		pg_hex2bin(const char *in, char *out, SQLLEN len);
 size_t		findTag(const char *str, int ccsc);
 
@@ -39,6 +47,10 @@ BOOL build_libpq_bind_params(StatementClass *stmt,
 						int **paramLengths,
 						int **paramFormats,
 						int *resultFormat);
+BOOL		find_insert_values_list(const char *query, int num_params, size_t *pos, size_t *len);
+char	   *build_multirow_insert(const char *query, size_t pos, size_t len, int num_params, int nrows);
+char	   *build_copy_from_insert(const char *query, int num_params);
+size_t		copy_text_from_param(char *buf, const char *value, int len, int format);
 #ifdef	__cplusplus
 }
 #endif
@@ -32,7 +32,7 @@ static void encode(const pgNAME, char *out, int outlen);
 static pgNAME decode(const char *in);
 static pgNAME decode_or_remove_braces(const char *in);
 
-#define	OVR_EXTRA_BITS (BIT_FORCEABBREVCONNSTR | BIT_FAKE_MSS | BIT_BDE_ENVIRONMENT | BIT_CVT_NULL_DATE | BIT_ACCESSIBLE_ONLY | BIT_IGNORE_ROUND_TRIP_TIME | BIT_DISABLE_KEEPALIVE)
+#define	OVR_EXTRA_BITS (BIT_FORCEABBREVCONNSTR | BIT_FAKE_MSS | BIT_BDE_ENVIRONMENT | BIT_CVT_NULL_DATE | BIT_ACCESSIBLE_ONLY | BIT_IGNORE_ROUND_TRIP_TIME | BIT_DISABLE_KEEPALIVE | BIT_PIPELINE_PARAM_ARRAY | BIT_COPY_PARAM_ARRAY | BIT_BINARY_RESULT | BIT_STREAM_RESULTS | BIT_FETCH_AHEAD | BIT_SHARED_COLINFO | BIT_CATALOG_NOTIFY | BIT_CONNECTION_POOL)
 UInt4	getExtraOptions(const ConnInfo *ci)
 {
 	UInt4	flag = ci->extra_opts & (~OVR_EXTRA_BITS);
@@ -65,6 +65,38 @@ UInt4	getExtraOptions(const ConnInfo *ci)
 		flag |= BIT_DISABLE_KEEPALIVE;
 	else if (ci->disable_keepalive == 0)
 		flag &= (~BIT_DISABLE_KEEPALIVE);
+	if (ci->pipeline_param_array > 0)
+		flag |= BIT_PIPELINE_PARAM_ARRAY;
+	else if (ci->pipeline_param_array == 0)
+		flag &= (~BIT_PIPELINE_PARAM_ARRAY);
+	if (ci->copy_param_array > 0)
+		flag |= BIT_COPY_PARAM_ARRAY;
+	else if (ci->copy_param_array == 0)
+		flag &= (~BIT_COPY_PARAM_ARRAY);
+	if (ci->binary_result > 0)
+		flag |= BIT_BINARY_RESULT;
+	else if (ci->binary_result == 0)
+		flag &= (~BIT_BINARY_RESULT);
+	if (ci->stream_results > 0)
+		flag |= BIT_STREAM_RESULTS;
+	else if (ci->stream_results == 0)
+		flag &= (~BIT_STREAM_RESULTS);
+	if (ci->fetch_ahead > 0)
+		flag |= BIT_FETCH_AHEAD;
+	else if (ci->fetch_ahead == 0)
+		flag &= (~BIT_FETCH_AHEAD);
+	if (ci->shared_colinfo > 0)
+		flag |= BIT_SHARED_COLINFO;
+	else if (ci->shared_colinfo == 0)
+		flag &= (~BIT_SHARED_COLINFO);
+	if (ci->catalog_notify > 0)
+		flag |= BIT_CATALOG_NOTIFY;
+	else if (ci->catalog_notify == 0)
+		flag &= (~BIT_CATALOG_NOTIFY);
+	if (ci->connection_pool > 0)
+		flag |= BIT_CONNECTION_POOL;
+	else if (ci->connection_pool == 0)
+		flag &= (~BIT_CONNECTION_POOL);
 
 	return flag;
 }
@@ -92,6 +124,22 @@ static UInt4	replaceExtraOptions(ConnInfo *ci, UInt4 flag, BOOL overwrite)
 		ci->ignore_round_trip_time = (0 != (flag & BIT_IGNORE_ROUND_TRIP_TIME));
 	if (overwrite || ci->disable_keepalive < 0)
 		ci->disable_keepalive = (0 != (flag & BIT_DISABLE_KEEPALIVE));
+	if (overwrite || ci->pipeline_param_array < 0)
+		ci->pipeline_param_array = (0 != (flag & BIT_PIPELINE_PARAM_ARRAY));
+	if (overwrite || ci->copy_param_array < 0)
+		ci->copy_param_array = (0 != (flag & BIT_COPY_PARAM_ARRAY));
+	if (overwrite || ci->binary_result < 0)
+		ci->binary_result = (0 != (flag & BIT_BINARY_RESULT));
+	if (overwrite || ci->stream_results < 0)
+		ci->stream_results = (0 != (flag & BIT_STREAM_RESULTS));
+	if (overwrite || ci->fetch_ahead < 0)
+		ci->fetch_ahead = (0 != (flag & BIT_FETCH_AHEAD));
+	if (overwrite || ci->shared_colinfo < 0)
+		ci->shared_colinfo = (0 != (flag & BIT_SHARED_COLINFO));
+	if (overwrite || ci->catalog_notify < 0)
+		ci->catalog_notify = (0 != (flag & BIT_CATALOG_NOTIFY));
+	if (overwrite || ci->connection_pool < 0)
+		ci->connection_pool = (0 != (flag & BIT_CONNECTION_POOL));
 
 	return (ci->extra_opts = getExtraOptions(ci));
 }
@@ -145,6 +193,22 @@ UInt4	add_removeExtraOptions(ConnInfo *ci, UInt4 aflag, UInt4 dflag)
 		ci->ignore_round_trip_time = TRUE;
 	if (0 != (aflag & BIT_DISABLE_KEEPALIVE))
 		ci->disable_keepalive = TRUE;
+	if (0 != (aflag & BIT_PIPELINE_PARAM_ARRAY))
+		ci->pipeline_param_array = TRUE;
+	if (0 != (aflag & BIT_COPY_PARAM_ARRAY))
+		ci->copy_param_array = TRUE;
+	if (0 != (aflag & BIT_BINARY_RESULT))
+		ci->binary_result = TRUE;
+	if (0 != (aflag & BIT_STREAM_RESULTS))
+		ci->stream_results = TRUE;
+	if (0 != (aflag & BIT_FETCH_AHEAD))
+		ci->fetch_ahead = TRUE;
+	if (0 != (aflag & BIT_SHARED_COLINFO))
+		ci->shared_colinfo = TRUE;
+	if (0 != (aflag & BIT_CATALOG_NOTIFY))
+		ci->catalog_notify = TRUE;
+	if (0 != (aflag & BIT_CONNECTION_POOL))
+		ci->connection_pool = TRUE;
 	if (0 != (dflag & BIT_FORCEABBREVCONNSTR))
 		ci->force_abbrev_connstr = FALSE;
 	if (0 != (dflag & BIT_FAKE_MSS))
@@ -157,6 +221,22 @@ UInt4	add_removeExtraOptions(ConnInfo *ci, UInt4 aflag, UInt4 dflag)
 		ci->ignore_round_trip_time = FALSE;
 	if (0 != (dflag & BIT_DISABLE_KEEPALIVE))
 		ci->disable_keepalive = FALSE;
+	if (0 != (dflag & BIT_PIPELINE_PARAM_ARRAY))
+		ci->pipeline_param_array = FALSE;
+	if (0 != (dflag & BIT_COPY_PARAM_ARRAY))
+		ci->copy_param_array = FALSE;
+	if (0 != (dflag & BIT_BINARY_RESULT))
+		ci->binary_result = FALSE;
+	if (0 != (dflag & BIT_STREAM_RESULTS))
+		ci->stream_results = FALSE;
+	if (0 != (dflag & BIT_FETCH_AHEAD))
+		ci->fetch_ahead = FALSE;
+	if (0 != (dflag & BIT_SHARED_COLINFO))
+		ci->shared_colinfo = FALSE;
+	if (0 != (dflag & BIT_CATALOG_NOTIFY))
+		ci->catalog_notify = FALSE;
+	if (0 != (dflag & BIT_CONNECTION_POOL))
+		ci->connection_pool = FALSE;
 
 	return (ci->extra_opts = getExtraOptions(ci));
 }
@@ -220,6 +300,46 @@ makeKeepaliveConnectString(char *target, const ConnInfo *ci, BOOL abbrev)
 	return target;
 }
 
+static char *
+makeInsertBatchConnectString(char *target, const ConnInfo *ci, BOOL abbrev)
+{
+	char	*buf = target;
+	*buf = '\0';
+
+	if (ci->insert_batch_rows > 0)
+	{
+		if (abbrev)
+			sprintf(buf, ABBR_INSERTBATCHROWS "=%u;", ci->insert_batch_rows);
+		else
+			sprintf(buf, INI_INSERTBATCHROWS "=%u;", ci->insert_batch_rows);
+		buf = strchr(buf, (int) '\0');
+	}
+	if (ci->insert_batch_bytes > 0)
+	{
+		if (abbrev)
+			sprintf(buf, ABBR_INSERTBATCHBYTES "=%u;", ci->insert_batch_bytes);
+		else
+			sprintf(buf, INI_INSERTBATCHBYTES "=%u;", ci->insert_batch_bytes);
+		buf = strchr(buf, (int) '\0');
+	}
+	if (ci->fetch_cache_bytes > 0)
+	{
+		if (abbrev)
+			sprintf(buf, ABBR_FETCHCACHEBYTES "=%u;", ci->fetch_cache_bytes);
+		else
+			sprintf(buf, INI_FETCHCACHEBYTES "=%u;", ci->fetch_cache_bytes);
+		buf = strchr(buf, (int) '\0');
+	}
+	if (ci->prepared_cache_size > 0)
+	{
+		if (abbrev)
+			sprintf(buf, ABBR_PREPAREDCACHESIZE "=%u;", ci->prepared_cache_size);
+		else
+			sprintf(buf, INI_PREPAREDCACHESIZE "=%u;", ci->prepared_cache_size);
+	}
+	return target;
+}
+
 #ifdef	_HANDLE_ENLIST_IN_DTC_
 char *
 makeXaOptConnectString(char *target, const ConnInfo *ci, BOOL abbrev)
@@ -247,6 +367,7 @@ makeConnectString(char *connect_string, const ConnInfo *ci, UWORD len)
 	char		got_dsn = (ci->dsn[0] != '\0');
 	char		encoded_item[LARGE_REGISTRY_LEN];
 	char		keepaliveStr[64];
+	char		insertBatchStr[64];
 #ifdef	_HANDLE_ENLIST_IN_DTC_
 	char		xaOptStr[16];
 #endif
@@ -316,6 +437,7 @@ inolog("hlen=%d", hlen);
 			INI_USESERVERSIDEPREPARE "=%d;"
 			INI_LOWERCASEIDENTIFIER "=%d;"
 			"%s"
+			"%s"
 #ifdef	WIN32
 			INI_GSSAUTHUSEGSSAPI "=%d;"
 #endif /* WIN32 */
@@ -350,6 +472,7 @@ inolog("hlen=%d", hlen);
 			,ci->use_server_side_prepare
 			,ci->lower_case_identifier
 			,makeKeepaliveConnectString(keepaliveStr, ci, FALSE)
+			,makeInsertBatchConnectString(insertBatchStr, ci, FALSE)
 #ifdef	WIN32
 			,ci->gssauth_use_gssapi
 #endif /* WIN32 */
@@ -429,6 +552,7 @@ inolog("hlen=%d", hlen);
 				INI_INT8AS "=%d;"
 				ABBR_EXTRASYSTABLEPREFIXES "=%s;"
 				"%s"
+				"%s"
 #ifdef	_HANDLE_ENLIST_IN_DTC_
 				"%s"
 #endif /* _HANDLE_ENLIST_IN_DTC_ */
@@ -440,6 +564,7 @@ inolog("hlen=%d", hlen);
 				ci->int8_as,
 				ci->drivers.extra_systable_prefixes,
 				makeKeepaliveConnectString(keepaliveStr, ci, TRUE),
+				makeInsertBatchConnectString(insertBatchStr, ci, TRUE),
 #ifdef	_HANDLE_ENLIST_IN_DTC_
 				makeXaOptConnectString(xaOptStr, ci, TRUE),
 #endif /* _HANDLE_ENLIST_IN_DTC_ */
@@ -628,6 +753,14 @@ copyAttributes(ConnInfo *ci, const char *attribute, const char *value)
 		ci->keepalive_idle = atoi(value);
 	else if (stricmp(attribute, INI_KEEPALIVEINTERVAL) == 0 || stricmp(attribute, ABBR_KEEPALIVEINTERVAL) == 0)
 		ci->keepalive_interval = atoi(value);
+	else if (stricmp(attribute, INI_INSERTBATCHROWS) == 0 || stricmp(attribute, ABBR_INSERTBATCHROWS) == 0)
+		ci->insert_batch_rows = atoi(value);
+	else if (stricmp(attribute, INI_INSERTBATCHBYTES) == 0 || stricmp(attribute, ABBR_INSERTBATCHBYTES) == 0)
+		ci->insert_batch_bytes = atoi(value);
+	else if (stricmp(attribute, INI_FETCHCACHEBYTES) == 0 || stricmp(attribute, ABBR_FETCHCACHEBYTES) == 0)
+		ci->fetch_cache_bytes = atoi(value);
+	else if (stricmp(attribute, INI_PREPAREDCACHESIZE) == 0 || stricmp(attribute, ABBR_PREPAREDCACHESIZE) == 0)
+		ci->prepared_cache_size = atoi(value);
 	else if (stricmp(attribute, INI_SSLMODE) == 0 || stricmp(attribute, ABBR_SSLMODE) == 0)
 	{
 		switch (value[0])
@@ -804,6 +937,22 @@ getDSNdefaults(ConnInfo *ci)
 		ci->ignore_round_trip_time = 0;
 	if (ci->disable_keepalive < 0)
 		ci->disable_keepalive = 0;
+	if (ci->pipeline_param_array < 0)
+		ci->pipeline_param_array = 0;
+	if (ci->copy_param_array < 0)
+		ci->copy_param_array = 0;
+	if (ci->binary_result < 0)
+		ci->binary_result = 0;
+	if (ci->stream_results < 0)
+		ci->stream_results = 0;
+	if (ci->fetch_ahead < 0)
+		ci->fetch_ahead = 0;
+	if (ci->shared_colinfo < 0)
+		ci->shared_colinfo = 0;
+	if (ci->catalog_notify < 0)
+		ci->catalog_notify = 0;
+	if (ci->connection_pool < 0)
+		ci->connection_pool = 0;
 #ifdef	_HANDLE_ENLIST_IN_DTC_
 	if (ci->xa_opt < 0)
 		ci->xa_opt = DEFAULT_XAOPT;
@@ -996,6 +1145,34 @@ getDSNinfo(ConnInfo *ci, char overwrite)
 			if (0 == (ci->keepalive_interval = atoi(temp)))
 				ci->keepalive_interval = -1;
 	}
+	if (ci->insert_batch_rows < 0 || overwrite)
+	{
+		SQLGetPrivateProfileString(DSN, INI_INSERTBATCHROWS, "", temp, sizeof(temp), ODBC_INI);
+		if (temp[0])
+			if (0 == (ci->insert_batch_rows = atoi(temp)))
+				ci->insert_batch_rows = -1;
+	}
+	if (ci->insert_batch_bytes < 0 || overwrite)
+	{
+		SQLGetPrivateProfileString(DSN, INI_INSERTBATCHBYTES, "", temp, sizeof(temp), ODBC_INI);
+		if (temp[0])
+			if (0 == (ci->insert_batch_bytes = atoi(temp)))
+				ci->insert_batch_bytes = -1;
+	}
+	if (ci->fetch_cache_bytes < 0 || overwrite)
+	{
+		SQLGetPrivateProfileString(DSN, INI_FETCHCACHEBYTES, "", temp, sizeof(temp), ODBC_INI);
+		if (temp[0])
+			if (0 == (ci->fetch_cache_bytes = atoi(temp)))
+				ci->fetch_cache_bytes = -1;
+	}
+	if (ci->prepared_cache_size < 0 || overwrite)
+	{
+		SQLGetPrivateProfileString(DSN, INI_PREPAREDCACHESIZE, "", temp, sizeof(temp), ODBC_INI);
+		if (temp[0])
+			if (0 == (ci->prepared_cache_size = atoi(temp)))
+				ci->prepared_cache_size = -1;
+	}
 
 	if (ci->sslmode[0] == '\0' || overwrite)
 		SQLGetPrivateProfileString(DSN, INI_SSLMODE, "", ci->sslmode, sizeof(ci->sslmode), ODBC_INI);
@@ -1280,6 +1457,26 @@ writeDSNinfo(const ConnInfo *ci)
 								 INI_KEEPALIVEINTERVAL,
 								 temp,
 								 ODBC_INI);
+	sprintf(temp, "%d", ci->insert_batch_rows);
+	SQLWritePrivateProfileString(DSN,
+								 INI_INSERTBATCHROWS,
+								 temp,
+								 ODBC_INI);
+	sprintf(temp, "%d", ci->insert_batch_bytes);
+	SQLWritePrivateProfileString(DSN,
+								 INI_INSERTBATCHBYTES,
+								 temp,
+								 ODBC_INI);
+	sprintf(temp, "%d", ci->fetch_cache_bytes);
+	SQLWritePrivateProfileString(DSN,
+								 INI_FETCHCACHEBYTES,
+								 temp,
+								 ODBC_INI);
+	sprintf(temp, "%d", ci->prepared_cache_size);
+	SQLWritePrivateProfileString(DSN,
+								 INI_PREPAREDCACHESIZE,
+								 temp,
+								 ODBC_INI);
 #ifdef	_HANDLE_ENLIST_IN_DTC_
 	sprintf(temp, "%d", ci->xa_opt);
 	SQLWritePrivateProfileString(DSN, INI_XAOPT, temp, ODBC_INI);
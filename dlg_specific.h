@@ -172,6 +172,14 @@ extern "C" {
 #define ABBR_PREFERLIBPQ		"D3"
 */
 #define ABBR_XAOPT			"D4"
+#define INI_INSERTBATCHROWS		"InsertBatchRows"
+#define ABBR_INSERTBATCHROWS		"D5"
+#define INI_INSERTBATCHBYTES		"InsertBatchBytes"
+#define ABBR_INSERTBATCHBYTES		"D6"
+#define INI_FETCHCACHEBYTES		"FetchCacheBytes"
+#define ABBR_FETCHCACHEBYTES		"D7"
+#define INI_PREPAREDCACHESIZE		"PreparedCacheSize"
+#define ABBR_PREPAREDCACHESIZE		"D8"
 
 #define	SSLMODE_DISABLE		"disable"
 #define	SSLMODE_ALLOW		"allow"
@@ -224,6 +232,14 @@ extern "C" {
 #define	BIT_ACCESSIBLE_ONLY			(1L << 4)
 #define	BIT_IGNORE_ROUND_TRIP_TIME		(1L << 5)
 #define	BIT_DISABLE_KEEPALIVE			(1L << 6)
+#define	BIT_PIPELINE_PARAM_ARRAY		(1L << 7)
+#define	BIT_COPY_PARAM_ARRAY			(1L << 8)
+#define	BIT_BINARY_RESULT			(1L << 9)
+#define	BIT_STREAM_RESULTS			(1L << 10)
+#define	BIT_FETCH_AHEAD				(1L << 11)
+#define	BIT_SHARED_COLINFO			(1L << 12)
+#define	BIT_CATALOG_NOTIFY			(1L << 13)
+#define	BIT_CONNECTION_POOL			(1L << 14)
 
 /*	Connection Defaults */
 #define DEFAULT_READONLY			0
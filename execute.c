@@ -32,6 +32,7 @@
 #include "pgtypes.h"
 #include "lobj.h"
 #include "pgapifunc.h"
+#include "dlg_specific.h"
 
 /*extern GLOBAL_VALUES globals;*/
 
@@ -152,6 +153,10 @@ PGAPI_ExecDirect(HSTMT hstmt,
 
 	mylog("%s: entering...%x\n", func, flag);
 
+	/* the query was sent by the previous call */
+	if (SC_is_async_running(stmt))
+		return PGAPI_Execute(hstmt, SC_is_with_hold(stmt) ? PODBC_WITH_HOLD : 0);
+
 	if (result = SC_initialize_and_recycle(stmt), SQL_SUCCESS != result)
 		return result;
 
@@ -423,6 +428,9 @@ RETCODE	Exec_with_parameters_resolved(StatementClass *stmt, BOOL *exec_end)
 	/* save the cursor's info before the execution */
 	cursor_type = stmt->options.cursor_type;
 	scroll_concurrency = stmt->options.scroll_concurrency;
+	/* the query was sent by the previous call */
+	if (SC_is_async_running(stmt))
+		goto execute;
 	/* Prepare the statement if possible at backend side */
 	if (HowToPrepareBeforeExec(stmt, FALSE) >= allowParse)
 		prepare_before_exec = TRUE;
@@ -443,8 +451,11 @@ inolog("prepare_before_exec=%d srv=%d\n", prepare_before_exec, conn->connInfo.us
 	/*
 	 *	The real execution.
 	 */
+execute:
 mylog("about to begin SC_execute\n");
 	retval = SC_execute(stmt);
+	if (retval == SQL_STILL_EXECUTING)
+		RETURN(retval)
 	if (retval == SQL_ERROR)
 	{
 		stmt->exec_current_row = -1;
@@ -664,6 +675,7 @@ CC_is_in_trans(conn), SC_is_rb_stmt(stmt), SC_is_tc_stmt(stmt));
 	switch (ret)
 	{
 		case SQL_NEED_DATA:
+		case SQL_STILL_EXECUTING:
 			break;
 		case SQL_ERROR:
 			start_stmt = TRUE;
@@ -702,7 +714,7 @@ CC_is_in_trans(conn), SC_is_rb_stmt(stmt), SC_is_tc_stmt(stmt));
 	else if (errorOnly)
 		return ret;
 inolog("ret=%d\n", ret);
-	if (SQL_NEED_DATA != ret && SC_started_rbpoint(stmt))
+	if (SQL_NEED_DATA != ret && SQL_STILL_EXECUTING != ret && SC_started_rbpoint(stmt))
 	{
 		snprintf(cmd, sizeof(cmd), "RELEASE %s", esavepoint);
 		res = CC_send_query(conn, cmd, NULL, IGNORE_ABORT_ON_CONN, NULL);
@@ -806,6 +818,76 @@ SC_setInsertedTable(StatementClass *stmt, RETCODE retval)
 	}
 }
 
+/*
+ *	Could the remaining rows of a parameter array be sent to the
+ *	server without waiting for the result of each row ?
+ */
+static BOOL
+param_rows_sendable_at_once(const StatementClass *stmt, SQLLEN end_row, SQLSMALLINT num_params)
+{
+	const ConnectionClass	*conn = SC_get_conn(stmt);
+	const APDFields	*apdopts = SC_get_APDF(stmt);
+	SQLULEN	offset = apdopts->param_offset_ptr ? *apdopts->param_offset_ptr : 0;
+	SQLINTEGER	bind_size = apdopts->param_bind_type;
+	Int4	num_p = num_params < apdopts->allocated ? num_params : apdopts->allocated;
+	SQLLEN	row;
+	int	i;
+
+	if (stmt->internal ||
+	    NULL != stmt->stmt_with_params ||
+	    SC_is_fetchcursor(stmt))
+		return FALSE;
+	switch (stmt->statement_type)
+	{
+		case STMT_TYPE_INSERT:
+		case STMT_TYPE_UPDATE:
+		case STMT_TYPE_DELETE:
+			break;
+		default:
+			return FALSE;
+	}
+	if (NULL != stmt->processed_statements &&
+	    NULL != stmt->processed_statements->next)
+		return FALSE;
+	switch (stmt->prepared)
+	{
+		case PREPARED_PERMANENTLY:
+			break;
+		case PREPARED_TEMPORARILY:
+			if (conn->unnamed_prepared_stmt == stmt)
+				break;
+			/* fall through */
+		case PREPARING_TEMPORARILY:
+			if (NULL == stmt->processed_statements)
+				return FALSE;
+			break;
+		default:
+			return FALSE;
+	}
+	/* data-at-execution parameters need a round trip per row */
+	for (row = stmt->exec_current_row; row <= end_row; row++)
+	{
+		if (apdopts->param_operation_ptr &&
+		    apdopts->param_operation_ptr[row] == SQL_PARAM_IGNORE)
+			continue;
+		for (i = 0; i < num_p; i++)
+		{
+			SQLLEN	   *pcVal = apdopts->parameters[i].used;
+
+			if (!pcVal)
+				continue;
+			if (bind_size > 0)
+				pcVal = LENADDR_SHIFT(pcVal, offset + bind_size * row);
+			else
+				pcVal = LENADDR_SHIFT(pcVal, offset) + row;
+			if (*pcVal == SQL_DATA_AT_EXEC || *pcVal <= SQL_LEN_DATA_AT_EXEC_OFFSET)
+				return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
 /*	Execute a prepared SQL statement */
 RETCODE		SQL_API
 PGAPI_Execute(HSTMT hstmt, UWORD flag)
@@ -817,13 +899,14 @@ PGAPI_Execute(HSTMT hstmt, UWORD flag)
 	APDFields	*apdopts;
 	IPDFields	*ipdopts;
 	SQLLEN		i, start_row, end_row;
-	BOOL	exec_end, recycled = FALSE, recycle = TRUE;
+	BOOL	exec_end, recycled = FALSE, recycle = TRUE, resume;
 	SQLSMALLINT	num_params;
 
 	mylog("%s: entering...%x\n", func, flag);
 
 	conn = SC_get_conn(stmt);
 	apdopts = SC_get_APDF(stmt);
+	resume = SC_is_async_running(stmt);
 
 	/*
 	 * If the statement was previously described, just recycle the old result
@@ -847,7 +930,15 @@ PGAPI_Execute(HSTMT hstmt, UWORD flag)
 
 #define	return	DONT_CALL_RETURN_FROM_HERE???
 
-	if (stmt->exec_current_row > 0)
+	if (resume)
+	{
+		/*
+		 * The query was sent by the previous call which returned
+		 * SQL_STILL_EXECUTING. Look for the result again.
+		 */
+		recycle = FALSE;
+	}
+	else if (stmt->exec_current_row > 0)
 	{
 		/*
 		 * executing an array of parameters.
@@ -898,6 +989,8 @@ PGAPI_Execute(HSTMT hstmt, UWORD flag)
 	num_params = stmt->num_params;
 	if (num_params < 0)
 		PGAPI_NumParams(stmt, &num_params);
+	if (resume)
+		goto exec_resolved;
 	if (stmt->exec_current_row == start_row)
 	{
 		/*
@@ -1020,12 +1113,51 @@ next_param_row:
 		}
 	}
 
+exec_resolved:
 	if (0 != (flag & PODBC_WITH_HOLD))
 		SC_set_with_hold(stmt);
 	retval = Exec_with_parameters_resolved(stmt, &exec_end);
+	if (SQL_STILL_EXECUTING == retval)
+		goto cleanup;
 	if (!exec_end)
 	{
 		stmt->curr_param_result = 0;
+		if (param_rows_sendable_at_once(stmt, end_row, num_params))
+		{
+			const ConnInfo	*ci = &(conn->connInfo);
+			const ProcessedStmt	*pstmt = stmt->processed_statements;
+			char	*copy_query;
+			RETCODE	ret;
+
+			if (STMT_TYPE_INSERT == stmt->statement_type &&
+			    0 != (ci->extra_opts & BIT_COPY_PARAM_ARRAY) &&
+			    NULL != pstmt &&
+			    NULL != (copy_query = build_copy_from_insert(pstmt->query, pstmt->num_params)))
+			{
+				ret = SC_execute_copy_in(stmt, copy_query, end_row);
+				free(copy_query);
+				if (SQL_SUCCESS != ret)
+					retval = ret;
+				goto cleanup;
+			}
+			if (STMT_TYPE_INSERT == stmt->statement_type &&
+			    ci->insert_batch_rows > 1 &&
+			    NULL != pstmt &&
+			    find_insert_values_list(pstmt->query, pstmt->num_params, NULL, NULL))
+			{
+				if (ret = SC_execute_multirow_insert(stmt, end_row), SQL_SUCCESS != ret)
+					retval = ret;
+				goto cleanup;
+			}
+#ifdef	LIBPQ_HAS_PIPELINING
+			if (0 != (ci->extra_opts & BIT_PIPELINE_PARAM_ARRAY))
+			{
+				if (ret = SC_execute_pipelined(stmt, end_row), SQL_SUCCESS != ret)
+					retval = ret;
+				goto cleanup;
+			}
+#endif /* LIBPQ_HAS_PIPELINING */
+		}
 		goto next_param_row;
 	}
 cleanup:
@@ -1132,8 +1264,9 @@ PGAPI_Cancel(HSTMT hstmt)		/* Statement to cancel. */
 	 * 1. In the middle of SQLParamData / SQLPutData
 	 *    -> cancel the statement
 	 *
-	 * 2. Running a query asynchronously. (asynchronous mode is not supported
-	 *    by psqlODBC)
+	 * 2. Running a query asynchronously (SQL_ATTR_ASYNC_ENABLE).
+	 *    -> Send a query cancel request to the server. The application
+	 *       gets the error by calling the function again.
 	 *
 	 * 3. Busy running a function in another thread.
 	 *    -> Send a query cancel request to the server
@@ -1162,6 +1295,7 @@ PGAPI_Cancel(HSTMT hstmt)		/* Statement to cancel. */
 		estmt->data_at_exec = -1;
 		estmt->current_exec_param = -1;
 		estmt->put_data = FALSE;
+		SC_unlink_putdata_lo(estmt);
 		cancelNeedDataState(estmt);
 		if (stmt->internal)
 			ret = DiscardStatementSvp(stmt, ret, FALSE);
@@ -1171,8 +1305,8 @@ PGAPI_Cancel(HSTMT hstmt)		/* Statement to cancel. */
 	else if (estmt->status == STMT_EXECUTING)
 	{
 		/*
-		 * Busy executing in a different thread. Send a cancel request to
-		 * the server.
+		 * Busy executing in a different thread, or the query is running
+		 * asynchronously. Send a cancel request to the server.
 		 */
 		if (!CC_send_cancel_request(conn))
 			return SQL_ERROR;
@@ -1242,6 +1376,81 @@ PGAPI_NativeSql(HDBC hdbc,
 }
 
 
+/*
+ * bytea data at execution larger than this is written to a temporary
+ * large object as SQLPutData() receives it, instead of being accumulated
+ * in memory, if the parameters are embedded in the query.
+ */
+#define	PUTDATA_BYTEA_BUFFER_SIZE	(1024 * 1024)
+
+/*
+ * Create the large object which receives the data at execution of the
+ * current parameter, and open it for writing.
+ */
+static BOOL
+open_putdata_lo(StatementClass *stmt, StatementClass *estmt, PutDataClass *current_pdata)
+{
+	CSTR func = "PGAPI_PutData";
+	ConnectionClass *conn = SC_get_conn(estmt);
+
+	/* begin transaction if needed */
+	if (!CC_is_in_trans(conn))
+	{
+		if (!CC_begin(conn))
+		{
+			SC_set_error(stmt, STMT_EXEC_ERROR, "Could not begin (in-line) a transaction", func);
+			return FALSE;
+		}
+	}
+
+	/* store the oid */
+	current_pdata->lobj_oid = odbc_lo_creat(conn, INV_READ | INV_WRITE);
+	if (current_pdata->lobj_oid == 0)
+	{
+		SC_set_error(stmt, STMT_EXEC_ERROR, "Couldnt create large object.", func);
+		return FALSE;
+	}
+
+	/* store the fd */
+	estmt->lobj_fd = odbc_lo_open(conn, current_pdata->lobj_oid, INV_WRITE);
+	if (estmt->lobj_fd < 0)
+	{
+		SC_set_error(stmt, STMT_EXEC_ERROR, "Couldnt open large object for writing.", func);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/*
+ * Remove the temporary large objects of the bytea data at execution,
+ * once the statement has been executed, or when the data is discarded.
+ * In an aborted transaction they are kept and removed the next time.
+ */
+void
+SC_unlink_putdata_lo(StatementClass *estmt)
+{
+	ConnectionClass *conn = SC_get_conn(estmt);
+	PutDataInfo	*pdata = SC_get_PDTI(estmt);
+	int		i;
+
+	if (NULL == conn)
+		return;
+	for (i = 0; i < pdata->allocated; i++)
+	{
+		if (!pdata->pdata[i].lobj_temporary)
+			continue;
+		if (!odbc_lo_unlink_if_exists(conn, pdata->pdata[i].lobj_oid))
+		{
+			mylog("%s: couldn't unlink large object %u\n", __FUNCTION__, pdata->pdata[i].lobj_oid);
+			continue;
+		}
+		pdata->pdata[i].lobj_oid = 0;
+		pdata->pdata[i].lobj_temporary = FALSE;
+	}
+}
+
+
 /*
  *	Supplies parameter data at execution time.
  *	Used in conjuction with SQLPutData.
@@ -1299,6 +1508,8 @@ PGAPI_ParamData(HSTMT hstmt,
 			if (!CC_commit(conn))
 			{
 				SC_set_error(stmt, STMT_EXEC_ERROR, "Could not commit (in-line) a transaction", func);
+				estmt->lobj_fd = -1;
+				SC_unlink_putdata_lo(estmt);
 				retval = SQL_ERROR;
 				goto cleanup;
 			}
@@ -1315,6 +1526,7 @@ inolog("ipdopts=%p\n", ipdopts);
 		UWORD	flag = SC_is_with_hold(stmt) ? PODBC_WITH_HOLD : 0;
 
 		retval = Exec_with_parameters_resolved(estmt, &exec_end);
+		SC_unlink_putdata_lo(estmt);
 		if (exec_end)
 		{
 			/**SC_reset_delegate(retval, stmt);**/
@@ -1408,7 +1620,7 @@ PGAPI_PutData(HSTMT hstmt,
 	char	   *putbuf, *allocbuf = NULL;
 	Int2		ctype;
 	SQLLEN		putlen;
-	BOOL		lenset = FALSE, handling_lo = FALSE;
+	BOOL		lenset = FALSE, handling_lo = FALSE, streaming_bytea;
 
 	mylog("%s: entering...\n", func);
 
@@ -1476,6 +1688,19 @@ PGAPI_PutData(HSTMT hstmt,
 	}
 	putbuf = rgbValue;
 	handling_lo = (PIC_dsp_pgtype(conn, *current_iparam) == conn->lobj_type);
+	switch (current_iparam->SQLType)
+	{
+		case SQL_BINARY:
+		case SQL_VARBINARY:
+		case SQL_LONGVARBINARY:
+			streaming_bytea = (PIC_dsp_pgtype(conn, *current_iparam) == PG_TYPE_BYTEA &&
+				SQL_C_BINARY == ctype &&
+				!conn->connInfo.use_server_side_prepare &&
+				PG_VERSION_GE(conn, 9.4));
+			break;
+		default:
+			streaming_bytea = FALSE;
+	}
 	if (handling_lo && SQL_C_CHAR == ctype)
 	{
 		allocbuf = malloc(putlen / 2 + 1);
@@ -1502,6 +1727,8 @@ PGAPI_PutData(HSTMT hstmt,
 		}
 
 		*current_pdata->EXEC_used = putlen;
+		current_pdata->lobj_oid = 0;
+		current_pdata->lobj_temporary = FALSE;
 
 		if (cbValue == SQL_NULL_DATA)
 		{
@@ -1513,37 +1740,8 @@ PGAPI_PutData(HSTMT hstmt,
 		/* if (current_iparam->SQLType == SQL_LONGVARBINARY) */
 		if (handling_lo)
 		{
-			/* begin transaction if needed */
-			if (!CC_is_in_trans(conn))
-			{
-				if (!CC_begin(conn))
-				{
-					SC_set_error(stmt, STMT_EXEC_ERROR, "Could not begin (in-line) a transaction", func);
-					retval = SQL_ERROR;
-					goto cleanup;
-				}
-			}
-
-			/* store the oid */
-			current_pdata->lobj_oid = odbc_lo_creat(conn, INV_READ | INV_WRITE);
-			if (current_pdata->lobj_oid == 0)
+			if (!open_putdata_lo(stmt, estmt, current_pdata))
 			{
-				SC_set_error(stmt, STMT_EXEC_ERROR, "Couldnt create large object.", func);
-				retval = SQL_ERROR;
-				goto cleanup;
-			}
-
-			/*
-			 * major hack -- to allow convert to see somethings there have
-			 * to modify convert to handle this better
-			 */
-			/***current_param->EXEC_buffer = (char *) &current_param->lobj_oid;***/
-
-			/* store the fd */
-			estmt->lobj_fd = odbc_lo_open(conn, current_pdata->lobj_oid, INV_WRITE);
-			if (estmt->lobj_fd < 0)
-			{
-				SC_set_error(stmt, STMT_EXEC_ERROR, "Couldnt open large object for writing.", func);
 				retval = SQL_ERROR;
 				goto cleanup;
 			}
@@ -1570,11 +1768,17 @@ PGAPI_PutData(HSTMT hstmt,
 		mylog("PGAPI_PutData: (>1) cbValue = %d\n", cbValue);
 
 		/* if (current_iparam->SQLType == SQL_LONGVARBINARY) */
-		if (handling_lo)
+		if (handling_lo || current_pdata->lobj_temporary)
 		{
 			/* the large object fd is in EXEC_buffer */
 			retval = odbc_lo_write(conn, estmt->lobj_fd, putbuf, (Int4) putlen);
 			mylog("lo_write(2): cbValue = %d, wrote %d bytes\n", putlen, retval);
+			if (retval < 0)
+			{
+				SC_set_error(stmt, STMT_EXEC_ERROR, "Couldn't write to large object.", func);
+				retval = SQL_ERROR;
+				goto cleanup;
+			}
 
 			*current_pdata->EXEC_used += putlen;
 		}
@@ -1615,6 +1819,32 @@ PGAPI_PutData(HSTMT hstmt,
 		}
 	}
 
+	/*
+	 * Once the bytea data grows large, move it to a temporary large object
+	 * and write the following pieces there. The query reads it with lo_get().
+	 */
+	if (streaming_bytea &&
+		!current_pdata->lobj_temporary &&
+		*current_pdata->EXEC_used > PUTDATA_BYTEA_BUFFER_SIZE)
+	{
+		if (!open_putdata_lo(stmt, estmt, current_pdata))
+		{
+			retval = SQL_ERROR;
+			goto cleanup;
+		}
+		current_pdata->lobj_temporary = TRUE;
+		retval = odbc_lo_write(conn, estmt->lobj_fd, current_pdata->EXEC_buffer, (Int4) *current_pdata->EXEC_used);
+		mylog("lo_write(bytea): wrote %d bytes\n", retval);
+		if (retval < 0)
+		{
+			SC_set_error(stmt, STMT_EXEC_ERROR, "Couldn't write to large object.", func);
+			retval = SQL_ERROR;
+			goto cleanup;
+		}
+		free(current_pdata->EXEC_buffer);
+		current_pdata->EXEC_buffer = NULL;
+	}
+
 	retval = SQL_SUCCESS;
 cleanup:
 #undef	return
@@ -806,7 +806,7 @@ mylog("CONVERT_FUNCTIONS=" FORMAT_ULEN "\n", value);
 			break;
 		case SQL_ASYNC_MODE:
 			len = 4;
-			value = SQL_AM_NONE;
+			value = SQL_AM_STATEMENT;
 			break;
 		case SQL_BATCH_ROW_COUNT:
 			len = 4;
@@ -921,6 +921,10 @@ mylog("CONVERT_FUNCTIONS=" FORMAT_ULEN "\n", value);
 			len = 4;
 			value = SQL_IS_INSERT_LITERALS | SQL_IS_INSERT_SEARCHED | SQL_IS_SELECT_INTO;
 			break;
+		case SQL_MAX_ASYNC_CONCURRENT_STATEMENTS:
+			len = 4;
+			value = 1;
+			break;
 		case SQL_MAX_IDENTIFIER_LEN:
 			len = 2;
 			value = CC_get_max_idlen(conn);
@@ -1014,8 +1018,6 @@ mylog("CONVERT_FUNCTIONS=" FORMAT_ULEN "\n", value);
 			len = 0;
 		case SQL_DRIVER_HDESC:
 			len = 4;
-		case SQL_MAX_ASYNC_CONCURRENT_STATEMENTS:
-			len = 4;
 		case SQL_STANDARD_CLI_CONFORMANCE:
 			len = 4;
 		case SQL_XOPEN_CLI_YEAR:
@@ -15,6 +15,8 @@
 #include "lobj.h"
 
 #include "connection.h"
+#include "qresult.h"
+#include "misc.h"
 
 
 OID
@@ -77,6 +79,24 @@ odbc_lo_close(ConnectionClass *conn, int fd)
 }
 
 
+int
+odbc_lo_unlink(ConnectionClass *conn, OID lobjId)
+{
+	LO_ARG		argv[1];
+	int			retval,
+				result_len;
+
+	argv[0].isint = 1;
+	argv[0].len = 4;
+	argv[0].u.integer = (int) lobjId;
+
+	if (!CC_send_function(conn, "lo_unlink", &retval, &result_len, 1, argv, 1))
+		return -1;
+	else
+		return retval;
+}
+
+
 Int4
 odbc_lo_read(ConnectionClass *conn, int fd, char *buf, Int4 len)
 {
@@ -166,3 +186,85 @@ odbc_lo_tell(ConnectionClass *conn, int fd)
 	else
 		return retval;
 }
+
+
+/*
+ * Read the sizes and the first bytes of 'count' large objects in one
+ * query, instead of opening, seeking and reading each of them with a
+ * function call. lens[i] is the number of bytes wanted of lobjIds[i].
+ * The rows of the result are (oid, size, the bytes in hex). lo_get()
+ * needs 9.4 or later servers.
+ */
+QResultClass *
+odbc_lo_get_heads(ConnectionClass *conn, const OID *lobjIds, const Int4 *lens, int count, UDWORD flag)
+{
+	static const char	tail[] = ") v(o, n) offset 0) s";
+	char	   *query;
+	size_t		qlen;
+	int			i;
+	QResultClass *res;
+
+	if (count <= 0)
+		return NULL;
+	qlen = 256 + count * 32;
+	if (NULL == (query = malloc(qlen)))
+		return NULL;
+	snprintf(query, qlen, "select o, pg_catalog.lo_lseek64(fd, 0, %d), pg_catalog.encode(pg_catalog.lo_get(o, 0, n), 'hex'), pg_catalog.lo_close(fd) from (select o, n, pg_catalog.lo_open(o, %d) as fd from (values ", SEEK_END, INV_READ);
+	for (i = 0; i < count; i++)
+		snprintf_add(query, qlen, "%s(%u::oid, %d)", i > 0 ? ", " : "", lobjIds[i], lens[i] > 0 ? lens[i] : 0);
+	strlcat(query, tail, qlen);
+	res = CC_send_query(conn, query, NULL, flag, NULL);
+	free(query);
+	if (!QR_command_maybe_successful(res))
+	{
+		QR_Destructor(res);
+		return NULL;
+	}
+
+	return res;
+}
+
+
+/*
+ * Read 'len' bytes at 'offset' of a large object without opening it.
+ * The result has one row of the bytes in hex.
+ */
+QResultClass *
+odbc_lo_get(ConnectionClass *conn, OID lobjId, Int4 offset, Int4 len)
+{
+	char		query[128];
+	QResultClass *res;
+
+	snprintf(query, sizeof(query), "select pg_catalog.encode(pg_catalog.lo_get(%u, %d, %d), 'hex')", lobjId, offset, len);
+	res = CC_send_query(conn, query, NULL, 0, NULL);
+	if (!QR_command_maybe_successful(res) ||
+		1 != QR_get_num_cached_tuples(res))
+	{
+		QR_Destructor(res);
+		return NULL;
+	}
+
+	return res;
+}
+
+/*
+ * Unlink a large object which may have disappeared already, with the
+ * rollback of the transaction which created it. Returns FALSE if it
+ * can't be done now, in an aborted transaction.
+ */
+BOOL
+odbc_lo_unlink_if_exists(ConnectionClass *conn, OID lobjId)
+{
+	char		query[128];
+	QResultClass *res;
+	BOOL		ret;
+
+	if (CC_is_in_error_trans(conn))
+		return FALSE;
+	snprintf(query, sizeof(query), "select pg_catalog.lo_unlink(oid) from pg_catalog.pg_largeobject_metadata where oid = %u", lobjId);
+	res = CC_send_query(conn, query, NULL, ROLLBACK_ON_ERROR | IGNORE_ABORT_ON_CONN, NULL);
+	ret = QR_command_maybe_successful(res);
+	QR_Destructor(res);
+
+	return ret;
+}
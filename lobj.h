@@ -29,9 +29,13 @@ struct lo_arg
 OID		odbc_lo_creat(ConnectionClass *conn, int mode);
 int		odbc_lo_open(ConnectionClass *conn, int lobjId, int mode);
 int		odbc_lo_close(ConnectionClass *conn, int fd);
+int		odbc_lo_unlink(ConnectionClass *conn, OID lobjId);
+BOOL		odbc_lo_unlink_if_exists(ConnectionClass *conn, OID lobjId);
 Int4		odbc_lo_read(ConnectionClass *conn, int fd, char *buf, Int4 len);
 Int4		odbc_lo_write(ConnectionClass *conn, int fd, char *buf, Int4 len);
 Int4		odbc_lo_lseek(ConnectionClass *conn, int fd, int offset, Int4 len);
 Int4		odbc_lo_tell(ConnectionClass *conn, int fd);
+QResultClass	*odbc_lo_get_heads(ConnectionClass *conn, const OID *lobjIds, const Int4 *lens, int count, UDWORD flag);
+QResultClass	*odbc_lo_get(ConnectionClass *conn, OID lobjId, Int4 offset, Int4 len);
 
 #endif
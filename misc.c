@@ -24,6 +24,7 @@
 #ifndef WIN32
 #include <pwd.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include <unistd.h>
 #else
 #include <process.h>			/* Byron: is this where Windows keeps def.
@@ -439,3 +440,26 @@ quote_table(const pgNAME schema, pgNAME table)
 
 	return buf;
 }
+
+/*
+ *	A clock in microseconds to measure short intervals with. It wraps
+ *	around, so only the difference of two values is meaningful.
+ */
+UInt4
+get_usec_clock(void)
+{
+#ifdef	WIN32
+	LARGE_INTEGER	count, freq;
+
+	if (!QueryPerformanceFrequency(&freq) ||
+		!QueryPerformanceCounter(&count))
+		return (UInt4) GetTickCount() * 1000;
+	return (UInt4) ((count.QuadPart / freq.QuadPart) * 1000000 +
+					(count.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart);
+#else
+	struct timeval	tv;
+
+	gettimeofday(&tv, NULL);
+	return (UInt4) tv.tv_sec * 1000000 + (UInt4) tv.tv_usec;
+#endif /* WIN32 */
+}
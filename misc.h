@@ -44,6 +44,7 @@ char *quote_table(const pgNAME schema, pgNAME table);
 #define STRCPY_NULL			(-2)
 
 ssize_t			my_strcpy(char *dst, ssize_t dst_len, const char *src, ssize_t src_len);
+UInt4			get_usec_clock(void);
 
 #ifdef __cplusplus
 }
@@ -289,7 +289,8 @@ SQLExecDirect(HSTMT StatementHandle,
 		ret = SQL_ERROR;
 	else
 	{
-		StartRollbackState(stmt);
+		if (!SC_is_async_running(stmt))
+			StartRollbackState(stmt);
 		ret = PGAPI_ExecDirect(StatementHandle, StatementText, TextLength, flag);
 		ret = DiscardStatementSvp(stmt, ret, FALSE);
 	}
@@ -313,8 +314,11 @@ SQLExecute(HSTMT StatementHandle)
 		ret = SQL_ERROR;
 	else
 	{
-		StartRollbackState(stmt);
-		stmt->exec_current_row = -1;
+		if (!SC_is_async_running(stmt))
+		{
+			StartRollbackState(stmt);
+			stmt->exec_current_row = -1;
+		}
 		ret = PGAPI_Execute(StatementHandle, flag);
 		ret = DiscardStatementSvp(stmt, ret, FALSE);
 	}
@@ -302,7 +302,8 @@ SQLExecDirectW(HSTMT StatementHandle,
 	ENTER_STMT_CS(stmt);
 	SC_clear_error(stmt);
 	flag |= PODBC_WITH_HOLD;
-	StartRollbackState(stmt);
+	if (!SC_is_async_running(stmt))
+		StartRollbackState(stmt);
 	if (SC_opencheck(stmt, func))
 		ret = SQL_ERROR;
 	else
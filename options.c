@@ -40,7 +40,22 @@ set_statement_option(ConnectionClass *conn,
 		ci = &(SC_get_conn(stmt)->connInfo);
 	switch (fOption)
 	{
-		case SQL_ASYNC_ENABLE:	/* ignored */
+		case SQL_ASYNC_ENABLE:
+			mylog("SetStmtOption(): SQL_ASYNC_ENABLE, vParam = " FORMAT_LEN "\n", vParam);
+			if (conn)
+			{
+				int	i;
+
+				conn->stmtOptions.async_enable = (SQLUINTEGER) vParam;
+				/* applies to the existing statements as well */
+				for (i = 0; i < conn->num_stmts; i++)
+				{
+					if (conn->stmts[i])
+						conn->stmts[i]->options.async_enable = (SQLUINTEGER) vParam;
+				}
+			}
+			if (stmt)
+				stmt->options.async_enable = (SQLUINTEGER) vParam;
 			break;
 
 		case SQL_BIND_TYPE:
@@ -731,8 +746,8 @@ PGAPI_GetStmtOption(HSTMT hstmt,
 
 			break;
 
-		case SQL_ASYNC_ENABLE:	/* NOT SUPPORTED */
-			*((SQLINTEGER *) pvParam) = SQL_ASYNC_ENABLE_OFF;
+		case SQL_ASYNC_ENABLE:
+			*((SQLINTEGER *) pvParam) = stmt->options.async_enable;
 			break;
 
 		case SQL_BIND_TYPE:
@@ -30,6 +30,7 @@
 
 #include "statement.h"
 #include "connection.h"
+#include "environ.h"
 #include "qresult.h"
 #include "pgtypes.h"
 #include "pgapifunc.h"
@@ -781,6 +782,384 @@ COL_INFO **coli)
 	return TRUE; /* success */
 }
 
+/*
+ *	Get a COL_INFO slot of the connection for the table 'greloid'.
+ *	The slot of the same table or that of the least recently used
+ *	table is recycled, or a new slot is added.
+ */
+static COL_INFO *
+allocColInfo(ConnectionClass *conn, OID greloid, StatementClass *stmt)
+{
+	BOOL		coli_exist = FALSE;
+	COL_INFO	*coli = NULL, *ccoli = NULL, *tcoli;
+	int		k;
+	time_t		acctime = 0;
+
+	if (greloid != 0)
+	{
+		for (k = 0; k < conn->ntables; k++)
+		{
+			tcoli = conn->col_info[k];
+			if (tcoli->table_oid == greloid)
+			{
+				coli = tcoli;
+				coli_exist = TRUE;
+				break;
+			}
+		}
+	}
+	if (!coli_exist)
+	{
+		for (k = 0; k < conn->ntables; k++)
+		{
+			tcoli = conn->col_info[k];
+			if (0 < tcoli->refcnt)
+				continue;
+			if ((0 == tcoli->table_oid &&
+			    NAME_IS_NULL(tcoli->table_name)) ||
+			    strnicmp(SAFE_NAME(tcoli->schema_name), "pg_temp_", 8) == 0)
+			{
+				coli = tcoli;
+				coli_exist = TRUE;
+				break;
+			}
+			if (NULL == ccoli ||
+			    tcoli->acc_time < acctime)
+			{
+				ccoli = tcoli;
+				acctime = tcoli->acc_time;
+			}
+		}
+		if (!coli_exist &&
+		    NULL != ccoli &&
+		    conn->ntables >= COLI_RECYCLE)
+		{
+			coli_exist = TRUE;
+			coli = ccoli;
+		}
+	}
+	if (coli_exist)
+	{
+		free_col_info_contents(coli);
+	}
+	else
+	{
+		if (conn->ntables >= conn->coli_allocated)
+		{
+			Int2	new_alloc;
+			COL_INFO **col_info;
+
+			new_alloc = conn->coli_allocated * 2;
+			if (new_alloc <= conn->ntables)
+				new_alloc = COLI_INCR;
+			mylog("PARSE: Allocating col_info at ntables=%d\n", conn->ntables);
+
+			col_info = (COL_INFO **) realloc(conn->col_info, new_alloc * sizeof(COL_INFO *));
+			if (!col_info)
+			{
+				if (stmt)
+					SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "PGAPI_AllocStmt failed in parse_statement for col_info.", __FUNCTION__);
+				return NULL;
+			}
+			conn->col_info = col_info;
+			conn->coli_allocated = new_alloc;
+		}
+
+		mylog("PARSE: malloc at conn->col_info[%d]\n", conn->ntables);
+		coli = conn->col_info[conn->ntables] = (COL_INFO *) malloc(sizeof(COL_INFO));
+		if (coli)
+			conn->ntables++;
+	}
+	if (!coli)
+	{
+		if (stmt)
+			SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "PGAPI_AllocStmt failed in parse_statement for col_info(2).", __FUNCTION__);
+		return NULL;
+	}
+	col_info_initialize(coli);
+
+	return coli;
+}
+
+/*
+ *	Store the SQLColumns result 'res' of the table 'wti' in 'coli'
+ *	and associate the table with it.
+ */
+static void
+setColInfo(COL_INFO *coli, QResultClass *res, TABLE_INFO *wti, OID greloid)
+{
+	coli->result = res;
+	if (res && QR_get_num_cached_tuples(res) > 0)
+	{
+		if (!greloid)
+			greloid = (OID) strtoul(QR_get_value_backend_text(res, 0, COLUMNS_TABLE_OID), NULL, 10);
+		if (!wti->table_oid)
+			wti->table_oid = greloid;
+		if (NAME_IS_NULL(wti->schema_name))
+			STR_TO_NAME(wti->schema_name,
+				QR_get_value_backend_text(res, 0, COLUMNS_SCHEMA_NAME));
+		if (NAME_IS_NULL(wti->table_name))
+			STR_TO_NAME(wti->table_name,
+				QR_get_value_backend_text(res, 0, COLUMNS_TABLE_NAME));
+	}
+inolog("#2 %p->table_name=%s(%u)\n", wti, PRINT_NAME(wti->table_name), wti->table_oid);
+	/*
+	 * Store the table name and the SQLColumns result
+	 * structure
+	 */
+	if (NAME_IS_VALID(wti->schema_name))
+	{
+		NAME_TO_NAME(coli->schema_name,  wti->schema_name);
+	}
+	else
+		NULL_THE_NAME(coli->schema_name);
+	NAME_TO_NAME(coli->table_name, wti->table_name);
+	coli->table_oid = wti->table_oid;
+
+	/* Associate a table from the statement with a SQLColumn info */
+	coli->refcnt++;
+	wti->col_info = coli;
+}
+
+/*
+ *	The column info cache shared among the connections of the process
+ *	(Extra Opts 0x1000).
+ *
+ *	Each connection keeps its own COL_INFO slots, but the SQLColumns
+ *	results are borrowed from this cache so that the catalog is
+ *	queried once per table. The entries are keyed by the server, the
+ *	database, the options which change the SQLColumns result and the
+ *	table oid. They are reference counted : the cache holds one
+ *	reference and each COL_INFO borrowing the result holds another.
+ *	The results are read-only once they are shared.
+ */
+#define	SHARED_COLI_BUCKETS	256
+#define	SHARED_COLI_MAX		(COLI_RECYCLE * 8)
+#define	SHARED_COLI_KEYLEN	512
+
+typedef struct SharedColInfo_
+{
+	struct SharedColInfo_	*next;	/* in the hash bucket */
+	char		*key;
+	OID		table_oid;
+	QResultClass	*result;
+	Int4		refcnt;
+	time_t		acc_time;
+} SharedColInfo;
+
+static SharedColInfo	*shared_coli[SHARED_COLI_BUCKETS];
+static int	num_shared_coli = 0;
+
+/*
+ *	Returns FALSE if the key doesn't fit in 'keylen' bytes. The tables of
+ *	such a connection aren't shared, as a truncated key could match the
+ *	key of another database.
+ */
+static BOOL
+makeSharedColInfoKey(const ConnectionClass *conn, char *key, size_t keylen)
+{
+	const ConnInfo	*ci = &(conn->connInfo);
+	const EnvironmentClass *env = (EnvironmentClass *) CC_get_env(conn);
+	int	len;
+
+	len = snprintf(key, keylen, "%s:%s/%s;%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d",
+		ci->server, ci->port, ci->database,
+		ci->drivers.unknown_sizes,
+		ci->drivers.max_varchar_size,
+		ci->drivers.max_longvarchar_size,
+		ci->drivers.text_as_longvarchar,
+		ci->drivers.unknowns_as_longvarchar,
+		ci->drivers.bools_as_char,
+		ci->drivers.lie,
+		ci->int8_as,
+		ci->bytea_as_longvarbinary,
+		conn->unicode,
+		conn->ms_jet,
+		EN_is_odbc3(env));
+	return (len >= 0 && (size_t) len < keylen);
+}
+
+static UInt4
+sharedColInfoHash(const char *key, OID reloid)
+{
+	UInt4	hash = 0;
+
+	for (; *key; key++)
+		hash = hash * 31 + (UCHAR) *key;
+	return (hash ^ (reloid * 0x9e3779b1U)) % SHARED_COLI_BUCKETS;
+}
+
+/* Free an entry no longer referenced. Called in the lock. */
+static void
+freeSharedColInfo(SharedColInfo *shared)
+{
+	QR_Destructor(shared->result);
+	free(shared->key);
+	free(shared);
+}
+
+/* Unlink an entry from the cache. Called in the lock. */
+static void
+unlinkSharedColInfo(SharedColInfo **prev)
+{
+	SharedColInfo	*shared = *prev;
+
+	*prev = shared->next;
+	num_shared_coli--;
+	if (--shared->refcnt <= 0)
+		freeSharedColInfo(shared);
+}
+
+void
+releaseSharedColInfo(SharedColInfo *shared)
+{
+	shortterm_common_lock();
+	if (--shared->refcnt <= 0)
+		freeSharedColInfo(shared);
+	shortterm_common_unlock();
+}
+
+/*
+ *	Drop the shared entries of the table 'reloid', or of all the tables
+ *	if 'reloid' is 0, in the database of the connection
+ */
+void
+clearSharedColInfo(const ConnectionClass *conn, OID reloid)
+{
+	char	key[SHARED_COLI_KEYLEN], *semi;
+	size_t	dblen;
+	int	i;
+	SharedColInfo	**prev;
+
+	if (!makeSharedColInfoKey(conn, key, sizeof(key)))
+		return;
+	semi = strchr(key, ';');
+	dblen = semi - key + 1;
+	shortterm_common_lock();
+	for (i = 0; i < SHARED_COLI_BUCKETS; i++)
+	{
+		for (prev = &shared_coli[i]; NULL != *prev;)
+		{
+			if ((0 == reloid || (*prev)->table_oid == reloid) &&
+			    strncmp((*prev)->key, key, dblen) == 0)
+				unlinkSharedColInfo(prev);
+			else
+				prev = &(*prev)->next;
+		}
+	}
+	shortterm_common_unlock();
+	mylog("%s: cleared the shared col_info %u of %s\n", __FUNCTION__, reloid, key);
+}
+
+/*
+ *	Look for the table 'greloid' in the shared cache and, if found,
+ *	associate the table with a COL_INFO borrowing the result.
+ */
+static BOOL
+getSharedColumnsInfo(ConnectionClass *conn, TABLE_INFO *wti, OID greloid, StatementClass *stmt)
+{
+	char	key[SHARED_COLI_KEYLEN];
+	SharedColInfo	*shared;
+	COL_INFO	*coli;
+
+	if (!makeSharedColInfoKey(conn, key, sizeof(key)))
+		return FALSE;
+	shortterm_common_lock();
+	for (shared = shared_coli[sharedColInfoHash(key, greloid)]; NULL != shared; shared = shared->next)
+	{
+		if (shared->table_oid == greloid &&
+		    strcmp(shared->key, key) == 0)
+		{
+			shared->refcnt++;
+			shared->acc_time = SC_get_time(stmt);
+			break;
+		}
+	}
+	shortterm_common_unlock();
+	if (NULL == shared)
+		return FALSE;
+	mylog("FOUND shared col_info table=%u\n", greloid);
+	if (coli = allocColInfo(conn, greloid, stmt), NULL == coli)
+	{
+		releaseSharedColInfo(shared);
+		return FALSE;
+	}
+	coli->shared = shared;
+	setColInfo(coli, shared->result, wti, greloid);
+	return TRUE;
+}
+
+/* Add the result of 'coli' to the shared cache */
+static void
+addSharedColInfo(ConnectionClass *conn, COL_INFO *coli, StatementClass *stmt)
+{
+	char	key[SHARED_COLI_KEYLEN];
+	UInt4	bucket;
+	int	i;
+	SharedColInfo	*shared, **prev, **oldest = NULL;
+	BOOL	found = FALSE;
+
+	if (0 == coli->table_oid ||
+	    strnicmp(SAFE_NAME(coli->schema_name), "pg_temp_", 8) == 0)
+		return;
+	if (!makeSharedColInfoKey(conn, key, sizeof(key)))
+		return;
+	bucket = sharedColInfoHash(key, coli->table_oid);
+	if (shared = (SharedColInfo *) malloc(sizeof(SharedColInfo)), NULL == shared)
+		return;
+	if (shared->key = strdup(key), NULL == shared->key)
+	{
+		free(shared);
+		return;
+	}
+	shared->table_oid = coli->table_oid;
+	shared->result = coli->result;
+	shared->refcnt = 2;	/* the cache and coli */
+	shared->acc_time = SC_get_time(stmt);
+
+	shortterm_common_lock();
+	for (prev = &shared_coli[bucket]; NULL != *prev; prev = &(*prev)->next)
+	{
+		/* added by another connection meanwhile */
+		if ((*prev)->table_oid == shared->table_oid &&
+		    strcmp((*prev)->key, key) == 0)
+			break;
+	}
+	if (NULL != *prev)
+		found = TRUE;
+	/*
+	 * Evict the least recently used entry no connection is using. If
+	 * every entry is in use, the result isn't shared.
+	 */
+	else if (num_shared_coli >= SHARED_COLI_MAX)
+	{
+		for (i = 0; i < SHARED_COLI_BUCKETS; i++)
+		{
+			for (prev = &shared_coli[i]; NULL != *prev; prev = &(*prev)->next)
+			{
+				if (1 == (*prev)->refcnt &&
+				    (NULL == oldest || (*prev)->acc_time < (*oldest)->acc_time))
+					oldest = prev;
+			}
+		}
+		if (NULL != oldest)
+			unlinkSharedColInfo(oldest);
+	}
+	if (found || num_shared_coli >= SHARED_COLI_MAX)
+	{
+		shortterm_common_unlock();
+		free(shared->key);
+		free(shared);
+		return;
+	}
+	QR_set_conn(shared->result, NULL);
+	shared->next = shared_coli[bucket];
+	shared_coli[bucket] = shared;
+	num_shared_coli++;
+	coli->shared = shared;
+	shortterm_common_unlock();
+}
+
 static BOOL
 getColumnsInfo(ConnectionClass *conn, TABLE_INFO *wti, OID greloid, StatementClass *stmt)
 {
@@ -821,120 +1200,12 @@ getColumnsInfo(ConnectionClass *conn, TABLE_INFO *wti, OID greloid, StatementCla
 	if (SQL_SUCCEEDED(result)
 		&& res != NULL && QR_get_num_cached_tuples(res) > 0)
 	{
-		BOOL		coli_exist = FALSE;
-		COL_INFO	*coli = NULL, *ccoli = NULL, *tcoli;
-		int		k;
-		time_t		acctime = 0;
+		COL_INFO	*coli;
 
 		mylog("      Success\n");
-		if (greloid != 0)
-		{
-			for (k = 0; k < conn->ntables; k++)
-			{
-				tcoli = conn->col_info[k];
-				if (tcoli->table_oid == greloid)
-				{
-					coli = tcoli;
-					coli_exist = TRUE;
-					break;
-				}
-			}
-		}
-		if (!coli_exist)
-		{
-			for (k = 0; k < conn->ntables; k++)
-			{
-				tcoli = conn->col_info[k];
-				if (0 < tcoli->refcnt)
-					continue;
-				if ((0 == tcoli->table_oid &&
-				    NAME_IS_NULL(tcoli->table_name)) ||
-				    strnicmp(SAFE_NAME(tcoli->schema_name), "pg_temp_", 8) == 0)
-				{
-					coli = tcoli;
-					coli_exist = TRUE;
-					break;
-				}
-				if (NULL == ccoli ||
-				    tcoli->acc_time < acctime)
-				{
-					ccoli = tcoli;
-					acctime = tcoli->acc_time;
-				}
-			}
-			if (!coli_exist &&
-			    NULL != ccoli &&
-			    conn->ntables >= COLI_RECYCLE)
-			{
-				coli_exist = TRUE;
-				coli = ccoli;
-			}
-		}
-		if (coli_exist)
-		{
-			free_col_info_contents(coli);
-		}
-		else
-		{
-			if (conn->ntables >= conn->coli_allocated)
-			{
-				Int2	new_alloc;
-				COL_INFO **col_info;
-
-				new_alloc = conn->coli_allocated * 2;
-				if (new_alloc <= conn->ntables)
-					new_alloc = COLI_INCR;
-				mylog("PARSE: Allocating col_info at ntables=%d\n", conn->ntables);
-
-				col_info = (COL_INFO **) realloc(conn->col_info, new_alloc * sizeof(COL_INFO *));
-				if (!col_info)
-				{
-					if (stmt)
-						SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "PGAPI_AllocStmt failed in parse_statement for col_info.", __FUNCTION__);
-					goto cleanup;
-				}
-				conn->col_info = col_info;
-				conn->coli_allocated = new_alloc;
-			}
-
-			mylog("PARSE: malloc at conn->col_info[%d]\n", conn->ntables);
-			coli = conn->col_info[conn->ntables] = (COL_INFO *) malloc(sizeof(COL_INFO));
-		}
-		if (!coli)
-		{
-			if (stmt)
-				SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "PGAPI_AllocStmt failed in parse_statement for col_info(2).", __FUNCTION__);
+		if (coli = allocColInfo(conn, greloid, stmt), NULL == coli)
 			goto cleanup;
-		}
-		col_info_initialize(coli);
-
-		coli->result = res;
-		if (res && QR_get_num_cached_tuples(res) > 0)
-		{
-			if (!greloid)
-				greloid = (OID) strtoul(QR_get_value_backend_text(res, 0, COLUMNS_TABLE_OID), NULL, 10);
-			if (!wti->table_oid)
-				wti->table_oid = greloid;
-			if (NAME_IS_NULL(wti->schema_name))
-				STR_TO_NAME(wti->schema_name,
-					QR_get_value_backend_text(res, 0, COLUMNS_SCHEMA_NAME));
-			if (NAME_IS_NULL(wti->table_name))
-				STR_TO_NAME(wti->table_name,
-					QR_get_value_backend_text(res, 0, COLUMNS_TABLE_NAME));
-		}
-inolog("#2 %p->table_name=%s(%u)\n", wti, PRINT_NAME(wti->table_name), wti->table_oid);
-		/*
-		 * Store the table name and the SQLColumns result
-		 * structure
-		 */
-		if (NAME_IS_VALID(wti->schema_name))
-		{
-			NAME_TO_NAME(coli->schema_name,  wti->schema_name);
-		}
-		else
-			NULL_THE_NAME(coli->schema_name);
-		NAME_TO_NAME(coli->table_name, wti->table_name);
-		coli->table_oid = wti->table_oid;
+		setColInfo(coli, res, wti, greloid);
 
 		/*
 		 * The connection will now free the result structures, so
@@ -942,17 +1213,13 @@ inolog("#2 %p->table_name=%s(%u)\n", wti, PRINT_NAME(wti->table_name), wti->tabl
 		 */
 		SC_init_Result(col_stmt);
 
-		if (!coli_exist)
-			conn->ntables++;
-
 if (res && QR_get_num_cached_tuples(res) > 0)
 inolog("oid item == %s\n", QR_get_value_backend_text(res, 0, 3));
 
 		mylog("Created col_info table='%s', ntables=%d\n", PRINT_NAME(wti->table_name), conn->ntables);
-		/* Associate a table from the statement with a SQLColumn info */
+		if (conn->connInfo.shared_colinfo)
+			addSharedColInfo(conn, coli, stmt);
 		found = TRUE;
-		coli->refcnt++;
-		wti->col_info = coli;
 	}
 cleanup:
 	if (hcol_stmt)
@@ -970,6 +1237,8 @@ BOOL getCOLIfromTI(const char *func, ConnectionClass *conn, StatementClass *stmt
 inolog("getCOLIfromTI reloid=%u ti=%p\n", reloid, wti);
 	if (!conn)
 		conn = SC_get_conn(stmt);
+	if (conn->connInfo.catalog_notify)
+		CC_receive_catalog_notify(conn, TRUE);
 	if (!wti)	/* SQLColAttribute case */
 	{
 		int	i;
@@ -1020,6 +1289,8 @@ inolog("fi=%p greloid=%d col_info=%p\n", wti, greloid, wti->col_info);
 				break;
 			}
 		}
+		if (!found && conn->connInfo.shared_colinfo)
+			found = getSharedColumnsInfo(conn, wti, greloid, stmt);
 	}
 	else
 	{
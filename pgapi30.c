@@ -304,7 +304,8 @@ inolog("rc=%d\n", rc);
 					break;
                                 case SQL_DIAG_ROW_NUMBER:
 					rtnctype = SQL_C_LONG;
-					*((SQLLEN *) DiagInfoPtr) = SQL_ROW_NUMBER_UNKNOWN;
+					stmt = (StatementClass *) Handle;
+					*((SQLLEN *) DiagInfoPtr) = stmt->diag_row_number;
 					ret = SQL_SUCCESS;
 					break;
                                 case SQL_DIAG_COLUMN_NUMBER:
@@ -405,7 +406,7 @@ PGAPI_GetConnectAttr(HDBC ConnectionHandle,
 	switch (Attribute)
 	{
 		case SQL_ATTR_ASYNC_ENABLE:
-			*((SQLINTEGER *) Value) = SQL_ASYNC_ENABLE_OFF;
+			*((SQLINTEGER *) Value) = conn->stmtOptions.async_enable;
 			break;
 		case SQL_ATTR_AUTO_IPD:
 			*((SQLINTEGER *) Value) = SQL_FALSE;
@@ -1659,7 +1660,6 @@ PGAPI_SetConnectAttr(HDBC ConnectionHandle,
 			if (SQL_FALSE != Value)
 				unsupported = TRUE;
 			break;
-		case SQL_ATTR_ASYNC_ENABLE:
 		case SQL_ATTR_CONNECTION_DEAD:
 		case SQL_ATTR_CONNECTION_TIMEOUT:
 			unsupported = TRUE;
@@ -21,6 +21,7 @@
 #include "psqlodbc.h"
 #include "dlg_specific.h"
 #include "environ.h"
+#include "connection.h"
 #include "misc.h"
 
 #ifdef WIN32
@@ -190,6 +191,8 @@ DllMain(HANDLE hInst, ULONG ul_reason_for_call, LPVOID lpReserved)
 
 		case DLL_PROCESS_DETACH:
 			mylog("DETACHING PROCESS\n");
+			/* before libpq is unloaded */
+			CC_close_pooled_connections();
 			CleanupDelayLoadedDLLs();
 			/* my(q)log is unavailable from here */
 			finalize_global_cs();
@@ -225,6 +228,7 @@ static void
 __attribute__((destructor))
 psqlodbc_fini(void)
 {
+	CC_close_pooled_connections();
 	finalize_global_cs();
 }
 
@@ -242,6 +246,7 @@ _init(void)
 BOOL
 _fini(void)
 {
+	CC_close_pooled_connections();
 	finalize_global_cs();
 	return TRUE;
 }
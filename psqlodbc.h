@@ -465,6 +465,7 @@ typedef struct StatementOptions_
 	SQLUINTEGER		use_bookmarks;
 	void			*bookmark_ptr;
 	SQLUINTEGER		metadata_id;
+	SQLUINTEGER		async_enable;
 } StatementOptions;
 
 /*	Used to pass extra query info to send_query */
@@ -537,6 +538,7 @@ const pthread_mutexattr_t *getMutexAttr(void);
 SQLULEN	ucs2strlen(const SQLWCHAR *ucs2str);
 char	*ucs2_to_utf8(const SQLWCHAR *ucs2str, SQLLEN ilen, SQLLEN *olen, BOOL tolower);
 SQLULEN	utf8_to_ucs2_lf(const char * utf8str, SQLLEN ilen, BOOL lfconv, SQLWCHAR *ucs2str, SQLULEN buflen, BOOL errcheck);
+SQLULEN	utf8_to_ucs2_next(const char *utf8str, BOOL lfconv, SQLWCHAR *ucs2str, SQLULEN bufcount, SQLLEN *pos, SQLWCHAR *pending);
 int	msgtowstr(const char *, int, LPWSTR, int);
 int	wstrtomsg(const LPWSTR, int, char *, int);
 #define	utf8_to_ucs2(utf8str, ilen, ucs2str, buflen) utf8_to_ucs2_lf(utf8str, ilen, FALSE, ucs2str, buflen, FALSE)
@@ -18,6 +18,7 @@
 
 #include "qresult.h"
 #include "statement.h"
+#include "dlg_specific.h"
 
 #include <libpq-fe.h>
 
@@ -27,7 +28,11 @@
 #include <limits.h>
 
 static BOOL QR_prepare_for_tupledata(QResultClass *self);
-static BOOL QR_read_tuples_from_pgres(QResultClass *, PGresult **pgres);
+static BOOL QR_read_tuples_from_pgres(QResultClass *, PGresult **pgres, BOOL borrow);
+static void QR_clear_cached_rows(QResultClass *self, SQLLEN num_rows);
+static void QR_end_stream(QResultClass *self, PGresult *pgres);
+static BOOL fetch_ahead_wanted(const QResultClass *self, const StatementClass *stmt);
+static void QR_send_fetch_ahead(QResultClass *self, Int4 fetch_size);
 
 /*
  *	Used for building a Manual Result only
@@ -189,6 +194,14 @@ QR_Constructor(void)
 		}
 		QR_set_fields(rv, fields);
 		rv->backend_tuples = NULL;
+		rv->pgresults = NULL;
+		rv->num_pgresults = 0;
+		rv->arena = NULL;
+		rv->num_borrowed_rows = 0;
+		rv->fetch_ahead_pgres = NULL;
+		rv->fetch_ahead_size = 0;
+		rv->fetch_count = 0;
+		rv->usec_per_row = 0;
 		rv->sqlstate[0] = '\0';
 		rv->message = NULL;
 		rv->messageref = NULL;
@@ -204,6 +217,7 @@ QR_Constructor(void)
 		rv->fetch_number = 0;
 		rv->flags = 0; /* must be cleared before calling QR_set_rowstart_in_cache() */
 		QR_set_rowstart_in_cache(rv, -1);
+		rv->stream_base = 0;
 		rv->key_base = -1;
 		rv->recent_processed_row_count = -1;
 		rv->cursTuple = -1;
@@ -259,6 +273,8 @@ QR_close_result(QResultClass *self, BOOL destroy)
 		 * If conn is defined, then we may have used "backend_tuples", so in
 		 * case we need to, free it up.  Also, close the cursor.
 		 */
+		if (QR_is_streaming(self))
+			QR_end_stream(self, NULL);
 		if ((conn = QR_get_conn(self)) && conn->pqconn)
 		{
 			if (CC_is_in_trans(conn) || QR_is_withhold(self))
@@ -467,6 +483,92 @@ inolog("QR_AddNew %dth row(%d fields) alloc=%d\n", self->num_cached_rows, QR_Num
 	return self->backend_tuples + num_fields * (self->num_cached_rows - 1);
 }
 
+/*
+ * Values of read-only results received in single row mode are copied
+ * into blocks owned by the result, instead of malloc'ing a buffer per
+ * value, and all the blocks are freed at once with the tuple cache.
+ * The first block is sized for the cache size of the result, and the
+ * following ones double up to ARENA_BLOCK_MAX.
+ */
+struct ArenaBlock_
+{
+	struct ArenaBlock_	*next;
+	size_t		size;
+	size_t		used;
+};
+#define	ARENA_BLOCK_MIN	8192
+#define	ARENA_BLOCK_MAX	(1024 * 1024)
+#define	ARENA_BYTES_PER_FIELD	16
+
+static char *
+QR_arena_alloc(QResultClass *self, size_t len)
+{
+	struct ArenaBlock_	*block = self->arena;
+	size_t		bsize;
+	char	   *ptr;
+
+	if (NULL == block || block->size - block->used < len)
+	{
+		if (block)
+			bsize = block->size * 2;
+		else
+			bsize = self->cache_size * self->num_fields * ARENA_BYTES_PER_FIELD;
+		if (bsize < ARENA_BLOCK_MIN)
+			bsize = ARENA_BLOCK_MIN;
+		else if (bsize > ARENA_BLOCK_MAX)
+			bsize = ARENA_BLOCK_MAX;
+		if (bsize < len)
+			bsize = len;
+		if (block = (struct ArenaBlock_ *) malloc(sizeof(struct ArenaBlock_) + bsize), NULL == block)
+			return NULL;
+		block->next = self->arena;
+		block->size = bsize;
+		block->used = 0;
+		self->arena = block;
+	}
+	ptr = (char *) (block + 1) + block->used;
+	block->used += len;
+
+	return ptr;
+}
+
+/*
+ * Free the values of the cached rows and release the PGresults and
+ * the arena blocks the borrowed ones are in.
+ */
+static void
+QR_clear_cached_rows(QResultClass *self, SQLLEN num_rows)
+{
+	SQLLEN		num_borrowed = self->num_borrowed_rows;
+	int			num_fields = self->num_fields;
+	UInt4		i;
+
+	if (num_borrowed > num_rows)
+		num_borrowed = num_rows;
+	if (self->backend_tuples)
+	{
+		if (num_borrowed > 0)
+			memset(self->backend_tuples, 0, sizeof(TupleField) * num_fields * num_borrowed);
+		ClearCachedRows(self->backend_tuples + num_fields * num_borrowed, num_fields, num_rows - num_borrowed);
+	}
+	for (i = 0; i < self->num_pgresults; i++)
+		PQclear(self->pgresults[i]);
+	if (self->pgresults)
+	{
+		free(self->pgresults);
+		self->pgresults = NULL;
+	}
+	self->num_pgresults = 0;
+	while (self->arena)
+	{
+		struct ArenaBlock_	*next = self->arena->next;
+
+		free(self->arena);
+		self->arena = next;
+	}
+	self->num_borrowed_rows = 0;
+}
+
 void
 QR_free_memory(QResultClass *self)
 {
@@ -475,9 +577,15 @@ QR_free_memory(QResultClass *self)
 
 	mylog("QResult: free memory in, fcount=%d\n", num_backend_rows);
 
+	QR_receive_fetch_ahead(self);
+	if (self->fetch_ahead_pgres)
+	{
+		PQclear(self->fetch_ahead_pgres);
+		self->fetch_ahead_pgres = NULL;
+	}
+	QR_clear_cached_rows(self, num_backend_rows);
 	if (self->backend_tuples)
 	{
-		ClearCachedRows(self->backend_tuples, num_fields, num_backend_rows);
 		free(self->backend_tuples);
 		self->count_backend_allocated = 0;
 		self->backend_tuples = NULL;
@@ -568,6 +676,7 @@ QR_free_memory(QResultClass *self)
 	self->num_total_read = 0;
 	self->num_cached_rows = 0;
 	self->num_cached_keys = 0;
+	self->stream_base = 0;
 	self->cursTuple = -1;
 	self->pstatus = 0;
 
@@ -631,6 +740,7 @@ QR_from_PGresult(QResultClass *self, StatementClass *stmt, ConnectionClass *conn
 		mylog("%s: fieldname='%s', adtid=%d, adtsize=%d, atttypmod=%d (rel,att)=(%d,%d)\n", func, new_field_name, new_adtid, new_adtsize, new_atttypmod, new_relid, new_attid);
 
 		CI_set_field_info(QR_get_fields(self), lf, new_field_name, new_adtid, new_adtsize, new_atttypmod, new_relid, new_attid);
+		CI_get_format(QR_get_fields(self), lf) = (Int2) PQfformat(*pgres, lf);
 
 		QR_set_rstatus(self, PORES_FIELDS_OK);
 		self->num_fields = CI_get_num_fields(QR_get_fields(self));
@@ -662,8 +772,15 @@ inolog("!![%d].PGType %u->%u\n", i, PIC_get_pgtype(ipdopts->parameters[i]), CI_g
 	}
 
 
-	/* Then, get the data itself */
-	if (!QR_read_tuples_from_pgres(self, pgres))
+	/*
+	 * Then, get the data itself. The values of read-only results are
+	 * left in the PGresult, the others may be modified or moved to
+	 * another result by SetPos or BulkOperations.
+	 */
+	if (!QR_read_tuples_from_pgres(self, pgres,
+			NULL != stmt &&
+			SQL_CONCUR_READ_ONLY == stmt->options.scroll_concurrency &&
+			!QR_haskeyset(self)))
 		return FALSE;
 
 inolog("!!%p->cursTup=%d total_read=%d\n", self, self->cursTuple, self->num_total_read);
@@ -679,8 +796,14 @@ inolog("!!%p->cursTup=%d total_read=%d\n", self, self->cursTuple, self->num_tota
 	 * Also fill in command tag. (Typically, it's SELECT, but can also be
 	 * a FETCH.)
 	 */
-	QR_set_command(self, PQcmdStatus(*pgres));
+	if (NULL != *pgres)
+		QR_set_command(self, PQcmdStatus(*pgres));
 	QR_set_cursor(self, cursor);
+	/* the PGresult is kept until the tuple cache is cleared */
+	if (NULL != *pgres &&
+		self->num_pgresults > 0 &&
+		self->pgresults[self->num_pgresults - 1] == *pgres)
+		*pgres = NULL;
 	return TRUE;
 }
 
@@ -873,6 +996,74 @@ static SQLLEN enlargeKeyCache(QResultClass *self, SQLLEN add_size, const char *m
 	return alloc;
 }
 
+/* Determine the optimum cache size.  */
+static Int4
+optimum_fetch_size(const QResultClass *self, const ConnInfo *ci)
+{
+	Int4	req_size = self->rowset_size_include_ommitted;
+	Int4	fetch_max = ci->drivers.fetch_max;
+
+	if (ci->fetch_cache_bytes > 0 && self->fetch_count > 0)
+		fetch_max = self->fetch_count;
+	if (fetch_max % req_size == 0)
+		return fetch_max;
+	else if (req_size < fetch_max)
+	{
+		/*return (fetch_max / req_size + 1) * req_size;*/
+		return (fetch_max / req_size) * req_size;
+	}
+	return req_size;
+}
+
+/*
+ *	Adapt the FETCH count to the rows just received (FetchCacheBytes).
+ *
+ *	The count is limited so that the tuple cache holds at most
+ *	FetchCacheBytes bytes of rows of the observed size. Below the
+ *	limit it is doubled as long as doing so reduced the time per row,
+ *	i.e. while the round trips take a noticeable part of the time.
+ *	'usec' is the time the FETCH of 'requested' rows took, 0 if it's
+ *	unknown (the rows were fetched ahead).
+ */
+static void
+adapt_fetch_count(QResultClass *self, const ConnInfo *ci, Int4 requested, UInt4 usec)
+{
+	CSTR func = "adapt_fetch_count";
+	SQLLEN	num_rows = self->num_cached_rows, i;
+	int	num_fields = self->num_fields;
+	size_t	total_bytes = 0, row_bytes;
+	Int4	count, max_count;
+
+	if (ci->fetch_cache_bytes <= 0 || num_rows <= 0 ||
+	    num_fields <= 0 || NULL == self->backend_tuples)
+		return;
+	for (i = 0; i < num_rows * num_fields; i++)
+	{
+		if (self->backend_tuples[i].len > 0)
+			total_bytes += self->backend_tuples[i].len;
+	}
+	row_bytes = total_bytes / num_rows + num_fields * sizeof(TupleField) + sizeof(KeySet);
+	max_count = (Int4) (ci->fetch_cache_bytes / row_bytes);
+	if (max_count < 1)
+		max_count = 1;
+	count = self->fetch_count > 0 ? self->fetch_count : ci->drivers.fetch_max;
+	if (count > max_count)
+		count = max_count;
+	else if (usec > 0 && num_rows >= requested)
+	{
+		double	usec_per_row = (double) usec / num_rows;
+
+		/* The first sample or the last doubling paid off */
+		if (0 == self->usec_per_row ||
+		    usec_per_row * 10 < self->usec_per_row * 9)
+			count = count > max_count / 2 ? max_count : count * 2;
+		self->usec_per_row = usec_per_row;
+	}
+	if (count != self->fetch_count)
+		mylog("%s: %d bytes per row, fetch count %d -> %d\n", func, (int) row_bytes, self->fetch_count, count);
+	self->fetch_count = count;
+}
+
 /*	This function is called by fetch_tuples() AND SQLFetch() */
 int
 QR_next_tuple(QResultClass *self, StatementClass *stmt)
@@ -884,9 +1075,10 @@ QR_next_tuple(QResultClass *self, StatementClass *stmt)
 	SQLLEN		fetch_number = self->fetch_number, cur_fetch = 0;
 	SQLLEN		num_total_rows;
 	SQLLEN		num_backend_rows = self->num_cached_rows, num_rows_in;
-	Int4		num_fields = self->num_fields, fetch_size, req_size;
+	Int4		num_fields = self->num_fields, fetch_size, req_size, requested;
 	SQLLEN		offset = 0, end_tuple;
 	char		boundary_adjusted = FALSE;
+	UInt4		fetch_start, fetch_usec = 0;
 	TupleField *the_tuples = self->backend_tuples;
 	QResultClass	*res;
 
@@ -1070,6 +1262,8 @@ inolog("back_offset=%d and move_offset=%d\n", back_offset, self->move_offset);
 inolog("tupleField=%p\n", self->tupleField);
 		/* move to next row */
 		QR_inc_next_in_cache(self);
+		if (fetch_ahead_wanted(self, stmt))
+			QR_send_fetch_ahead(self, optimum_fetch_size(self, &(conn->connInfo)));
 		RETURN(TRUE)
 	}
 	else if (QR_once_reached_eof(self))
@@ -1107,24 +1301,13 @@ inolog("tupleField=%p\n", self->tupleField);
 	if (QR_get_rowstart_in_cache(self) >= num_backend_rows ||
 		QR_is_moving(self))
 	{
-		TupleField *tuple = self->backend_tuples;
-
 		/* not a correction */
-		/* Determine the optimum cache size.  */
-		if (ci->drivers.fetch_max % req_size == 0)
-			fetch_size = ci->drivers.fetch_max;
-		else if ((Int4)req_size < ci->drivers.fetch_max)
-		{
-			/*fetch_size = (ci->drivers.fetch_max / req_size + 1) * req_size;*/
-			fetch_size = (ci->drivers.fetch_max / req_size) * req_size;
-		}
-		else
-			fetch_size = req_size;
+		fetch_size = optimum_fetch_size(self, ci);
 
 		self->cache_size = fetch_size;
 		/* clear obsolete tuples */
 inolog("clear obsolete %d tuples\n", num_backend_rows);
-		ClearCachedRows(tuple, num_fields, num_backend_rows);
+		QR_clear_cached_rows(self, num_backend_rows);
 		self->dataFilled = FALSE;
 		QR_stop_movement(self);
 		self->move_offset = 0;
@@ -1145,6 +1328,8 @@ inolog("clear obsolete %d tuples\n", num_backend_rows);
 			RETURN(-1)
 		}
 		/* and enlarge the cache size */
+		if (self->cache_size < num_backend_rows) /* the rows fetched ahead were appended */
+			self->cache_size = num_backend_rows;
 		self->cache_size += fetch_size;
 		offset = self->fetch_number;
 		QR_inc_next_in_cache(self);
@@ -1154,26 +1339,70 @@ inolog("clear obsolete %d tuples\n", num_backend_rows);
 	if (enlargeKeyCache(self, self->cache_size - num_backend_rows, "Out of memory while reading tuples") < 0)
 		RETURN(FALSE)
 
-	/* Send a FETCH command to get more rows */
-	snprintf(fetch, sizeof(fetch),
-			 "fetch %d in \"%s\"",
-			 fetch_size, QR_get_cursor(self));
-
-	mylog("%s: sending actual fetch (%d) query '%s'\n", func, fetch_size, fetch);
 	if (!boundary_adjusted)
 		QR_set_num_cached_rows(self, 0);
 
-	/* don't read ahead for the next tuple (self) ! */
-	qi.row_size = self->cache_size;
-	qi.result_in = self;
-	qi.cursor = NULL;
-	res = CC_send_query(conn, fetch, &qi, 0, stmt);
-	if (!QR_command_maybe_successful(res))
+	requested = fetch_size;
+	if (QR_has_fetch_ahead(self))
 	{
-		if (!QR_get_message(self))
-			QR_set_message(self, "Error fetching next group.");
-		RETURN(FALSE)
+		Int4	ahead_size = self->fetch_ahead_size;
+		SQLLEN	num_ahead;
+
+		/* The FETCH was sent ahead, use its rows first */
+		mylog("%s: using the rows fetched ahead (%d)\n", func, ahead_size);
+		if (num_ahead = QR_read_fetch_ahead(self), num_ahead < 0)
+		{
+			if (!QR_get_message(self))
+				QR_set_message(self, "Error fetching next group.");
+			RETURN(FALSE)
+		}
+		QR_set_next_in_cache(self, 0);
+		QR_set_rowstart_in_cache(self, 0);
+		self->key_base = 0;
+		fetch_size -= (Int4) num_ahead;
+		if (fetch_size < 0)
+		{
+			/* more rows than required */
+			self->cache_size -= fetch_size;
+			fetch_size = 0;
+		}
+		else if (num_ahead < ahead_size)
+			fetch_size = 0;	/* no more rows */
+	}
+
+	if (fetch_size > 0)
+	{
+		/* Send a FETCH command to get more rows */
+		snprintf(fetch, sizeof(fetch),
+				 "fetch %d in \"%s\"",
+				 fetch_size, QR_get_cursor(self));
+
+		mylog("%s: sending actual fetch (%d) query '%s'\n", func, fetch_size, fetch);
+		if (enlargeKeyCache(self, fetch_size, "Out of memory while reading tuples") < 0)
+			RETURN(FALSE)
+
+		/* don't read ahead for the next tuple (self) ! */
+		qi.row_size = self->cache_size;
+		qi.result_in = self;
+		qi.cursor = NULL;
+		fetch_start = get_usec_clock();
+		res = CC_send_query(conn, fetch, &qi, 0, stmt);
+		if (!QR_command_maybe_successful(res))
+		{
+			if (!QR_get_message(self))
+				QR_set_message(self, "Error fetching next group.");
+			RETURN(FALSE)
+		}
+		/* Only a whole FETCH tells the time of the round trip */
+		if (fetch_size == requested)
+		{
+			fetch_usec = get_usec_clock() - fetch_start;
+			if (0 == fetch_usec)
+				fetch_usec = 1;
+		}
 	}
+	if (!boundary_adjusted)
+		adapt_fetch_count(self, ci, requested, fetch_usec);
 	internally_invoked = TRUE;
 	cur_fetch = 0;
 
@@ -1312,6 +1541,8 @@ inolog("will add %d added_tuples from %d and select the %dth added tuple\n", add
 /*inolog("keyset[%d].status=%x\n", i, self->keyset[i].status);*/
 		}
 	}
+	if (ret > 0 && !boundary_adjusted && fetch_ahead_wanted(self, stmt))
+		QR_send_fetch_ahead(self, optimum_fetch_size(self, ci));
 
 cleanup:
 	LEAVE_CONN_CS(conn);
@@ -1321,15 +1552,284 @@ inolog("%s returning %d offset=%d\n", func, ret, offset);
 	return ret;
 }
 
+/*
+ * Release the first 'num_rows' cached rows of a streamed result, which
+ * the application has already fetched. The values of the following rows
+ * which are in the arena or the pgresults are copied into a new arena
+ * so that the old blocks can be freed.
+ */
+static BOOL
+QR_release_head_rows(QResultClass *self, SQLLEN num_rows)
+{
+	int		num_fields = self->num_fields;
+	SQLLEN		num_kept = self->num_cached_rows - num_rows;
+	SQLLEN		num_borrowed = self->num_borrowed_rows;
+	SQLLEN		num_kept_borrowed = (num_borrowed > num_rows ? num_borrowed - num_rows : 0);
+	SQLLEN		i, num_values = num_kept_borrowed * num_fields;
+	struct ArenaBlock_	*arena = self->arena, *next;
+	TupleField	*tuple;
+	size_t		len = 0;
+	char	   *buffer = NULL;
+
+	tuple = self->backend_tuples + num_fields * num_rows;
+	for (i = 0; i < num_values; i++)
+	{
+		if (tuple[i].value)
+			len += tuple[i].len + 1;
+	}
+	self->arena = NULL;
+	if (len > 0 &&
+		(buffer = QR_arena_alloc(self, len), NULL == buffer))
+	{
+		self->arena = arena;
+		QR_set_rstatus(self, PORES_NO_MEMORY_ERROR);
+		QR_set_messageref(self, "Out of memory while releasing the fetched rows.");
+		return FALSE;
+	}
+	for (i = 0; i < num_values; i++)
+	{
+		if (NULL == tuple[i].value)
+			continue;
+		memcpy(buffer, tuple[i].value, tuple[i].len + 1);
+		tuple[i].value = buffer;
+		buffer += tuple[i].len + 1;
+	}
+	if (num_rows > num_borrowed)
+		ClearCachedRows(self->backend_tuples + num_fields * num_borrowed, num_fields, num_rows - num_borrowed);
+	memmove(self->backend_tuples, tuple, sizeof(TupleField) * num_fields * num_kept);
+	for (; arena; arena = next)
+	{
+		next = arena->next;
+		free(arena);
+	}
+	for (i = 0; i < (SQLLEN) self->num_pgresults; i++)
+		PQclear(self->pgresults[i]);
+	if (self->pgresults)
+	{
+		free(self->pgresults);
+		self->pgresults = NULL;
+	}
+	self->num_pgresults = 0;
+	self->num_borrowed_rows = num_kept_borrowed;
+	self->num_cached_rows = num_kept;
+	self->stream_base += num_rows;
+	QR_set_rowstart_in_cache(self, QR_get_rowstart_in_cache(self) - num_rows);
+
+	return TRUE;
+}
+
+/*
+ * Finish reading a streamed result. 'pgres' is its last PGresult if any.
+ * What's left on the connection, e.g. the rows of a closed result, is
+ * discarded.
+ */
+static void
+QR_end_stream(QResultClass *self, PGresult *pgres)
+{
+	ConnectionClass	*conn = QR_get_conn(self);
+
+	QR_set_no_streaming(self);
+	if (pgres)
+	{
+		if (PGRES_TUPLES_OK == PQresultStatus(pgres))
+			QR_set_command(self, PQcmdStatus(pgres));
+		if (0 == self->num_pgresults ||
+			self->pgresults[self->num_pgresults - 1] != pgres)
+			PQclear(pgres);
+	}
+	if (NULL == conn)
+		return;
+	while (conn->pqconn && (pgres = PQgetResult(conn->pqconn)) != NULL)
+		PQclear(pgres);
+	if (conn->stream_res == self)
+		conn->stream_res = NULL;
+	LIBPQ_update_transaction_status(conn);
+}
+
+/*
+ * Read the next rows of a result streamed with BIT_STREAM_RESULTS.
+ * The cached rows before the current rowset are released first. If
+ * 'all' is TRUE, all the remaining rows are read so that the connection
+ * can be used for another query.
+ */
+BOOL
+QR_read_stream(QResultClass *self, BOOL all)
+{
+	CSTR	func = "QR_read_stream";
+	ConnectionClass	*conn = QR_get_conn(self);
+	PGresult   *pgres = NULL;
+	SQLLEN		num_release = 0;
+	BOOL		ret = TRUE;
+
+	if (!QR_is_streaming(self) || NULL == conn)
+		return TRUE;
+	ENTER_CONN_CS(conn);
+	if (QR_has_valid_base(self))
+	{
+		num_release = QR_get_rowstart_in_cache(self);
+		if (num_release > (SQLLEN) self->num_cached_rows)
+			num_release = self->num_cached_rows;
+	}
+	mylog("%s: release %d of %d rows all=%d\n", func, num_release, self->num_cached_rows, all);
+	if (num_release > 0)
+		ret = QR_release_head_rows(self, num_release);
+	if (ret)
+	{
+		QR_set_cache_size(self, self->num_cached_rows + conn->connInfo.drivers.fetch_max);
+		if (all)
+			QR_set_no_streaming(self);
+		if (conn->pqconn)
+			pgres = PQgetResult(conn->pqconn);
+		if (NULL == pgres)
+			QR_set_no_streaming(self);
+		else
+			ret = QR_read_tuples_from_pgres(self, &pgres, TRUE);
+	}
+	if (!ret || !QR_is_streaming(self))
+		QR_end_stream(self, pgres);
+	LEAVE_CONN_CS(conn);
+
+	return ret;
+}
+
+/*
+ * With BIT_FETCH_AHEAD, the FETCH of the block following the tuple cache
+ * is sent as soon as the cache is filled, so that the rows are transferred
+ * while the application processes the cached ones. The server's cursor
+ * is then past the rows fetched ahead, which are appended to the cache
+ * when they are needed or before the cursor is moved. Only read-only
+ * results without a keyset qualify.
+ */
+static BOOL
+fetch_ahead_wanted(const QResultClass *self, const StatementClass *stmt)
+{
+	const ConnectionClass	*conn = QR_get_conn(self);
+
+	if (0 == (conn->connInfo.extra_opts & BIT_FETCH_AHEAD))
+		return FALSE;
+	if (NULL == QR_get_cursor(self) ||
+		QR_haskeyset(self) ||
+		QR_once_reached_eof(self) ||
+		self->num_cached_rows < self->cache_size ||
+		QR_has_fetch_ahead(self))
+		return FALSE;
+	if (NULL == stmt ||
+		SQL_CONCUR_READ_ONLY != stmt->options.scroll_concurrency)
+		return FALSE;
+	/* nothing else may be pending on the connection */
+	if (NULL == conn->pqconn ||
+		NULL != conn->fetch_ahead_res ||
+		NULL != conn->stream_res ||
+		NULL != conn->async_stmt ||
+		CC_is_in_error_trans(conn))
+		return FALSE;
+	return TRUE;
+}
+
+/*
+ * Send the FETCH of the next block without waiting for the result.
+ */
+static void
+QR_send_fetch_ahead(QResultClass *self, Int4 fetch_size)
+{
+	CSTR	func = "QR_send_fetch_ahead";
+	ConnectionClass	*conn = QR_get_conn(self);
+	char		fetch[128];
+
+	snprintf(fetch, sizeof(fetch),
+			 "fetch %d in \"%s\"",
+			 fetch_size, QR_get_cursor(self));
+	mylog("%s: sending '%s'\n", func, fetch);
+	qlog("conn=%p, query='%s'\n", conn, fetch);
+	if (!PQsendQuery(conn->pqconn, fetch))
+	{
+		/* the rows will be fetched when they are needed */
+		mylog("%s: %s\n", func, PQerrorMessage(conn->pqconn));
+		return;
+	}
+	conn->fetch_ahead_res = self;
+	self->fetch_ahead_size = fetch_size;
+}
+
+BOOL
+QR_has_fetch_ahead(const QResultClass *self)
+{
+	return (NULL != self->fetch_ahead_pgres ||
+			(NULL != self->conn && self->conn->fetch_ahead_res == self));
+}
+
+/*
+ * Receive the result of the FETCH sent ahead, if it's still pending on
+ * the connection, and keep it until the rows are needed.
+ */
+void
+QR_receive_fetch_ahead(QResultClass *self)
+{
+	ConnectionClass	*conn = QR_get_conn(self);
+	PGresult   *pgres;
+
+	if (NULL == conn || conn->fetch_ahead_res != self)
+		return;
+	conn->fetch_ahead_res = NULL;
+	while (conn->pqconn && (pgres = PQgetResult(conn->pqconn)) != NULL)
+	{
+		if (NULL == self->fetch_ahead_pgres)
+			self->fetch_ahead_pgres = pgres;
+		else
+			PQclear(pgres);
+	}
+	LIBPQ_update_transaction_status(conn);
+}
+
+/*
+ * Append the rows fetched ahead to the tuple cache.
+ * Returns the number of the rows, or -1 on error.
+ */
+SQLLEN
+QR_read_fetch_ahead(QResultClass *self)
+{
+	PGresult   *pgres;
+	SQLLEN		num_rows;
+
+	QR_receive_fetch_ahead(self);
+	if (pgres = self->fetch_ahead_pgres, NULL == pgres)
+	{
+		QR_set_rstatus(self, PORES_BAD_RESPONSE);
+		QR_set_message(self, "Could not receive the rows fetched ahead.");
+		return -1;
+	}
+	self->fetch_ahead_pgres = NULL;
+	num_rows = PQntuples(pgres);
+	mylog("QR_read_fetch_ahead: %d rows after %d cached rows\n", num_rows, self->num_cached_rows);
+	if (enlargeKeyCache(self, num_rows, "Out of memory while reading tuples") < 0)
+		num_rows = -1;
+	else if (!QR_read_tuples_from_pgres(self, &pgres, TRUE))
+		num_rows = -1;
+	else
+		QR_set_command(self, PQcmdStatus(pgres));
+	/* the PGresult is kept until the tuple cache is cleared */
+	if (self->num_pgresults == 0 ||
+		self->pgresults[self->num_pgresults - 1] != pgres)
+		PQclear(pgres);
+	return num_rows;
+}
+
 /*
  * Read tuples from a libpq PGresult object into QResultClass.
  *
  * The result status of the passed-in PGresult should be either
  * PGRES_TUPLES_OK, or PGRES_SINGLE_TUPLE. If it's PGRES_SINGLE_TUPLE,
  * this function will call PQgetResult() to read all the available tuples.
+ *
+ * If 'borrow' is TRUE, the values of a PGRES_TUPLES_OK result aren't
+ * copied. The tuple fields point into the PGresult, which is appended
+ * to self->pgresults and released with the tuple cache. A PGresult per
+ * row would cost more than the copy, so the values of single row results
+ * are copied into the arena of the result. Rows following ones whose
+ * values were malloc'ed are malloc'ed as well.
  */
 static BOOL
-QR_read_tuples_from_pgres(QResultClass *self, PGresult **pgres)
+QR_read_tuples_from_pgres(QResultClass *self, PGresult **pgres, BOOL borrow)
 {
 	Int2		field_lf;
 	int			len;
@@ -1343,6 +1843,7 @@ QR_read_tuples_from_pgres(QResultClass *self, PGresult **pgres)
 	int			rowno;
 	int			nrows;
 	int			resStatus;
+	BOOL		borrowed, in_arena;
 
 	/* set the current row to read the fields into */
 	effective_cols = QR_NumPublicResultCols(self);
@@ -1367,6 +1868,39 @@ nextrow:
 	}
 
 	nrows = PQntuples(*pgres);
+	borrowed = in_arena = FALSE;
+	if (borrow &&
+		nrows > 0 &&
+		num_fields > 0 &&
+		self->num_borrowed_rows == self->num_cached_rows)
+	{
+		if (PGRES_TUPLES_OK == resStatus)
+		{
+			PGresult	**pgresults;
+
+			pgresults = (PGresult **) realloc(self->pgresults, sizeof(PGresult *) * (self->num_pgresults + 1));
+			if (pgresults)
+			{
+				self->pgresults = pgresults;
+				borrowed = TRUE;
+			}
+		}
+		else
+			in_arena = TRUE;
+	}
+	/* All the rows are here, so make room for them at once */
+	if (PGRES_TUPLES_OK == resStatus &&
+		num_fields > 0 &&
+		!QR_get_cursor(self) &&
+		self->num_cached_rows + nrows > self->count_backend_allocated)
+	{
+		SQLLEN	tuple_size = self->num_cached_rows + nrows;
+
+		if (tuple_size < TUPLE_MALLOC_INC)
+			tuple_size = TUPLE_MALLOC_INC;
+		QR_REALLOC_return_with_error(self->backend_tuples, TupleField, tuple_size * num_fields * sizeof(TupleField), self, "Out of memory while reading tuples.", FALSE);
+		self->count_backend_allocated = tuple_size;
+	}
 
 	for (rowno = 0; rowno < nrows; rowno++)
 	{
@@ -1400,14 +1934,31 @@ nextrow:
 			{
 				len = PQgetlength(*pgres, rowno, field_lf);
 				value = PQgetvalue(*pgres, rowno, field_lf);
-				if (field_lf >= effective_cols)
-					buffer = tidoidbuf;
+				if (borrowed)
+					buffer = value;
+				else if (in_arena)
+				{
+					if (buffer = QR_arena_alloc(self, len + 1), NULL == buffer)
+					{
+						QR_set_rstatus(self, PORES_NO_MEMORY_ERROR);
+						QR_free_memory(self);
+						QR_set_messageref(self, "Out of memory in allocating item buffer.");
+						return FALSE;
+					}
+					memcpy(buffer, value, len);
+					buffer[len] = '\0';
+				}
 				else
 				{
-					QR_MALLOC_return_with_error(buffer, char, len + 1, self, "Out of memory in allocating item buffer.", FALSE);
+					if (field_lf >= effective_cols)
+						buffer = tidoidbuf;
+					else
+					{
+						QR_MALLOC_return_with_error(buffer, char, len + 1, self, "Out of memory in allocating item buffer.", FALSE);
+					}
+					memcpy(buffer, value, len);
+					buffer[len] = '\0';
 				}
-				memcpy(buffer, value, len);
-				buffer[len] = '\0';
 
 				mylog("qresult: len=%d, buffer='%s'\n", len, buffer);
 
@@ -1459,14 +2010,27 @@ nextrow:
 			self->num_total_read = self->cursTuple + 1;
 	}
 
+	if (borrowed)
+		self->pgresults[self->num_pgresults++] = *pgres;
+	if (borrowed || in_arena)
+		self->num_borrowed_rows = self->num_cached_rows;
+
 	if (resStatus == PGRES_SINGLE_TUPLE)
 	{
 		/* Process next row */
 		PQclear(*pgres);
+		*pgres = NULL;
 
-		*pgres = PQgetResult(self->conn->pqconn);
-		goto nextrow;
+		/* leave the rest of a streamed result on the connection */
+		if (!QR_is_streaming(self) ||
+			self->num_cached_rows < self->cache_size)
+		{
+			*pgres = PQgetResult(self->conn->pqconn);
+			goto nextrow;
+		}
 	}
+	else
+		QR_set_no_streaming(self);
 
 	self->dataFilled = TRUE;
 	self->tupleField = self->backend_tuples + (self->fetch_number * self->num_fields);
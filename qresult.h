@@ -48,6 +48,7 @@ enum
 	FQR_REACHED_EOF = (1L << 1)	/* reached eof */
 	,FQR_HAS_VALID_BASE = (1L << 2)
 	,FQR_NEEDS_SURVIVAL_CHECK = (1L << 3) /* check if the cursor is open */
+	,FQR_STREAMING = (1L << 4) /* rows are still pending on the connection */
 };
 
 struct QResultClass_
@@ -65,6 +66,7 @@ struct QResultClass_
 	SQLLEN		cursTuple;	/* absolute current position in the servr's cursor used to retrieve tuples from the DB */
 	SQLULEN		move_offset;
 	SQLLEN		base;		/* relative position of rowset start in the current data cache(backend_tuples) */
+	SQLLEN		stream_base;	/* absolute position of the first cached row of a streamed result */
 
 	UInt2		num_fields;	/* number of fields in the result */
 	UInt2		num_key_fields;	/* number of key fields in the result */
@@ -83,6 +85,17 @@ struct QResultClass_
 
 	TupleField *backend_tuples;	/* data from the backend (the tuple cache) */
 	TupleField *tupleField;		/* current backend tuple being retrieved */
+	PGresult	**pgresults;	/* PGresults kept for the tuple cache */
+	UInt4		num_pgresults;	/* count of kept PGresults */
+	struct ArenaBlock_	*arena;	/* blocks the single row values are copied into */
+	SQLULEN		num_borrowed_rows;	/* count of the leading cached rows
+						 * whose values are in pgresults or
+						 * arena instead of malloc'ed one by one */
+	PGresult	*fetch_ahead_pgres;	/* the rows fetched ahead */
+	Int4		fetch_ahead_size;	/* the size of the FETCH sent ahead */
+	Int4		fetch_count;	/* the FETCH count adapted to FetchCacheBytes,
+					 * 0 if not adapted yet */
+	double		usec_per_row;	/* time per row of the last timed FETCH */
 
 	char	pstatus;		/* processing status */
 	char	aborted;		/* was aborted ? */
@@ -93,7 +106,7 @@ struct QResultClass_
 	SQLULEN		num_cached_keys;	/* count of keys kept in backend_keys member */
 	KeySet		*keyset;
 	SQLLEN		key_base;	/* relative position of rowset start in the current keyset cache */
-	UInt2		reload_count;
+	UInt2		reload_count;	/* > 0 if the "_KEYSET_xxxx" plan is prepared */
 	UInt2		rb_alloc;	/* count of allocated rollback info */
 	UInt2		rb_count;	/* count of rollback info */
 	char		dataFilled;	/* Cache is filled with data ? */
@@ -141,6 +154,7 @@ enum {
 #define QR_get_display_size(self, fieldno_) (CI_get_display_size(self->fields, fieldno_))
 #define QR_get_atttypmod(self, fieldno_)	(CI_get_atttypmod(self->fields, fieldno_))
 #define QR_get_field_type(self, fieldno_)	(CI_get_oid(self->fields, fieldno_))
+#define QR_get_format(self, fieldno_)	(CI_get_format(self->fields, fieldno_))
 #define QR_get_relid(self, fieldno_)	(CI_get_relid(self->fields, fieldno_))
 #define QR_get_attid(self, fieldno_)	(CI_get_attid(self->fields, fieldno_))
 
@@ -170,6 +184,8 @@ enum {
 #define QR_set_no_valid_base(self)	(self->pstatus &= ~FQR_HAS_VALID_BASE)
 #define QR_set_survival_check(self)	(self->pstatus |= FQR_NEEDS_SURVIVAL_CHECK)
 #define QR_set_no_survival_check(self)	(self->pstatus &= ~FQR_NEEDS_SURVIVAL_CHECK)
+#define QR_set_streaming(self)		(self->pstatus |= FQR_STREAMING)
+#define QR_set_no_streaming(self)	(self->pstatus &= ~FQR_STREAMING)
 #define	QR_inc_num_cache(self) \
 do { \
 	self->num_cached_rows++; \
@@ -199,6 +215,7 @@ do { \
 #define QR_once_reached_eof(self)	((self->pstatus & FQR_REACHED_EOF) != 0)
 #define	QR_has_valid_base(self)		(0 != (self->pstatus & FQR_HAS_VALID_BASE))
 #define	QR_needs_survival_check(self)		(0 != (self->pstatus & FQR_NEEDS_SURVIVAL_CHECK))
+#define	QR_is_streaming(self)		(0 != (self->pstatus & FQR_STREAMING))
 
 #define QR_aborted(self)		(!self || self->aborted)
 #define QR_get_reqsize(self)		(self->rowset_size_include_ommitted)
@@ -219,6 +236,10 @@ QResultClass	*QR_Constructor(void);
 void		QR_Destructor(QResultClass *self);
 TupleField	*QR_AddNew(QResultClass *self);
 int		QR_next_tuple(QResultClass *self, StatementClass *);
+BOOL		QR_read_stream(QResultClass *self, BOOL all);
+BOOL		QR_has_fetch_ahead(const QResultClass *self);
+void		QR_receive_fetch_ahead(QResultClass *self);
+SQLLEN		QR_read_fetch_ahead(QResultClass *self);
 int			QR_close(QResultClass *self);
 void		QR_on_close_cursor(QResultClass *self);
 void		QR_close_result(QResultClass *self, BOOL destroy);
@@ -76,7 +76,7 @@ PGAPI_RowCount(HSTMT hstmt,
 		}
 		else if (QR_NumResultCols(res) > 0)
 		{
-			*pcrow = QR_get_cursor(res) ? -1 : QR_get_num_total_tuples(res) - res->dl_count;
+			*pcrow = (QR_get_cursor(res) || QR_is_streaming(res)) ? -1 : QR_get_num_total_tuples(res) - res->dl_count;
 			mylog("RowCount=%d\n", *pcrow);
 			return SQL_SUCCESS;
 		}
@@ -1043,7 +1043,11 @@ inolog("currT=%d base=%d rowset=%d\n", stmt->currTuple, QR_get_rowstart_in_cache
 
 	SC_set_current_col(stmt, icol);
 
-	result = copy_and_convert_field(stmt, field_type, atttypmod, value,
+	if (0 != QR_get_format(res, icol))
+		result = copy_and_convert_binary_field(stmt, field_type, atttypmod, value,
+			target_type, precision, rgbValue, cbValueMax, pcbValue, pcbValue);
+	else
+		result = copy_and_convert_field(stmt, field_type, atttypmod, value,
 			target_type, precision, rgbValue, cbValueMax, pcbValue, pcbValue);
 
 	switch (result)
@@ -1280,7 +1284,10 @@ inolog(" nearest not found\n");
 	return -(SQLLEN)count;
 }
 
-static void
+/*
+ * Returns FALSE if the rows fetched ahead couldn't be read.
+ */
+static BOOL
 move_cursor_position_if_needed(StatementClass *self, QResultClass *res)
 {
 	SQLLEN	move_offset;
@@ -1293,7 +1300,23 @@ move_cursor_position_if_needed(StatementClass *self, QResultClass *res)
 	{
 		QR_stop_movement(res); /* for safety */
 		res->move_offset = 0;
-		return;
+		return TRUE;
+	}
+	if (QR_has_fetch_ahead(res) &&
+	    (QR_is_moving_from_the_last(res) ||
+	     QR_get_rowstart_in_cache(res) < 0 ||
+	     QR_get_rowstart_in_cache(res) > (SQLLEN) res->num_cached_rows))
+	{
+		/*
+		 * The server's cursor is past the rows fetched ahead
+		 * (BIT_FETCH_AHEAD), so append them to the cache before
+		 * calculating the movement.
+		 */
+		if (QR_read_fetch_ahead(res) < 0)
+		{
+			mylog("reading the rows fetched ahead failed\n");
+			return FALSE;
+		}
 	}
 inolog("BASE=%d numb=%d curr=%d cursT=%d\n", QR_get_rowstart_in_cache(res), res->num_cached_rows, self->currTuple, res->cursTuple);
 
@@ -1309,7 +1332,7 @@ else
 {
 inolog("!!move_offset=%d calc=%d\n", res->move_offset, INT_MAX - self->rowset_start);
 }
-		return;
+		return TRUE;
 	}
 
 	/* normal case */
@@ -1319,10 +1342,10 @@ inolog("!!move_offset=%d calc=%d\n", res->move_offset, INT_MAX - self->rowset_st
 	     QR_get_rowstart_in_cache(res) <= res->num_cached_rows)
 	{
 		QR_set_next_in_cache(res, (QR_get_rowstart_in_cache(res) < 0) ? 0 : QR_get_rowstart_in_cache(res));
-		return;
+		return TRUE;
 	}
 	if (0 == move_offset)
-		return;
+		return TRUE;
 	if (move_offset > 0)
 	{
 		QR_set_move_forward(res);
@@ -1333,6 +1356,7 @@ inolog("!!move_offset=%d calc=%d\n", res->move_offset, INT_MAX - self->rowset_st
 		QR_set_move_backward(res);
 		res->move_offset = -move_offset;
 	}
+	return TRUE;
 }
 /*
  *	return NO_DATA_FOUND macros
@@ -1451,6 +1475,8 @@ PGAPI_ExtendedFetch(HSTMT hstmt,
 	reached_eof = QR_once_reached_eof(res) && QR_get_cursor(res);
 	if (useCursor && !reached_eof)
 		num_tuples = INT_MAX;
+	else if (QR_is_streaming(res))
+		num_tuples = INT_MAX;
 
 inolog("num_tuples=%d\n", num_tuples);
 	/* Save and discard the saved rowset size */
@@ -1715,10 +1741,15 @@ inolog("num_tuples=%d\n", num_tuples);
 	if (SC_is_fetchcursor(stmt) ||
 	    SQL_CURSOR_KEYSET_DRIVEN == stmt->options.cursor_type)
 	{
-		move_cursor_position_if_needed(stmt, res);
+		if (!move_cursor_position_if_needed(stmt, res))
+		{
+			result = SQL_ERROR;
+			SC_set_error(stmt, STMT_EXEC_ERROR, NULL != QR_get_message(res) ? QR_get_message(res) : "Error fetching next row", func);
+			goto cleanup;
+		}
 	}
 	else
-		QR_set_rowstart_in_cache(res, SC_get_rowset_start(stmt));
+		QR_set_rowstart_in_cache(res, SC_get_rowset_start(stmt) - res->stream_base);
 
 	if (res->keyset && !QR_get_cursor(res))
 	{
@@ -1749,6 +1780,16 @@ inolog("num_tuples=%d\n", num_tuples);
 
 	currp = -1;
 	stmt->bind_row = 0;		/* set the binding location */
+	/*
+	 * With column-wise binding, SC_fetch() only positions the rows and
+	 * the rowset is converted column by column at the end.
+	 */
+	stmt->columnwise_fetch = (rowsetSize > 1 &&
+		0 == opts->bind_size &&
+		!useCursor &&
+		NULL == res->keyset &&
+		!QR_is_streaming(res) &&
+		SQL_RD_ON == stmt->options.retrieve_data);
 	result = SC_fetch(stmt);
 	if (SQL_ERROR == result)
 		goto cleanup;
@@ -1829,6 +1870,27 @@ inolog("just skipping deleted row %d\n", currp);
 	}
 	if (SQL_ERROR == result)
 		goto cleanup;
+	if (stmt->columnwise_fetch && i > 0)
+	{
+		SQLLEN	error_row, row;
+		RETCODE	ret = SC_fetch_columnwise(stmt, i, &error_row);
+
+		if (SQL_ERROR == ret)
+		{
+			/* The rows after the failing one are not fetched */
+			if (rgfRowStatus)
+			{
+				rgfRowStatus[error_row] = SQL_ROW_ERROR;
+				for (row = error_row + 1; row < i; row++)
+					rgfRowStatus[row] = SQL_ROW_NOROW;
+			}
+			i = fc_io = error_row + 1;
+			stmt->diag_row_number = i;
+			error = TRUE;
+		}
+		else if (SQL_SUCCESS_WITH_INFO == ret)
+			truncated = TRUE;
+	}
 
 	/* Save the fetch count for SQLSetPos */
 	stmt->last_fetch_count = i;
@@ -1868,6 +1930,7 @@ inolog("pcrow=%d\n", i);
 
 cleanup:
 #undef	return
+	stmt->columnwise_fetch = FALSE;
 	if (stmt->internal)
 		result = DiscardStatementSvp(stmt, result, FALSE);
 	return result;
@@ -3034,186 +3097,153 @@ SC_pos_reload(StatementClass *stmt, SQLULEN global_ridx, UInt2 *count, Int4 logK
 }
 
 static	const int	pre_fetch_count = 32;
-static SQLLEN LoadFromKeyset(StatementClass *stmt, QResultClass * res, int rows_per_fetch, SQLLEN limitrow)
+
+/*
+ *	A hash of the tids of the rows to reload, to map the reloaded
+ *	rows back to their positions in the keyset.
+ */
+typedef struct
+{
+	UInt4	blocknum;
+	UInt2	offset;
+	SQLLEN	gidx;	/* -1 if the slot is empty */
+} TidSlot;
+
+static UInt4 tid_hash(UInt4 blocknum, UInt2 offset)
+{
+	return blocknum * 0x9e3779b1U + offset;
+}
+
+static void tid_hash_insert(TidSlot *slots, UInt4 mask, UInt4 blocknum, UInt2 offset, SQLLEN gidx)
+{
+	UInt4	h;
+
+	for (h = tid_hash(blocknum, offset) & mask; slots[h].gidx >= 0; h = (h + 1) & mask)
+		;
+	slots[h].blocknum = blocknum;
+	slots[h].offset = offset;
+	slots[h].gidx = gidx;
+}
+
+static SQLLEN tid_hash_lookup(const TidSlot *slots, UInt4 mask, UInt4 blocknum, UInt2 offset)
+{
+	UInt4	h;
+
+	for (h = tid_hash(blocknum, offset) & mask; slots[h].gidx >= 0; h = (h + 1) & mask)
+	{
+		if (slots[h].blocknum == blocknum && slots[h].offset == offset)
+			return slots[h].gidx;
+	}
+	return -1;
+}
+
+/*
+ *	Reload the rows of the rowset which need rereading.
+ *	The tids of all of them are sent as one tid[] parameter of the
+ *	"_KEYSET_xxxx" plan, so it costs a single round trip.
+ */
+static SQLLEN LoadFromKeyset(StatementClass *stmt, QResultClass * res, SQLLEN limitrow)
 {
 	CSTR	func = "LoadFromKeyset";
 	ConnectionClass	*conn = SC_get_conn(stmt);
-	SQLLEN	i;
-	int	j, rowc, rcnt = 0;
-	OID	oid;
-	UInt4	blocknum;
-	SQLLEN	kres_ridx;
+	SQLLEN	i, kres_ridx, rcnt = 0, rowc;
+	UInt4	blocknum, mask, nslots;
 	UInt2	offset;
-	char	*qval = NULL, *sval = NULL;
-	int	keys_per_fetch = 10;
+	char	*qval = NULL, *sval;
+	char	planname[32];
+	TidSlot	*slots = NULL;
+	QResultClass	*qres;
 
-	for (i = SC_get_rowset_start(stmt), kres_ridx = GIdx2KResIdx(i, stmt, res), rowc = 0;; i++)
+	for (i = SC_get_rowset_start(stmt), kres_ridx = GIdx2KResIdx(i, stmt, res); i < limitrow; i++, kres_ridx++)
 	{
-		if (i >= limitrow)
-		{
-			if (!rowc)
-				break;
-			if (res->reload_count > 0)
-			{
-				for (j = rowc; j < keys_per_fetch; j++)
-				{
-					if (j)
-						strcpy(sval, ",NULL");
-					else
-						strcpy(sval, "NULL");
-					sval = strchr(sval, '\0');
-				}
-			}
-			rowc = -1; /* end of loop */
-		}
-		if (rowc < 0 || rowc >= keys_per_fetch)
-		{
-			QResultClass	*qres;
+		if (0 != (res->keyset[kres_ridx].status & CURS_NEEDS_REREAD))
+			rcnt++;
+	}
+	if (0 == rcnt)
+		return 0;
 
-			strcpy(sval, ")");
-			qres = CC_send_query(conn, qval, NULL, CREATE_KEYSET, stmt);
-			if (QR_command_maybe_successful(qres))
-			{
-				SQLLEN		j, k, l;
-				Int2		m;
-				TupleField	*tuple, *tuplew;
+	sprintf(planname, "_KEYSET_%p", res);
+	if (res->reload_count <= 0)
+	{
+		size_t	allen = 8 + strlen(planname) + 12 + strlen(stmt->load_statement) + 25;
 
-				for (j = 0; j < QR_get_num_total_read(qres); j++)
-				{
-					oid = getOid(qres, j);
-					getTid(qres, j, &blocknum, &offset);
-					for (k = SC_get_rowset_start(stmt); k < limitrow; k++)
-					{
-						if (oid == getOid(res, k))
-						{
-							l = GIdx2CacheIdx(k, stmt, res);
-							tuple = res->backend_tuples + res->num_fields * l;
-							tuplew = qres->backend_tuples + qres->num_fields * j;
-							for (m = 0; m < res->num_fields; m++, tuple++, tuplew++)
-							{
-								if (tuple->len > 0 && tuple->value)
-									free(tuple->value);
-								tuple->value = tuplew->value;
-								tuple->len = tuplew->len;
-								tuplew->value = NULL;
-								tuplew->len = -1;
-							}
-							res->keyset[k].status &= ~CURS_NEEDS_REREAD;
-							break;
-						}
-					}
-				}
-			}
-			else
-			{
-				SC_set_error(stmt, STMT_EXEC_ERROR, "Data Load Error", func);
-				rcnt = -1;
-				QR_Destructor(qres);
-				break;
-			}
+		SC_MALLOC_return_with_error(qval, char, allen,
+			stmt, "Couldn't alloc qval", -1);
+		snprintf(qval, allen, "PREPARE \"%s\"(tid[]) as %s where ctid = ANY($1)", planname, stmt->load_statement);
+		qres = CC_send_query(conn, qval, NULL, 0, stmt);
+		free(qval);
+		qval = NULL;
+		if (!QR_command_maybe_successful(qres))
+		{
+			SC_set_error(stmt, STMT_EXEC_ERROR, "Prepare for Data Load Error", func);
 			QR_Destructor(qres);
-			if (rowc < 0)
-				break;
-			rowc = 0;
+			return -1;
 		}
-		if (!rowc)
-		{
-			size_t lodlen = 0;
-
-			if (!qval)
-			{
-				size_t	allen;
+		QR_Destructor(qres);
+		res->reload_count = 1;	/* prepared */
+	}
 
-				if (res->reload_count > 0)
-					keys_per_fetch = res->reload_count;
-				else
-				{
-					char	planname[32];
-					int	j;
-					QResultClass	*qres;
+	for (nslots = 16; nslots < rcnt * 2; nslots *= 2)
+		;
+	mask = nslots - 1;
+	SC_MALLOC_return_with_error(slots, TidSlot, sizeof(TidSlot) * nslots,
+		stmt, "Couldn't alloc the tid hash", -1);
+	for (i = 0; i < (SQLLEN) nslots; i++)
+		slots[i].gidx = -1;
+	if (qval = malloc(16 + strlen(planname) + 26 * rcnt), NULL == qval)
+	{
+		SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "Couldn't alloc qval", func);
+		free(slots);
+		return -1;
+	}
+	sprintf(qval, "EXECUTE \"%s\"('{", planname);
+	sval = strchr(qval, '\0');
+	for (rowc = 0, i = SC_get_rowset_start(stmt), kres_ridx = GIdx2KResIdx(i, stmt, res); i < limitrow; i++, kres_ridx++)
+	{
+		if (0 == (res->keyset[kres_ridx].status & CURS_NEEDS_REREAD))
+			continue;
+		getTid(res, kres_ridx, &blocknum, &offset);
+		tid_hash_insert(slots, mask, blocknum, offset, i);
+		sprintf(sval, "%s\"(%u,%u)\"", rowc++ ? "," : "", blocknum, offset);
+		sval = strchr(sval, '\0');
+	}
+	strcpy(sval, "}')");
 
-					if (rows_per_fetch >= pre_fetch_count * 2)
-						keys_per_fetch = pre_fetch_count;
-					else
-						keys_per_fetch = rows_per_fetch;
-					if (!keys_per_fetch)
-						keys_per_fetch = 2;
-					lodlen = strlen(stmt->load_statement);
-					sprintf(planname, "_KEYSET_%p", res);
-					allen = 8 + strlen(planname) +
-						3 + 4 * keys_per_fetch + 1
-						+ 1 + 2 + lodlen + 20 +
-						4 * keys_per_fetch + 1;
-					SC_MALLOC_return_with_error(qval, char, allen,
-						stmt, "Couldn't alloc qval", -1);
-					sprintf(qval, "PREPARE \"%s\"", planname);
-					sval = strchr(qval, '\0');
-					for (j = 0; j < keys_per_fetch; j++)
-					{
-						if (j == 0)
-							strcpy(sval, "(tid");
-						else
-							strcpy(sval, ",tid");
-						sval = strchr(sval, '\0');
-					}
-					sprintf(sval, ") as %s where ctid in ", stmt->load_statement);
-					sval = strchr(sval, '\0');
-					for (j = 0; j < keys_per_fetch; j++)
-					{
-						if (j == 0)
-							strcpy(sval, "($1");
-						else
-							sprintf(sval, ",$%d", j + 1);
-						sval = strchr(sval, '\0');
-					}
-					strcpy(sval, ")");
-					qres = CC_send_query(conn, qval, NULL, 0, stmt);
-					if (QR_command_maybe_successful(qres))
-					{
-						res->reload_count = keys_per_fetch;
-					}
-					else
-					{
-						SC_set_error(stmt, STMT_EXEC_ERROR, "Prepare for Data Load Error", func);
-						rcnt = -1;
-						QR_Destructor(qres);
-						break;
-					}
-					QR_Destructor(qres);
-				}
-				allen = 25 + 23 * keys_per_fetch;
+	qres = CC_send_query(conn, qval, NULL, CREATE_KEYSET, stmt);
+	if (QR_command_maybe_successful(qres))
+	{
+		SQLLEN		j, k, l;
+		Int2		m;
+		TupleField	*tuple, *tuplew;
 
-				SC_REALLOC_return_with_error(qval, char, allen,
-					stmt, "Couldn't alloc qval", -1);
-			}
-			if (res->reload_count > 0)
-			{
-				sprintf(qval, "EXECUTE \"_KEYSET_%p\"(", res);
-				sval = qval;
-			}
-			else
+		for (j = 0; j < QR_get_num_total_read(qres); j++)
+		{
+			getTid(qres, j, &blocknum, &offset);
+			if (k = tid_hash_lookup(slots, mask, blocknum, offset), k < 0)
+				continue;
+			l = GIdx2CacheIdx(k, stmt, res);
+			tuple = res->backend_tuples + res->num_fields * l;
+			tuplew = qres->backend_tuples + qres->num_fields * j;
+			for (m = 0; m < res->num_fields; m++, tuple++, tuplew++)
 			{
-				memcpy(qval, stmt->load_statement, lodlen);
-				sval = qval + lodlen;
-				sval[0]= '\0';
-				strcpy(sval, " where ctid in (");
+				if (tuple->len > 0 && tuple->value)
+					free(tuple->value);
+				tuple->value = tuplew->value;
+				tuple->len = tuplew->len;
+				tuplew->value = NULL;
+				tuplew->len = -1;
 			}
-			sval = strchr(sval, '\0');
-		}
-		if (0 != (res->keyset[kres_ridx].status & CURS_NEEDS_REREAD))
-		{
-			getTid(res, i, &blocknum, &offset);
-			if (rowc)
-				sprintf(sval, ",'(%u,%u)'", blocknum, offset);
-			else
-				sprintf(sval, "'(%u,%u)'", blocknum, offset);
-			sval = strchr(sval, '\0');
-			rowc++;
-			rcnt++;
+			res->keyset[GIdx2KResIdx(k, stmt, res)].status &= ~CURS_NEEDS_REREAD;
 		}
 	}
-	if (qval)
-		free(qval);
+	else
+	{
+		SC_set_error(stmt, STMT_EXEC_ERROR, "Data Load Error", func);
+		rcnt = -1;
+	}
+	QR_Destructor(qres);
+	free(qval);
+	free(slots);
 	return rcnt;
 }
 
@@ -3285,7 +3315,7 @@ SC_pos_reload_needed(StatementClass *stmt, SQLULEN req_size, UDWORD flag)
 				res->keyset[kres_ridx].status |= CURS_NEEDS_REREAD;
 		}
 	}
-	if (rowc = LoadFromKeyset(stmt, res, rows_per_fetch, limitrow), rowc < 0)
+	if (rowc = LoadFromKeyset(stmt, res, limitrow), rowc < 0)
 	{
 		return SQL_ERROR;
 	}
@@ -27,6 +27,8 @@
 #include "qresult.h"
 #include "convert.h"
 #include "environ.h"
+#include "lobj.h"
+#include "pgtypes.h"
 #include "loadlib.h"
 
 #include <stdio.h>
@@ -169,7 +171,8 @@ static const struct
 	}
 };
 
-static QResultClass *libpq_bind_and_exec(StatementClass *stmt);
+static QResultClass *libpq_bind_and_exec(StatementClass *stmt, BOOL async);
+static void SC_drop(StatementClass *self, ConnectionClass *conn);
 
 RETCODE		SQL_API
 PGAPI_AllocStmt(HDBC hdbc,
@@ -188,7 +191,8 @@ PGAPI_AllocStmt(HDBC hdbc,
 		return SQL_INVALID_HANDLE;
 	}
 
-	stmt = SC_Constructor(conn);
+	if (stmt = CC_get_pooled_statement(conn), NULL == stmt)
+		stmt = SC_Constructor(conn);
 
 	mylog("**** PGAPI_AllocStmt: hdbc = %p, stmt = %p\n", hdbc, stmt);
 
@@ -290,7 +294,7 @@ PGAPI_FreeStmt(HSTMT hstmt,
 		if (stmt->execute_parent)
 			stmt->execute_parent->execute_delegate = NULL;
 		/* Destroy the statement and free any results, cursors, etc. */
-		SC_Destructor(stmt);
+		SC_drop(stmt, conn);
 	}
 	else if (fOption == SQL_UNBIND)
 		SC_unbind_cols(stmt);
@@ -339,6 +343,7 @@ InitializeStatementOptions(StatementOptions *opt)
 	opt->retrieve_data = SQL_RD_ON;
 	opt->use_bookmarks = SQL_UB_OFF;
 	opt->metadata_id = SQL_FALSE;
+	opt->async_enable = SQL_ASYNC_ENABLE_OFF;
 }
 
 static void SC_clear_parse_status(StatementClass *self, ConnectionClass *conn)
@@ -368,6 +373,104 @@ static void SC_init_parse_method(StatementClass *self)
 		SC_set_parse_forced(self);
 }
 
+/*
+ *	Set every member of a statement to its initial value.
+ *	Called for new statements and for the statements recycled from
+ *	the pool of the connection.
+ */
+static void
+SC_init_members(StatementClass *rv, ConnectionClass *conn)
+{
+	rv->hdbc = conn;
+	rv->conn_slot = -1;
+	rv->next_pooled = NULL;
+	rv->columnwise_fetch = FALSE;
+	rv->phstmt = NULL;
+	rv->result = NULL;
+	rv->curres = NULL;
+	rv->catalog_result = FALSE;
+	rv->prepare = NON_PREPARE_STATEMENT;
+	rv->prepared = NOT_YET_PREPARED;
+	rv->status = STMT_ALLOCATED;
+	rv->internal = FALSE;
+	rv->iflag = 0;
+	rv->plan_name = NULL;
+	rv->transition_status = STMT_TRANSITION_UNALLOCATED;
+	rv->multi_statement = -1; /* unknown */
+	rv->num_params = -1; /* unknown */
+	rv->processed_statements = NULL;
+
+	rv->__error_message = NULL;
+	rv->__error_number = 0;
+	rv->pgerror = NULL;
+
+	rv->statement = NULL;
+	rv->stmt_with_params = NULL;
+	rv->load_statement = NULL;
+	rv->statement_type = STMT_TYPE_UNKNOWN;
+
+	rv->currTuple = -1;
+	rv->rowset_start = 0;
+	SC_set_rowset_start(rv, -1, FALSE);
+	rv->current_col = -1;
+	rv->bind_row = 0;
+	rv->from_pos = rv->where_pos = -1;
+	rv->last_fetch_count = rv->last_fetch_count_include_ommitted = 0;
+	rv->save_rowset_size = -1;
+
+	rv->data_at_exec = -1;
+	rv->current_exec_param = -1;
+	rv->exec_start_row = -1;
+	rv->exec_end_row = -1;
+	rv->exec_current_row = -1;
+	rv->put_data = FALSE;
+	rv->ref_CC_error = FALSE;
+	rv->lock_CC_for_rb = 0;
+	rv->join_info = 0;
+	rv->curr_param_result = 0;
+	rv->binary_result = FALSE;
+	SC_init_parse_method(rv);
+
+	rv->lobj_fd = -1;
+	rv->lobj_size = 0;
+	rv->lobj_heads = NULL;
+	INIT_NAME(rv->cursor_name);
+
+	/* Parse Stuff */
+	rv->ti = NULL;
+	rv->ntab = 0;
+	rv->num_key_fields = -1; /* unknown */
+	SC_clear_parse_status(rv, conn);
+	rv->proc_return = -1;
+	SC_init_discard_output_params(rv);
+	rv->cancel_info = 0;
+
+	/* Clear Statement Options -- defaults will be set in AllocStmt */
+	memset(&rv->options, 0, sizeof(StatementOptions));
+	InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->ardi),
+			rv, SQL_ATTR_APP_ROW_DESC);
+	InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->apdi),
+			rv, SQL_ATTR_APP_PARAM_DESC);
+	InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->irdi),
+			rv, SQL_ATTR_IMP_ROW_DESC);
+	InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->ipdi),
+			rv, SQL_ATTR_IMP_PARAM_DESC);
+
+	rv->miscinfo = 0;
+	rv->rbonerr = 0;
+	SC_reset_updatable(rv);
+	rv->diag_row_count = 0;
+	rv->diag_row_number = SQL_ROW_NUMBER_UNKNOWN;
+	rv->stmt_time = 0;
+	rv->execute_delegate = NULL;
+	rv->execute_parent = NULL;
+	rv->allocated_callbacks = 0;
+	rv->num_callbacks = 0;
+	rv->callbacks = NULL;
+	GetDataInfoInitialize(SC_get_GDTI(rv));
+	PutDataInfoInitialize(SC_get_PDTI(rv));
+}
+
 StatementClass *
 SC_Constructor(ConnectionClass *conn)
 {
@@ -376,99 +479,21 @@ SC_Constructor(ConnectionClass *conn)
 	rv = (StatementClass *) malloc(sizeof(StatementClass));
 	if (rv)
 	{
-		rv->hdbc = conn;
-		rv->phstmt = NULL;
-		rv->result = NULL;
-		rv->curres = NULL;
-		rv->catalog_result = FALSE;
-		rv->prepare = NON_PREPARE_STATEMENT;
-		rv->prepared = NOT_YET_PREPARED;
-		rv->status = STMT_ALLOCATED;
-		rv->internal = FALSE;
-		rv->iflag = 0;
-		rv->plan_name = NULL;
-		rv->transition_status = STMT_TRANSITION_UNALLOCATED;
-		rv->multi_statement = -1; /* unknown */
-		rv->num_params = -1; /* unknown */
-		rv->processed_statements = NULL;
-
-		rv->__error_message = NULL;
-		rv->__error_number = 0;
-		rv->pgerror = NULL;
-
-		rv->statement = NULL;
-		rv->stmt_with_params = NULL;
-		rv->load_statement = NULL;
-		rv->statement_type = STMT_TYPE_UNKNOWN;
-
-		rv->currTuple = -1;
-		rv->rowset_start = 0;
-		SC_set_rowset_start(rv, -1, FALSE);
-		rv->current_col = -1;
-		rv->bind_row = 0;
-		rv->from_pos = rv->where_pos = -1;
-		rv->last_fetch_count = rv->last_fetch_count_include_ommitted = 0;
-		rv->save_rowset_size = -1;
-
-		rv->data_at_exec = -1;
-		rv->current_exec_param = -1;
-		rv->exec_start_row = -1;
-		rv->exec_end_row = -1;
-		rv->exec_current_row = -1;
-		rv->put_data = FALSE;
-		rv->ref_CC_error = FALSE;
-		rv->lock_CC_for_rb = 0;
-		rv->join_info = 0;
-		rv->curr_param_result = 0;
-		SC_init_parse_method(rv);
-
-		rv->lobj_fd = -1;
-		INIT_NAME(rv->cursor_name);
-
-		/* Parse Stuff */
-		rv->ti = NULL;
-		rv->ntab = 0;
-		rv->num_key_fields = -1; /* unknown */
-		SC_clear_parse_status(rv, conn);
-		rv->proc_return = -1;
-		SC_init_discard_output_params(rv);
-		rv->cancel_info = 0;
-
-		/* Clear Statement Options -- defaults will be set in AllocStmt */
-		memset(&rv->options, 0, sizeof(StatementOptions));
-		InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->ardi),
-				rv, SQL_ATTR_APP_ROW_DESC);
-		InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->apdi),
-				rv, SQL_ATTR_APP_PARAM_DESC);
-		InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->irdi),
-				rv, SQL_ATTR_IMP_ROW_DESC);
-		InitializeEmbeddedDescriptor((DescriptorClass *)&(rv->ipdi),
-				rv, SQL_ATTR_IMP_PARAM_DESC);
-
-		rv->miscinfo = 0;
-		rv->rbonerr = 0;
-		SC_reset_updatable(rv);
-		rv->diag_row_count = 0;
-		rv->stmt_time = 0;
-		rv->execute_delegate = NULL;
-		rv->execute_parent = NULL;
-		rv->allocated_callbacks = 0;
-		rv->num_callbacks = 0;
-		rv->callbacks = NULL;
-		GetDataInfoInitialize(SC_get_GDTI(rv));
-		PutDataInfoInitialize(SC_get_PDTI(rv));
+		SC_init_members(rv, conn);
 		INIT_STMT_CS(rv);
 	}
 	return rv;
 }
 
-char
-SC_Destructor(StatementClass *self)
+/*
+ *	Free everything a statement holds but the object itself.
+ */
+static char
+SC_free_members(StatementClass *self)
 {
-	CSTR func	= "SC_Destructor";
+	CSTR func	= "SC_free_members";
 	QResultClass	*res = SC_get_Result(self);
 
-	mylog("SC_Destructor: self=%p, self->result=%p, self->hdbc=%p\n", self, res, self->hdbc);
 	SC_clear_error(self);
 	if (STMT_EXECUTING == self->status)
 	{
@@ -496,6 +521,7 @@ SC_Destructor(StatementClass *self)
 	DC_Destructor((DescriptorClass *) SC_get_IRDi(self));
 	DC_Destructor((DescriptorClass *) SC_get_IPDi(self));
 	GDATA_unbind_cols(SC_get_GDTI(self), TRUE);
+	SC_unlink_putdata_lo(self);
 	PDATA_free_params(SC_get_PDTI(self), STMT_FREE_PARAMS_ALL);
 
 	if (self->__error_message)
@@ -506,6 +532,16 @@ SC_Destructor(StatementClass *self)
 	if (self->callbacks)
 		free(self->callbacks);
 
+	return TRUE;
+}
+
+char
+SC_Destructor(StatementClass *self)
+{
+	mylog("SC_Destructor: self=%p, self->result=%p, self->hdbc=%p\n", self, SC_get_Result(self), self->hdbc);
+	if (!SC_free_members(self))
+		return FALSE;
+
 	DELETE_STMT_CS(self);
 	free(self);
 
@@ -514,6 +550,24 @@ SC_Destructor(StatementClass *self)
 	return TRUE;
 }
 
+/*
+ *	Drop a statement of the connection. Its contents are released and
+ *	the object is kept in the pool of the connection, so that the next
+ *	PGAPI_AllocStmt() doesn't have to build it again. The statement is
+ *	destroyed when the pool is full.
+ */
+static void
+SC_drop(StatementClass *self, ConnectionClass *conn)
+{
+	if (conn && SC_free_members(self))
+	{
+		SC_init_members(self, conn);
+		if (CC_pool_statement(conn, self))
+			return;
+	}
+	SC_Destructor(self);
+}
+
 void
 SC_init_Result(StatementClass *self)
 {
@@ -547,6 +601,7 @@ SC_free_params(StatementClass *self, char option)
 		APD_free_params(SC_get_APDF(self), option);
 		IPD_free_params(SC_get_IPDF(self), option);
 	}
+	SC_unlink_putdata_lo(self);
 	PDATA_free_params(SC_get_PDTI(self), option);
 	self->data_at_exec = -1;
 	self->current_exec_param = -1;
@@ -612,7 +667,7 @@ inolog(":(%p)QR is %s", res, QR_has_valid_base(res) ? "valid" : "unknown");
 			if (start < 0)
 				QR_set_rowstart_in_cache(res, -1);
 			else
-				QR_set_rowstart_in_cache(res, start);
+				QR_set_rowstart_in_cache(res, start - res->stream_base);
 		}
 		if (!QR_get_cursor(res))
 			res->key_base = start;
@@ -652,27 +707,17 @@ SC_set_prepared(StatementClass *stmt, int prepared)
 		if (conn)
 		{
 			ENTER_CONN_CS(conn);
-			if (CONN_CONNECTED == conn->status)
-			{
-				if (CC_is_in_error_trans(conn))
-				{
-					CC_mark_a_object_to_discard(conn, 's',  stmt->plan_name);
-				}
-				else
-				{
-					QResultClass	*res;
-					char dealloc_stmt[128];
-
-					sprintf(dealloc_stmt, "DEALLOCATE \"%s\"", stmt->plan_name);
-					res = CC_send_query(conn, dealloc_stmt, NULL, IGNORE_ABORT_ON_CONN | ROLLBACK_ON_ERROR, NULL);
-					QR_Destructor(res);
-				}
-			}
+			if (CC_release_cached_plan(conn, stmt->plan_name))
+				;	/* kept for the next statement preparing the query */
+			else if (CONN_CONNECTED == conn->status)
+				CC_deallocate_plan(conn, stmt->plan_name);
 			LEAVE_CONN_CS(conn);
 		}
 	}
 	if (NOT_YET_PREPARED == prepared)
 		SC_set_planname(stmt, NULL);
+	if (prepared != stmt->prepared)
+		stmt->binary_result = FALSE;
 	stmt->prepared = prepared;
 }
 
@@ -745,6 +790,8 @@ BOOL	SC_opencheck(StatementClass *self, const char *func)
 
 	if (!self)
 		return FALSE;
+	if (SC_is_async_running(self))
+		return FALSE;
 	if (self->status == STMT_EXECUTING)
 	{
 		SC_set_error(self, STMT_SEQUENCE_ERROR, "Statement is currently executing a transaction.", func);
@@ -1161,6 +1208,7 @@ SC_clear_error(StatementClass *self)
 		self->pgerror = NULL;
 	}
 	self->diag_row_count = 0;
+	self->diag_row_number = SQL_ROW_NUMBER_UNKNOWN;
 	if (res = SC_get_Curres(self), res)
 	{
 		QR_set_message(res, NULL);
@@ -1558,6 +1606,56 @@ SC_get_bookmark(StatementClass *self)
 }
 
 
+/*
+ *	Set the error for the result 'retval' of copy_and_convert_field() on
+ *	the bound column 'col', and return the new result of the fetch.
+ */
+static RETCODE
+SC_bound_column_result(StatementClass *self, int retval, int col, const char *value, RETCODE result)
+{
+	CSTR func = "SC_fetch";
+
+	switch (retval)
+	{
+		case COPY_OK:
+			break;		/* OK, do next bound column */
+
+		case COPY_UNSUPPORTED_TYPE:
+			SC_set_error(self, STMT_RESTRICTED_DATA_TYPE_ERROR, "Received an unsupported type from Postgres.", func);
+			result = SQL_ERROR;
+			break;
+
+		case COPY_UNSUPPORTED_CONVERSION:
+			SC_set_error(self, STMT_RESTRICTED_DATA_TYPE_ERROR, "Couldn't handle the necessary data type conversion.", func);
+			result = SQL_ERROR;
+			break;
+
+		case COPY_RESULT_TRUNCATED:
+			SC_set_error(self, STMT_TRUNCATED, "Fetched item was truncated.", func);
+			qlog("The %dth item was truncated\n", col + 1);
+			qlog("The buffer size = %d", SC_get_ARDF(self)->bindings[col].buflen);
+			qlog(" and the value is '%s'\n", value);
+			result = SQL_SUCCESS_WITH_INFO;
+			break;
+
+			/* error msg already filled in */
+		case COPY_GENERAL_ERROR:
+			result = SQL_ERROR;
+			break;
+
+			/* This would not be meaningful in SQLFetch. */
+		case COPY_NO_DATA_FOUND:
+			break;
+
+		default:
+			SC_set_error(self, STMT_INTERNAL_ERROR, "Unrecognized return value from copy_and_convert_field.", func);
+			result = SQL_ERROR;
+			break;
+	}
+
+	return result;
+}
+
 RETCODE
 SC_fetch(StatementClass *self)
 {
@@ -1590,6 +1688,17 @@ inolog("%s statement=%p res=%x ommitted=0\n", func, self, res);
 	useCursor = (SC_is_fetchcursor(self) && (NULL != QR_get_cursor(res)));
 	if (!useCursor)
 	{
+		/* read the next rows of a streamed result */
+		if (QR_is_streaming(res) &&
+			self->currTuple >= (Int4) QR_get_num_total_read(res) - 1 &&
+			!QR_read_stream(res, FALSE))
+		{
+			if (PORES_NO_MEMORY_ERROR == QR_get_rstatus(res))
+				SC_set_error(self, STMT_NO_MEMORY_ERROR, "memory allocation error???", func);
+			else
+				SC_set_error(self, STMT_EXEC_ERROR, NULL != QR_get_message(res) ? QR_get_message(res) : "Error fetching next row", func);
+			return SQL_ERROR;
+		}
 		if (self->currTuple >= (Int4) QR_get_num_total_tuples(res) - 1 ||
 			(self->options.maxRows > 0 && self->currTuple == self->options.maxRows - 1))
 		{
@@ -1719,6 +1828,8 @@ inolog("%s: stmt=%p ommitted++\n", func, self);
 
 		if (NULL == opts->bindings)
 			continue;
+		if (self->columnwise_fetch)
+			continue;	/* converted by SC_fetch_columnwise() */
 		if (opts->bindings[lf].buffer != NULL)
 		{
 			/* this column has a binding */
@@ -1741,55 +1852,202 @@ inolog("curt=%d\n", curt);
 
 			mylog("value = '%s'\n", (value == NULL) ? "<NULL>" : value);
 
-			retval = copy_and_convert_field_bindinfo(self, type, atttypmod, value, lf);
+			retval = copy_and_convert_field_bindinfo(self, type, atttypmod, value, lf, 0 != CI_get_format(coli, lf));
 
 			mylog("copy_and_convert: retval = %d\n", retval);
 
-			switch (retval)
-			{
-				case COPY_OK:
-					break;		/* OK, do next bound column */
+			result = SC_bound_column_result(self, retval, lf, value, result);
+		}
+	}
 
-				case COPY_UNSUPPORTED_TYPE:
-					SC_set_error(self, STMT_RESTRICTED_DATA_TYPE_ERROR, "Received an unsupported type from Postgres.", func);
-					result = SQL_ERROR;
-					break;
+	return result;
+}
 
-				case COPY_UNSUPPORTED_CONVERSION:
-					SC_set_error(self, STMT_RESTRICTED_DATA_TYPE_ERROR, "Couldn't handle the necessary data type conversion.", func);
-					result = SQL_ERROR;
-					break;
+/* Is the column of 'type' bound by 'bic' converted as a large object ? */
+static BOOL
+is_bound_lo_column(const ConnectionClass *conn, const BindInfoClass *bic, OID type)
+{
+	if (NULL == bic->buffer)
+		return FALSE;
+	return (PG_TYPE_LO_UNDEFINED == type ||
+		type == conn->lobj_type ||
+		(PG_TYPE_OID == type && SQL_C_BINARY == bic->returntype && conn->lo_is_domain));
+}
 
-				case COPY_RESULT_TRUNCATED:
-					SC_set_error(self, STMT_TRUNCATED, "Fetched item was truncated.", func);
-					qlog("The %dth item was truncated\n", lf + 1);
-					qlog("The buffer size = %d", opts->bindings[lf].buflen);
-					qlog(" and the value is '%s'\n", value);
-					result = SQL_SUCCESS_WITH_INFO;
-					break;
+/*
+ *	Read the sizes and the first bytes of the large objects of the bound
+ *	large object columns of the rowset in one query, which convert_lo()
+ *	looks up instead of reading each large object separately.
+ */
+static QResultClass *
+read_lo_heads(StatementClass *self, const TupleField *tuples, int num_fields, SQLLEN nrows)
+{
+	ConnectionClass *conn = SC_get_conn(self);
+	QResultClass *res = SC_get_Curres(self);
+	ARDFields	*opts = SC_get_ARDF(self);
+	ColumnInfoClass *coli = QR_get_fields(res);
+	BindInfoClass	*bic;
+	QResultClass	*heads = NULL;
+	OID		*oids = NULL, *new_oids, type, oid;
+	Int4		*lens = NULL, *new_lens, len;
+	int		count = 0, alloc = 0;
+	Int2		num_cols, lf;
+	SQLLEN		row;
+	const char	*value;
 
-					/* error msg already filled in */
-				case COPY_GENERAL_ERROR:
-					result = SQL_ERROR;
-					break;
+	num_cols = QR_NumPublicResultCols(res);
+	for (lf = 0; lf < num_cols; lf++)
+	{
+		bic = &opts->bindings[lf];
+		type = CI_get_oid(coli, lf);
+		if (!is_bound_lo_column(conn, bic, type))
+			continue;
+		switch (bic->returntype)
+		{
+			case SQL_C_CHAR:
+				len = (Int4) ((bic->buflen - 1) / 2);
+				break;
+			case SQL_C_BINARY:
+				len = (Int4) bic->buflen;
+				break;
+			default:
+				continue;
+		}
+		for (row = 0; row < nrows; row++)
+		{
+			value = tuples[row * num_fields + lf].value;
+			if (NULL == value || 0 == (oid = (OID) strtoul(value, NULL, 10)))
+				continue;
+			if (count >= alloc)
+			{
+				alloc = alloc > 0 ? alloc * 2 : 16;
+				new_oids = realloc(oids, alloc * sizeof(OID));
+				if (new_oids)
+					oids = new_oids;
+				new_lens = realloc(lens, alloc * sizeof(Int4));
+				if (new_lens)
+					lens = new_lens;
+				if (!new_oids || !new_lens)
+					goto cleanup;
+			}
+			oids[count] = oid;
+			lens[count] = len;
+			count++;
+		}
+	}
+	if (count > 0)
+		heads = odbc_lo_get_heads(conn, oids, lens, count, ROLLBACK_ON_ERROR | IGNORE_ABORT_ON_CONN);
+cleanup:
+	if (oids)
+		free(oids);
+	if (lens)
+		free(lens);
 
-					/* This would not be meaningful in SQLFetch. */
-				case COPY_NO_DATA_FOUND:
-					break;
+	return heads;
+}
 
-				default:
-					SC_set_error(self, STMT_INTERNAL_ERROR, "Unrecognized return value from copy_and_convert_field.", func);
-					result = SQL_ERROR;
-					break;
-			}
+/*
+ *	Convert the bound columns of the 'nrows' rows of the rowset column by
+ *	column, after SC_fetch() has positioned each row with columnwise_fetch
+ *	set. The rows must be in the cache of the current result. The row-wise
+ *	code in SC_fetch() resolves the conversion of each field again; here it
+ *	is resolved once per column (see copy_and_convert_column()).
+ *	On an error, *error_row is set to the first failing row, and only the
+ *	rows before it are converted.
+ */
+RETCODE
+SC_fetch_columnwise(StatementClass *self, SQLLEN nrows, SQLLEN *error_row)
+{
+	QResultClass *res = SC_get_Curres(self);
+	ARDFields	*opts = SC_get_ARDF(self);
+	ColumnInfoClass *coli = QR_get_fields(res);
+	const TupleField *tuples;
+	Int2		num_cols, lf;
+	SQLLEN		failed_row;
+	int		retval;
+	RETCODE		ret, result = SQL_SUCCESS;
+
+	*error_row = -1;
+	num_cols = QR_NumPublicResultCols(res);
+	tuples = res->backend_tuples + GIdx2CacheIdx(RowIdx2GIdx(0, self), self, res) * res->num_fields;
+	if (PG_VERSION_GE(SC_get_conn(self), 9.4) && NULL != opts->bindings)
+		self->lobj_heads = read_lo_heads(self, tuples, res->num_fields, nrows);
+	for (lf = 0; lf < num_cols && NULL != opts->bindings && nrows > 0; lf++)
+	{
+		if (NULL == opts->bindings[lf].buffer)
+			continue;
+		failed_row = 0;
+		retval = copy_and_convert_column(self, CI_get_oid(coli, lf), CI_get_atttypmod(coli, lf), tuples, res->num_fields, nrows, lf, 0 != CI_get_format(coli, lf), &failed_row);
+		if (COPY_OK == retval)
+			continue;
+		mylog("%s: retval = %d at row " FORMAT_LEN " of column %d\n", __FUNCTION__, retval, failed_row, lf);
+		/* Keep the error of the failing row */
+		if (SQL_ERROR == result && COPY_RESULT_TRUNCATED == retval)
+			continue;
+		ret = SC_bound_column_result(self, retval, lf, tuples[failed_row * res->num_fields + lf].value, SQL_SUCCESS);
+		if (SQL_ERROR == ret)
+		{
+			/*
+			 * The rows from the failing one on are not fetched. The
+			 * remaining columns of the rows before it are still
+			 * converted, and may fail at an earlier row.
+			 */
+			*error_row = failed_row;
+			nrows = failed_row;
+			result = ret;
 		}
+		else if (SQL_SUCCESS == result)
+			result = ret;
 	}
+	QR_Destructor(self->lobj_heads);
+	self->lobj_heads = NULL;
+	self->bind_row = 0;
 
 	return result;
 }
 
 
 #include "dlg_specific.h"
+
+/*
+ * The rows of a forward-only read-only SELECT are read from the connection
+ * by the block of Fetch rows as the application fetches them, instead
+ * of all at once, if BIT_STREAM_RESULTS is set. Unlike UseDeclareFetch,
+ * no transaction is needed. The connection can't be used for another
+ * query meanwhile, so the remaining rows are read into the result when
+ * it is.
+ */
+static BOOL
+stream_result_wanted(const StatementClass *stmt)
+{
+	const ConnectionClass	*conn = SC_get_conn(stmt);
+
+	if (0 == (conn->connInfo.extra_opts & BIT_STREAM_RESULTS))
+		return FALSE;
+	if (stmt->internal || stmt->catalog_result ||
+		!SC_may_fetch_rows(stmt) ||
+		0 != stmt->multi_statement)
+		return FALSE;
+	if (SQL_CONCUR_READ_ONLY != stmt->options.scroll_concurrency ||
+		SQL_CURSOR_FORWARD_ONLY != stmt->options.cursor_type)
+		return FALSE;
+	return TRUE;
+}
+
+/*
+ * With SQL_ATTR_ASYNC_ENABLE on, the query of SQLExecute/SQLExecDirect
+ * is sent without waiting for the result. SQL_STILL_EXECUTING is returned
+ * until it arrives, and the calls repeated by the application look for
+ * it again. The execution completed by SQLParamData is synchronous.
+ */
+static BOOL
+async_query_wanted(const StatementClass *stmt)
+{
+	return (SQL_ASYNC_ENABLE_ON == stmt->options.async_enable &&
+		!stmt->internal &&
+		stmt->data_at_exec < 0);
+}
+
 RETCODE
 SC_execute(StatementClass *self)
 {
@@ -1806,7 +2064,7 @@ SC_execute(StatementClass *self)
 	BOOL		is_in_trans, issue_begin, has_out_para;
 	BOOL		use_extended_protocol;
 	int		func_cs_count = 0, i;
-	BOOL		useCursor, isSelectType;
+	BOOL		useCursor, isSelectType, still_executing = FALSE;
 
 	conn = SC_get_conn(self);
 	ci = &(conn->connInfo);
@@ -1824,7 +2082,8 @@ SC_execute(StatementClass *self)
 #define	return	DONT_CALL_RETURN_FROM_HERE???
 	ENTER_INNER_CONN_CS(conn, func_cs_count);
 	oldstatus = conn->status;
-	if (CONN_EXECUTING == conn->status)
+	if (CONN_EXECUTING == conn->status ||
+	    CC_async_busy(conn, self, func))
 	{
 		SC_set_error(self, STMT_SEQUENCE_ERROR, "Connection is already in use.", func);
 		mylog("%s: problem with connection\n", func);
@@ -1880,6 +2139,8 @@ SC_execute(StatementClass *self)
 		mylog("   about to begin a transaction on statement = %p\n", self);
 		qflag |= GO_INTO_TRANSACTION;
 	}
+	if (async_query_wanted(self))
+		qflag |= ASYNC_QUERY;
 
 	/* self->status = STMT_EXECUTING; */
 	if (!SC_SetExecuting(self, TRUE))
@@ -1908,8 +2169,8 @@ SC_execute(StatementClass *self)
 		if (issue_begin)
 			CC_begin(conn);
 
-		res = libpq_bind_and_exec(self);
-		if (!res)
+		res = libpq_bind_and_exec(self, (qflag & ASYNC_QUERY) != 0);
+		if (!res && !SC_is_async_running(self))
 		{
 			if (SC_get_errornumber(self) <= 0)
 				SC_set_error(self, STMT_NO_RESPONSE, "Could not receive the response, communication down ??", func);
@@ -1924,6 +2185,8 @@ SC_execute(StatementClass *self)
 		QueryInfo	*qryi = NULL;
 
 		qflag |= (SQL_CONCUR_READ_ONLY != self->options.scroll_concurrency ? CREATE_KEYSET : 0);
+		if (!useCursor && stream_result_wanted(self))
+			qflag |= STREAM_RESULT;
 		mylog("       Sending SELECT statement on stmt=%p, cursor_name='%s' qflag=%d,%d\n", self, SC_cursor_name(self), qflag, self->options.scroll_concurrency);
 
 		/* send the declare/select */
@@ -1994,6 +2257,11 @@ SC_execute(StatementClass *self)
 		mylog("      it's NOT a select statement: stmt=%p\n", self);
 		res = CC_send_query(conn, self->stmt_with_params, NULL, qflag, SC_get_ancestor(self));
 	}
+	if (NULL == res && SC_is_async_running(self))
+	{
+		still_executing = TRUE;
+		goto cleanup;
+	}
 
 	if (!isSelectType)
 	{
@@ -2234,6 +2502,13 @@ inolog("!!SC_fetch return =%d\n", ret);
 	}
 cleanup:
 #undef	return
+	if (still_executing)
+	{
+		/* the statement stays executing until the result arrives */
+		CLEANUP_FUNC_CONN_CS(func_cs_count, conn);
+		conn->status = oldstatus;
+		return SQL_STILL_EXECUTING;
+	}
 	SC_SetExecuting(self, FALSE);
 	CLEANUP_FUNC_CONN_CS(func_cs_count, conn);
 	if (CONN_DOWN != conn->status)
@@ -2379,6 +2654,13 @@ RequestStart(StatementClass *stmt, ConnectionClass *conn, const char *func)
 	if (conn->asdum)
 		CALL_IsolateDtcConn(conn, TRUE);
 #endif /* _HANDLE_ENLIST_IN_DTC_ */
+	if (CC_async_busy(conn, stmt, func))
+	{
+		SC_set_error(stmt, STMT_SEQUENCE_ERROR, "Connection is already in use.", func);
+		return FALSE;
+	}
+	CC_complete_stream(conn);
+	CC_complete_fetch_ahead(conn);
 	if (SC_accessed_db(stmt))
 		return TRUE;
 	if (SQL_ERROR == SetStatementSvp(stmt))
@@ -2404,202 +2686,1332 @@ RequestStart(StatementClass *stmt, ConnectionClass *conn, const char *func)
 }
 
 
-static QResultClass *
-libpq_bind_and_exec(StatementClass *stmt)
+/*
+ * Free the parameter arrays built by build_libpq_bind_params().
+ */
+static void
+libpq_free_bind_params(int nParams, Oid *paramTypes, char **paramValues,
+					   int *paramLengths, int *paramFormats)
 {
-	CSTR		func = "libpq_bind_and_exec";
-	ConnectionClass	*conn = SC_get_conn(stmt);
-	int			nParams;
-	Oid		   *paramTypes = NULL;
-	char	  **paramValues = NULL;
-	int		   *paramLengths = NULL;
-	int		   *paramFormats = NULL;
-	int			resultFormat;
-	PGresult   *pgres = NULL;
-	int			pgresstatus;
-	QResultClass	*newres = NULL;
-	QResultClass *res = NULL;
-	char	   *cmdtag;
-	char	   *rowcount;
-	BOOL		ret = FALSE;
-
-	if (!RequestStart(stmt, conn, func))
-		return NULL;
-
-	if (CC_is_in_trans(conn) && !SC_accessed_db(stmt))
+	if (paramValues)
 	{
-		if (SQL_ERROR == SetStatementSvp(stmt))
+		int			i;
+		for (i = 0; i < nParams; i++)
 		{
-			SC_set_error(stmt, STMT_INTERNAL_ERROR, "internal savepoint error in build_libpq_bind_params", func);
-			return NULL;
+			if (paramValues[i] != NULL)
+				free(paramValues[i]);
 		}
+		free(paramValues);
 	}
+	if (paramTypes)
+		free(paramTypes);
+	if (paramLengths)
+		free(paramLengths);
+	if (paramFormats)
+		free(paramFormats);
+}
 
-	/* 1. Bind */
-	mylog("%s: bind stmt=%p\n", func, stmt);
-	if (!build_libpq_bind_params(stmt,
-								 &nParams,
-								 &paramTypes,
-								 &paramValues,
-								 &paramLengths, &paramFormats,
-								 &resultFormat))
-	{
-		goto cleanup;
-	}
+/*
+ * Store the PGresult of an extended query execution into 'res'.
+ *
+ * Returns FALSE if the tuples couldn't be read into 'res'.
+ */
+static BOOL
+libpq_receive_result(StatementClass *stmt, QResultClass *res,
+					 PGresult **pgres, const char *func)
+{
+	ConnectionClass	*conn = SC_get_conn(stmt);
+	char	   *cmdtag;
+	char	   *rowcount;
 
-	/* 2. Execute */
-	mylog("%s: execute stmt=%p\n", func, stmt);
-	if (!SC_is_fetchcursor(stmt))
+	switch (PQresultStatus(*pgres))
 	{
-		if (stmt->prepared == NOT_YET_PREPARED ||
-			(stmt->prepared == PREPARED_TEMPORARILY && conn->unnamed_prepared_stmt != stmt))
-		{
-			SC_set_error(stmt, STMT_EXEC_ERROR, "about to execute a non-prepared statement", func);
-			goto cleanup;
-		}
-	}
+		case PGRES_COMMAND_OK:
+			/* portal query command, no tuples returned */
+			/* read in the return message from the backend */
+			cmdtag = PQcmdStatus(*pgres);
+			mylog("command response: %s\n", cmdtag);
+			QR_set_command(res, cmdtag);
+			if (QR_command_successful(res))
+				QR_set_rstatus(res, PORES_COMMAND_OK);
 
-	/* 2.5 Prepare and Describe if needed */
-	if (stmt->prepared == PREPARING_TEMPORARILY ||
-		(stmt->prepared == PREPARED_TEMPORARILY && conn->unnamed_prepared_stmt != stmt))
-	{
-		ProcessedStmt *pstmt;
+			/* get rowcount */
+			rowcount = PQcmdTuples(*pgres);
+			if (rowcount && rowcount[0])
+				res->recent_processed_row_count = atoi(rowcount);
+			else
+				res->recent_processed_row_count = -1;
+			break;
 
-		if (!stmt->processed_statements)
-		{
-			if (prepareParametersNoDesc(stmt, FALSE) == SQL_ERROR)
-				goto cleanup;
-		}
+		case PGRES_EMPTY_QUERY:
+			/* We return the empty query */
+			QR_set_rstatus(res, PORES_EMPTY_QUERY);
+			break;
+		case PGRES_NONFATAL_ERROR:
+			handle_pgres_error(conn, *pgres, func, res, FALSE);
+			break;
 
-		pstmt = stmt->processed_statements;
-		pgres = PQexecParams(conn->pqconn,
-							 pstmt->query,
-							 pstmt->num_params,
-							 paramTypes,
-							 (const char **) paramValues,
-							 paramLengths,
-							 paramFormats,
+		case PGRES_BAD_RESPONSE:
+		case PGRES_FATAL_ERROR:
+			handle_pgres_error(conn, *pgres, func, res, TRUE);
+			break;
+		case PGRES_TUPLES_OK:
+			if (!QR_from_PGresult(res, stmt, conn, NULL, pgres))
+				return FALSE;
+			if (res->rstatus == PORES_TUPLES_OK && res->notice)
+				QR_set_rstatus(res, PORES_NONFATAL_ERROR);
+			break;
+		case PGRES_COPY_OUT:
+		case PGRES_COPY_IN:
+		case PGRES_COPY_BOTH:
+		default:
+			/* skip the unexpected response if possible */
+			CC_set_error(conn, CONNECTION_BACKEND_CRAZY, "Unexpected protocol character from backend (send_query)", func);
+			CC_on_abort(conn, CONN_DEAD);
+
+			mylog("send_query: error - %s\n", CC_get_errormsg(conn));
+			break;
+	}
+
+	return TRUE;
+}
+
+/*
+ * Receiving the rows in binary format (BIT_BINARY_RESULT) is tried for
+ * read-only results of prepared SELECT statements, once an execution in
+ * text format has shown that the driver can decode every column. The
+ * result types of a named prepared statement don't change.
+ */
+static BOOL
+binary_result_wanted(const StatementClass *stmt)
+{
+	const ConnectionClass	*conn = SC_get_conn(stmt);
+
+	if (0 == (conn->connInfo.extra_opts & BIT_BINARY_RESULT))
+		return FALSE;
+	if (stmt->internal || stmt->catalog_result ||
+		SC_is_fetchcursor(stmt) ||
+		!SC_may_fetch_rows(stmt) ||
+		PREPARED_PERMANENTLY != stmt->prepared)
+		return FALSE;
+	if (SQL_CONCUR_READ_ONLY != stmt->options.scroll_concurrency ||
+		SQL_CURSOR_KEYSET_DRIVEN == stmt->options.cursor_type ||
+		SQL_CURSOR_DYNAMIC == stmt->options.cursor_type)
+		return FALSE;
+	return TRUE;
+}
+
+static BOOL
+binary_result_columns(const ConnectionClass *conn, const QResultClass *res)
+{
+	ColumnInfoClass	*flds;
+	const char *integer_datetimes;
+	OID			type;
+	int			i, num_fields;
+
+	if (NULL == res || QR_haskeyset(res) ||
+		NULL == (flds = QR_get_fields(res)) ||
+		(num_fields = CI_get_num_fields(flds)) <= 0)
+		return FALSE;
+	integer_datetimes = PQparameterStatus(conn->pqconn, "integer_datetimes");
+	for (i = 0; i < num_fields; i++)
+	{
+		type = CI_get_oid(flds, i);
+		if (!binary_result_supported(type))
+			return FALSE;
+		if (PG_TYPE_TIMESTAMP_NO_TMZONE == type &&
+			(NULL == integer_datetimes || strcmp(integer_datetimes, "on") != 0))
+			return FALSE;
+		/*
+		 * Older servers send floats with extra_float_digits dependent
+		 * precision, not the shortest text binary_float_to_text() makes.
+		 */
+		if ((PG_TYPE_FLOAT4 == type || PG_TYPE_FLOAT8 == type) &&
+			PG_VERSION_LT(conn, 12.0))
+			return FALSE;
+	}
+	return TRUE;
+}
+
+static QResultClass *
+libpq_bind_and_exec(StatementClass *stmt, BOOL async)
+{
+	CSTR		func = "libpq_bind_and_exec";
+	ConnectionClass	*conn = SC_get_conn(stmt);
+	int			nParams = 0;
+	Oid		   *paramTypes = NULL;
+	char	  **paramValues = NULL;
+	int		   *paramLengths = NULL;
+	int		   *paramFormats = NULL;
+	int			resultFormat;
+	PGresult   *pgres = NULL, *nextres;
+	QResultClass	*newres = NULL;
+	QResultClass *res = NULL;
+	BOOL		ret = FALSE, sent = FALSE;
+
+	if (!RequestStart(stmt, conn, func))
+		return NULL;
+	if (async && SC_is_async_running(stmt))
+	{
+		mylog("%s: the query was sent by the previous call\n", func);
+		sent = TRUE;
+		goto wait_result;
+	}
+
+	if (CC_is_in_trans(conn) && !SC_accessed_db(stmt))
+	{
+		if (SQL_ERROR == SetStatementSvp(stmt))
+		{
+			SC_set_error(stmt, STMT_INTERNAL_ERROR, "internal savepoint error in build_libpq_bind_params", func);
+			return NULL;
+		}
+	}
+
+	/* 1. Bind */
+	mylog("%s: bind stmt=%p\n", func, stmt);
+	if (!build_libpq_bind_params(stmt,
+								 &nParams,
+								 &paramTypes,
+								 &paramValues,
+								 &paramLengths, &paramFormats,
+								 &resultFormat))
+	{
+		goto cleanup;
+	}
+	if (stmt->binary_result && binary_result_wanted(stmt))
+		resultFormat = 1;
+
+	/* 2. Execute */
+	mylog("%s: execute stmt=%p\n", func, stmt);
+	if (!SC_is_fetchcursor(stmt))
+	{
+		if (stmt->prepared == NOT_YET_PREPARED ||
+			(stmt->prepared == PREPARED_TEMPORARILY && conn->unnamed_prepared_stmt != stmt))
+		{
+			SC_set_error(stmt, STMT_EXEC_ERROR, "about to execute a non-prepared statement", func);
+			goto cleanup;
+		}
+	}
+
+	/* 2.5 Prepare and Describe if needed */
+	if (stmt->prepared == PREPARING_TEMPORARILY ||
+		(stmt->prepared == PREPARED_TEMPORARILY && conn->unnamed_prepared_stmt != stmt))
+	{
+		ProcessedStmt *pstmt;
+
+		if (!stmt->processed_statements)
+		{
+			if (prepareParametersNoDesc(stmt, FALSE) == SQL_ERROR)
+				goto cleanup;
+		}
+
+		pstmt = stmt->processed_statements;
+		sent = PQsendQueryParams(conn->pqconn,
+							 pstmt->query,
+							 pstmt->num_params,
+							 paramTypes,
+							 (const char **) paramValues,
+							 paramLengths,
+							 paramFormats,
 							 resultFormat);
 	}
-	else
+	else
+	{
+		const char *plan_name;
+
+		if (stmt->prepared == PREPARING_PERMANENTLY)
+		{
+			if (prepareParameters(stmt, FALSE) == SQL_ERROR)
+				goto cleanup;
+		}
+
+		/* prepareParameters() set plan name, so don't fetch this earlier */
+		plan_name = stmt->plan_name ? stmt->plan_name : "";
+
+		/* already prepared */
+		sent = PQsendQueryPrepared(conn->pqconn,
+							   plan_name, 	/* portal name == plan name */
+							   nParams,
+							   (const char **) paramValues, paramLengths, paramFormats,
+							   resultFormat);
+	}
+
+wait_result:
+	/* if not sent, the NULL result reports the error of the connection */
+	if (sent)
+	{
+		if (async)
+		{
+			if (!CC_async_result_ready(conn))
+			{
+				/* SC_execute() returns SQL_STILL_EXECUTING */
+				mylog("%s: the result hasn't arrived yet\n", func);
+				conn->async_stmt = SC_get_ancestor(stmt);
+				goto cleanup;
+			}
+			conn->async_stmt = NULL;
+		}
+		/* the last result is the one wanted as PQexecPrepared() returns */
+		while (nextres = PQgetResult(conn->pqconn), NULL != nextres)
+		{
+			if (pgres)
+				PQclear(pgres);
+			pgres = nextres;
+		}
+	}
+	if (stmt->curr_param_result)
+	{
+		for (res = SC_get_Result(stmt); NULL != res && NULL != res->next; res = res->next) ;
+	}
+	else
+		res = NULL;
+
+	if (!res)
+	{
+		newres = res = QR_Constructor();
+		if (!res)
+		{
+			SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "Out of memory while allocating result set", func);
+			goto cleanup;
+		}
+	}
+
+	/* 3. Receive results */
+inolog("get_Result=%p %p %d\n", res, SC_get_Result(stmt), stmt->curr_param_result);
+	if (!libpq_receive_result(stmt, res, &pgres, func))
+		goto cleanup;
+
+	if (res != newres && NULL != newres)
+		QR_Destructor(newres);
+	if (!stmt->binary_result && binary_result_wanted(stmt))
+		stmt->binary_result = binary_result_columns(conn, res);
+
+	ret = TRUE;
+
+cleanup:
+	if (pgres)
+		PQclear(pgres);
+	libpq_free_bind_params(nParams, paramTypes, paramValues, paramLengths, paramFormats);
+
+	if (ret)
+		return res;
+	else
+		return NULL;
+}
+
+/*
+ * Max number of parameters of a statement. The protocol sends the count
+ * as a 16 bit integer.
+ */
+#define	MAX_BIND_PARAMS	65535
+
+/*
+ * Savepoint which lets a batch of parameter rows that failed as a whole
+ * be executed again row by row in a transaction.
+ */
+#define	PARAM_BATCH_SVP	"_param_batch_svp_"
+
+static BOOL
+exec_param_batch_svp(ConnectionClass *conn, const char *query)
+{
+	PGresult   *pgres;
+	BOOL		ret;
+
+	mylog("exec_param_batch_svp: %s\n", query);
+	pgres = PQexec(conn->pqconn, query);
+	ret = (pgres && PQresultStatus(pgres) == PGRES_COMMAND_OK);
+	if (pgres)
+		PQclear(pgres);
+	LIBPQ_update_transaction_status(conn);
+	return ret;
+}
+
+/*
+ * Execute the given parameter rows of the single-row statement one by
+ * one, after their batch has failed as a whole, so that the failing row
+ * is told from the others. As in the row by row execution, the first
+ * failing row ends the execution and the following rows are left
+ * SQL_PARAM_UNUSED.
+ *
+ * The results are appended after '*last'. Returns FALSE if the
+ * connection was lost.
+ */
+static BOOL
+SC_execute_rows_one_by_one(StatementClass *self, const SQLLEN *rows, int nrows,
+						   QResultClass **last,
+						   BOOL *row_failed, BOOL *with_info)
+{
+	CSTR		func = "SC_execute_rows_one_by_one";
+	ConnectionClass	*conn = SC_get_conn(self);
+	IPDFields	*ipdopts = SC_get_IPDF(self);
+	const ProcessedStmt	*pstmt = self->processed_statements;
+	SQLUSMALLINT	row_status;
+	PGresult   *pgres;
+	QResultClass	*res;
+	int			i;
+
+	mylog("%s: stmt=%p %d rows\n", func, self, nrows);
+	for (i = 0; i < nrows && !*row_failed; i++)
+	{
+		int			nParams = 0;
+		Oid		   *paramTypes = NULL;
+		char	  **paramValues = NULL;
+		int		   *paramLengths = NULL;
+		int		   *paramFormats = NULL;
+		int			resultFormat;
+
+		if (ipdopts->param_processed_ptr)
+			(*ipdopts->param_processed_ptr)++;
+		self->exec_current_row = rows[i];
+		res = NULL;
+		if (!build_libpq_bind_params(self,
+									 &nParams,
+									 &paramTypes,
+									 &paramValues,
+									 &paramLengths, &paramFormats,
+									 &resultFormat))
+			pgres = NULL;
+		else
+			pgres = PQexecParams(conn->pqconn,
+								 pstmt->query,
+								 pstmt->num_params,
+								 paramTypes,
+								 (const char **) paramValues,
+								 paramLengths,
+								 paramFormats,
+								 resultFormat);
+		libpq_free_bind_params(nParams, paramTypes, paramValues, paramLengths, paramFormats);
+		if (!pgres)
+		{
+			if (!conn->pqconn || PQstatus(conn->pqconn) == CONNECTION_BAD)
+			{
+				if (SC_get_errornumber(self) <= 0)
+					SC_set_error(self, STMT_NO_RESPONSE, "Could not receive the response, communication down ??", func);
+				if (conn->pqconn)
+					CC_on_abort(conn, CONN_DEAD);
+				return FALSE;
+			}
+			/* the conversion of a parameter failed */
+			row_status = SQL_PARAM_ERROR;
+		}
+		else
+		{
+			if (NULL == (res = QR_Constructor()) ||
+				!libpq_receive_result(self, res, &pgres, func) ||
+				!conn->pqconn)
+			{
+				if (pgres)
+					PQclear(pgres);
+				if (res)
+					QR_Destructor(res);
+				if (SC_get_errornumber(self) <= 0)
+					SC_set_error(self, STMT_NO_RESPONSE, "Could not receive the response, communication down ??", func);
+				if (conn->pqconn)
+					CC_on_abort(conn, CONN_DEAD);
+				return FALSE;
+			}
+			PQclear(pgres);
+
+			if (QR_command_successful(res))
+				row_status = SQL_PARAM_SUCCESS;
+			else if (QR_command_nonfatal(res))
+			{
+				row_status = SQL_PARAM_SUCCESS_WITH_INFO;
+				*with_info = TRUE;
+			}
+			else
+				row_status = SQL_PARAM_ERROR;
+
+			if (NULL == *last)
+				SC_set_Result(self, res);
+			else
+			{
+				(*last)->next = res;
+				self->curr_param_result = 1;
+			}
+			*last = res;
+		}
+
+		if (ipdopts->param_status_ptr)
+			ipdopts->param_status_ptr[rows[i]] = row_status;
+		if (SQL_PARAM_ERROR == row_status)
+		{
+			if (NULL != res)
+				SC_set_errornumber(self, STMT_ERROR_TAKEN_FROM_BACKEND);
+			self->diag_row_number = rows[i] + 1;
+			*row_failed = TRUE;
+		}
+	}
+
+	return TRUE;
+}
+
+/*
+ * Execute the remaining rows (from exec_current_row to end_row) of an
+ * array-bound single-row INSERT as multi-row INSERTs of up to
+ * InsertBatchRows rows, and up to about InsertBatchBytes bytes of
+ * parameter values if it's set. The first row must have been executed
+ * by SC_execute() so that the statement is already prepared and the
+ * transaction/savepoint handling is done.
+ *
+ * A batch which fails as a whole is executed again row by row, so that
+ * only the failing row is marked SQL_PARAM_ERROR. In a transaction,
+ * every batch is preceded by a savepoint to roll the failed batch back
+ * to. As in the row by row execution, the first failing row ends the
+ * execution and the following rows are left SQL_PARAM_UNUSED.
+ */
+RETCODE
+SC_execute_multirow_insert(StatementClass *self, SQLLEN end_row)
+{
+	CSTR		func = "SC_execute_multirow_insert";
+	ConnectionClass	*conn = SC_get_conn(self);
+	const ConnInfo	*ci = &(conn->connInfo);
+	APDFields	*apdopts = SC_get_APDF(self);
+	IPDFields	*ipdopts = SC_get_IPDF(self);
+	const ProcessedStmt	*pstmt = self->processed_statements;
+	int			num_params = pstmt->num_params;
+	int			max_rows = 0, nrows, query_rows = 0, i;
+	size_t		lpos, llen, nbytes;
+	SQLLEN		row, *batch_rows = NULL;
+	char	   *query = NULL;
+	Oid		   *paramTypes = NULL;
+	char	  **paramValues = NULL;
+	int		   *paramLengths = NULL;
+	int		   *paramFormats = NULL;
+	int			resultFormat = 0;
+	PGresult   *pgres;
+	QResultClass	*res, *last;
+	SQLUSMALLINT	row_status;
+	Int2		oldstatus;
+	BOOL		in_trans, svp_set = FALSE;
+	BOOL		failed = FALSE, row_failed = FALSE, with_info = FALSE;
+	RETCODE		ret = SQL_ERROR;
+	int			func_cs_count = 0;
+
+#define	return	DONT_CALL_RETURN_FROM_HERE???
+	ENTER_INNER_CONN_CS(conn, func_cs_count);
+	oldstatus = conn->status;
+	if (CONN_EXECUTING == conn->status)
+	{
+		SC_set_error(self, STMT_SEQUENCE_ERROR, "Connection is already in use.", func);
+		mylog("%s: problem with connection\n", func);
+		goto cleanup;
+	}
+	if (!SC_SetExecuting(self, TRUE))
+	{
+		SC_set_error(self, STMT_OPERATION_CANCELLED, "Cancel Reuest Accepted", func);
+		goto cleanup;
+	}
+	conn->status = CONN_EXECUTING;
+
+	if (!find_insert_values_list(pstmt->query, num_params, &lpos, &llen))
+	{
+		SC_set_error(self, STMT_INTERNAL_ERROR, "could not find the VALUES list of the INSERT statement", func);
+		goto cleanup;
+	}
+	max_rows = ci->insert_batch_rows;
+	if (max_rows > MAX_BIND_PARAMS / num_params)
+		max_rows = MAX_BIND_PARAMS / num_params;
+	batch_rows = malloc(sizeof(SQLLEN) * max_rows);
+	paramTypes = malloc(sizeof(Oid) * max_rows * num_params);
+	paramValues = calloc(max_rows * num_params, sizeof(char *));
+	paramLengths = malloc(sizeof(int) * max_rows * num_params);
+	paramFormats = malloc(sizeof(int) * max_rows * num_params);
+	if (!batch_rows || !paramTypes || !paramValues || !paramLengths || !paramFormats)
+	{
+		SC_set_error(self, STMT_NO_MEMORY_ERROR, "Could not allocate memory for the multi-row INSERT parameters", func);
+		goto cleanup;
+	}
+	in_trans = CC_is_in_trans(conn);
+	mylog("%s: stmt=%p rows " FORMAT_LEN "-" FORMAT_LEN " max_rows=%d\n", func, self, self->exec_current_row, end_row, max_rows);
+
+	/* the results are appended to the ones of the preceding rows */
+	for (last = SC_get_Result(self); NULL != last && NULL != last->next; last = last->next)
+		;
+	for (row = self->exec_current_row; row <= end_row && !failed && !row_failed;)
+	{
+		/* 1. Collect the parameters of a batch of rows */
+		nrows = 0;
+		nbytes = 0;
+		for (; row <= end_row && nrows < max_rows; row++)
+		{
+			int			nParams = 0, pidx = nrows * num_params;
+			Oid		   *rowTypes = NULL;
+			char	  **rowValues = NULL;
+			int		   *rowLengths = NULL;
+			int		   *rowFormats = NULL;
+
+			if (apdopts->param_operation_ptr &&
+				apdopts->param_operation_ptr[row] == SQL_PARAM_IGNORE)
+				continue;
+			if (nrows > 0 &&
+				ci->insert_batch_bytes > 0 &&
+				nbytes >= (size_t) ci->insert_batch_bytes)
+				break;
+			self->exec_current_row = row;
+			if (!build_libpq_bind_params(self,
+										 &nParams,
+										 &rowTypes,
+										 &rowValues,
+										 &rowLengths, &rowFormats,
+										 &resultFormat) ||
+				nParams != num_params)
+			{
+				libpq_free_bind_params(nParams, rowTypes, rowValues, rowLengths, rowFormats);
+				if (nrows > 0)
+				{
+					/*
+					 * Execute the rows collected first. The row fails
+					 * again as the first one of the next batch.
+					 */
+					SC_set_error(self, STMT_OK, NULL, NULL);
+					break;
+				}
+				if (SC_get_errornumber(self) <= 0)
+					SC_set_error(self, STMT_EXEC_ERROR, "the # of parameters of a row differs from the statement", func);
+				if (ipdopts->param_processed_ptr)
+					(*ipdopts->param_processed_ptr)++;
+				if (ipdopts->param_status_ptr)
+					ipdopts->param_status_ptr[row] = SQL_PARAM_ERROR;
+				self->diag_row_number = row + 1;
+				failed = TRUE;
+				break;
+			}
+			/* the batch takes over the values */
+			memcpy(paramTypes + pidx, rowTypes, sizeof(Oid) * num_params);
+			memcpy(paramValues + pidx, rowValues, sizeof(char *) * num_params);
+			memcpy(paramLengths + pidx, rowLengths, sizeof(int) * num_params);
+			memcpy(paramFormats + pidx, rowFormats, sizeof(int) * num_params);
+			libpq_free_bind_params(0, rowTypes, rowValues, rowLengths, rowFormats);
+			for (i = 0; i < num_params; i++)
+				nbytes += paramLengths[pidx + i];
+			batch_rows[nrows++] = row;
+		}
+		if (failed || 0 == nrows)
+			break;
+
+		/* 2. Execute them as one statement */
+		if (nrows != query_rows)
+		{
+			if (query)
+				free(query);
+			query_rows = nrows;
+			if (query = build_multirow_insert(pstmt->query, lpos, llen, num_params, nrows), NULL == query)
+			{
+				SC_set_error(self, STMT_NO_MEMORY_ERROR, "Could not allocate memory for the multi-row INSERT statement", func);
+				failed = TRUE;
+				break;
+			}
+		}
+		if (in_trans)
+		{
+			if (!exec_param_batch_svp(conn, svp_set ?
+						"RELEASE " PARAM_BATCH_SVP ";SAVEPOINT " PARAM_BATCH_SVP :
+						"SAVEPOINT " PARAM_BATCH_SVP))
+			{
+				SC_set_error(self, STMT_INTERNAL_ERROR, "internal savepoint error in SC_execute_multirow_insert", func);
+				failed = TRUE;
+				break;
+			}
+			svp_set = TRUE;
+		}
+		mylog("%s: %d rows to send\n", func, nrows);
+		pgres = PQexecParams(conn->pqconn,
+							 query,
+							 nrows * num_params,
+							 paramTypes,
+							 (const char **) paramValues,
+							 paramLengths,
+							 paramFormats,
+							 resultFormat);
+		for (i = 0; i < nrows * num_params; i++)
+		{
+			if (paramValues[i])
+			{
+				free(paramValues[i]);
+				paramValues[i] = NULL;
+			}
+		}
+
+		/* 3. Receive the result */
+		res = NULL;
+		if (!pgres ||
+			NULL == (res = QR_Constructor()) ||
+			!libpq_receive_result(self, res, &pgres, func) ||
+			!conn->pqconn)
+		{
+			if (pgres)
+				PQclear(pgres);
+			if (res)
+				QR_Destructor(res);
+			if (SC_get_errornumber(self) <= 0)
+				SC_set_error(self, STMT_NO_RESPONSE, "Could not receive the response, communication down ??", func);
+			if (conn->pqconn)
+				CC_on_abort(conn, CONN_DEAD);
+			failed = TRUE;
+			break;
+		}
+		PQclear(pgres);
+
+		if (QR_command_successful(res))
+			row_status = SQL_PARAM_SUCCESS;
+		else if (QR_command_nonfatal(res))
+		{
+			row_status = SQL_PARAM_SUCCESS_WITH_INFO;
+			with_info = TRUE;
+		}
+		else
+		{
+			/* 4. Find the failing rows of the batch */
+			QR_Destructor(res);
+			if (in_trans &&
+				!exec_param_batch_svp(conn, "ROLLBACK TO " PARAM_BATCH_SVP))
+			{
+				SC_set_error(self, STMT_INTERNAL_ERROR, "internal savepoint error in SC_execute_multirow_insert", func);
+				failed = TRUE;
+				break;
+			}
+			if (!SC_execute_rows_one_by_one(self, batch_rows, nrows,
+											&last, &row_failed, &with_info))
+				failed = TRUE;
+			continue;
+		}
+		for (i = 0; i < nrows; i++)
+		{
+			if (ipdopts->param_status_ptr)
+				ipdopts->param_status_ptr[batch_rows[i]] = row_status;
+			if (ipdopts->param_processed_ptr)
+				(*ipdopts->param_processed_ptr)++;
+		}
+
+		if (NULL == last)
+			SC_set_Result(self, res);
+		else
+		{
+			last->next = res;
+			self->curr_param_result = 1;
+		}
+		last = res;
+	}
+	/* a failed row has aborted the transaction, which discards the savepoint */
+	if (svp_set && !failed && !row_failed &&
+		!exec_param_batch_svp(conn, "RELEASE " PARAM_BATCH_SVP))
+	{
+		SC_set_error(self, STMT_INTERNAL_ERROR, "internal savepoint error in SC_execute_multirow_insert", func);
+		failed = TRUE;
+	}
+
+	if (NULL == SC_get_Curres(self))
+		SC_set_Curres(self, SC_get_Result(self));
+	if (failed || row_failed)
+	{
+		if (!SC_get_errormsg(self) || !SC_get_errormsg(self)[0])
+			SC_set_errormsg(self, "Error while executing the query");
+		ret = SQL_ERROR;
+	}
+	else if (with_info)
+		ret = SQL_SUCCESS_WITH_INFO;
+	else
+		ret = SQL_SUCCESS;
+
+cleanup:
+#undef	return
+	if (query)
+		free(query);
+	if (batch_rows)
+		free(batch_rows);
+	libpq_free_bind_params(paramValues ? max_rows * num_params : 0,
+						   paramTypes, paramValues, paramLengths, paramFormats);
+	self->exec_current_row = -1;
+	SC_SetExecuting(self, FALSE);
+	CLEANUP_FUNC_CONN_CS(func_cs_count, conn);
+	if (CONN_DOWN != conn->status)
+		conn->status = oldstatus;
+
+	return ret;
+}
+
+/*
+ * Size of the COPY data buffered before sending it to the server.
+ */
+#define	COPY_BUFFER_SIZE	65536
+
+/*
+ * Execute the remaining rows (from exec_current_row to end_row) of an
+ * array-bound single-row INSERT with one COPY ... FROM STDIN statement
+ * built by build_copy_from_insert(). The first row must have been
+ * executed by SC_execute(), as in SC_execute_multirow_insert().
+ *
+ * The parameter values are converted as usual and sent in COPY text
+ * format. If the COPY fails, the rows are executed again one by one as
+ * in SC_execute_multirow_insert(), in a transaction after rolling back
+ * to a savepoint set before the COPY, up to the first failing row. The
+ * rows after it are left SQL_PARAM_UNUSED as in the row by row
+ * execution.
+ */
+RETCODE
+SC_execute_copy_in(StatementClass *self, const char *copy_query, SQLLEN end_row)
+{
+	CSTR		func = "SC_execute_copy_in";
+	ConnectionClass	*conn = SC_get_conn(self);
+	APDFields	*apdopts = SC_get_APDF(self);
+	IPDFields	*ipdopts = SC_get_IPDF(self);
+	SQLLEN		start_row = self->exec_current_row, row, *rows = NULL;
+	char	   *buf = NULL;
+	size_t		buflen = COPY_BUFFER_SIZE, used = 0, need;
+	PGresult   *pgres = NULL;
+	QResultClass	*res = NULL, *last;
+	SQLUSMALLINT	row_status;
+	Int2		oldstatus;
+	BOOL		in_trans, sent = FALSE, copy_failed = FALSE;
+	BOOL		row_failed = FALSE, with_info = FALSE;
+	RETCODE		ret = SQL_ERROR;
+	int			i, nrows, func_cs_count = 0;
+
+#define	return	DONT_CALL_RETURN_FROM_HERE???
+	ENTER_INNER_CONN_CS(conn, func_cs_count);
+	oldstatus = conn->status;
+	if (CONN_EXECUTING == conn->status)
+	{
+		SC_set_error(self, STMT_SEQUENCE_ERROR, "Connection is already in use.", func);
+		mylog("%s: problem with connection\n", func);
+		goto cleanup;
+	}
+	if (!SC_SetExecuting(self, TRUE))
+	{
+		SC_set_error(self, STMT_OPERATION_CANCELLED, "Cancel Reuest Accepted", func);
+		goto cleanup;
+	}
+	conn->status = CONN_EXECUTING;
+
+	if (NULL == (buf = malloc(buflen)) ||
+		NULL == (res = QR_Constructor()))
+	{
+		SC_set_error(self, STMT_NO_MEMORY_ERROR, "Could not allocate memory for the COPY data", func);
+		goto cleanup;
+	}
+
+	/* 1. Start the COPY */
+	in_trans = CC_is_in_trans(conn);
+	if (in_trans &&
+		!exec_param_batch_svp(conn, "SAVEPOINT " PARAM_BATCH_SVP))
+	{
+		SC_set_error(self, STMT_INTERNAL_ERROR, "internal savepoint error in SC_execute_copy_in", func);
+		goto cleanup;
+	}
+	mylog("%s: stmt=%p rows " FORMAT_LEN "-" FORMAT_LEN " query=%s\n", func, self, start_row, end_row, copy_query);
+	pgres = PQexec(conn->pqconn, copy_query);
+	if (pgres && PQresultStatus(pgres) == PGRES_COPY_IN)
+	{
+		PQclear(pgres);
+		pgres = NULL;
+
+		/* 2. Send the rows */
+		for (row = start_row; row <= end_row; row++)
+		{
+			int			nParams = 0;
+			Oid		   *paramTypes = NULL;
+			char	  **paramValues = NULL;
+			int		   *paramLengths = NULL;
+			int		   *paramFormats = NULL;
+			int			resultFormat;
+
+			if (apdopts->param_operation_ptr &&
+				apdopts->param_operation_ptr[row] == SQL_PARAM_IGNORE)
+				continue;
+			self->exec_current_row = row;
+			if (!build_libpq_bind_params(self,
+										 &nParams,
+										 &paramTypes,
+										 &paramValues,
+										 &paramLengths, &paramFormats,
+										 &resultFormat))
+			{
+				libpq_free_bind_params(nParams, paramTypes, paramValues, paramLengths, paramFormats);
+				copy_failed = TRUE;
+				break;
+			}
+			for (i = 0, need = 1; i < nParams; i++)
+				need += 4 * (size_t) paramLengths[i] + 4;
+			if (used + need > buflen)
+			{
+				if (used > 0 && PQputCopyData(conn->pqconn, buf, (int) used) <= 0)
+					copy_failed = TRUE;
+				used = 0;
+				if (need > buflen)
+				{
+					char	*newbuf = realloc(buf, need);
+
+					if (newbuf)
+					{
+						buf = newbuf;
+						buflen = need;
+					}
+					else
+					{
+						SC_set_error(self, STMT_NO_MEMORY_ERROR, "Could not allocate memory for the COPY data", func);
+						copy_failed = TRUE;
+					}
+				}
+			}
+			if (!copy_failed)
+			{
+				for (i = 0; i < nParams; i++)
+				{
+					if (i > 0)
+						buf[used++] = '\t';
+					used += copy_text_from_param(buf + used, paramValues[i], paramLengths[i], paramFormats[i]);
+				}
+				buf[used++] = '\n';
+			}
+			libpq_free_bind_params(nParams, paramTypes, paramValues, paramLengths, paramFormats);
+			if (copy_failed)
+				break;
+		}
+		if (!copy_failed && used > 0 &&
+			PQputCopyData(conn->pqconn, buf, (int) used) <= 0)
+			copy_failed = TRUE;
+
+		/* 3. Finish it, or make the server abort it */
+		if (PQputCopyEnd(conn->pqconn, copy_failed ? "the conversion of a parameter failed" : NULL) <= 0)
+		{
+			SC_set_error(self, STMT_EXEC_ERROR, PQerrorMessage(conn->pqconn), func);
+			CC_on_abort(conn, CONN_DEAD);
+			goto cleanup;
+		}
+		sent = !copy_failed;
+		pgres = PQgetResult(conn->pqconn);
+	}
+
+	/* 4. Receive the result */
+	if (!pgres ||
+		!libpq_receive_result(self, res, &pgres, func) ||
+		!conn->pqconn)
+	{
+		if (SC_get_errornumber(self) <= 0)
+			SC_set_error(self, STMT_NO_RESPONSE, "Could not receive the response, communication down ??", func);
+		if (conn->pqconn)
+			CC_on_abort(conn, CONN_DEAD);
+		goto cleanup;
+	}
+	if (pgres)
+		PQclear(pgres);
+	while (pgres = PQgetResult(conn->pqconn), NULL != pgres)
+		PQclear(pgres);
+
+	/* the results are appended to the one of the first row */
+	for (last = SC_get_Result(self); NULL != last && NULL != last->next; last = last->next)
+		;
+	if (sent && QR_command_successful(res))
+		row_status = SQL_PARAM_SUCCESS;
+	else if (sent && QR_command_nonfatal(res))
+	{
+		row_status = SQL_PARAM_SUCCESS_WITH_INFO;
+		with_info = TRUE;
+	}
+	else
+	{
+		/* 5. Find the failing rows */
+		QR_Destructor(res);
+		res = NULL;
+		if (in_trans &&
+			!exec_param_batch_svp(conn, "ROLLBACK TO " PARAM_BATCH_SVP))
+		{
+			SC_set_error(self, STMT_INTERNAL_ERROR, "internal savepoint error in SC_execute_copy_in", func);
+			goto cleanup;
+		}
+		if (NULL == (rows = malloc(sizeof(SQLLEN) * (end_row - start_row + 1))))
+		{
+			SC_set_error(self, STMT_NO_MEMORY_ERROR, "Could not allocate memory for the COPY data", func);
+			goto cleanup;
+		}
+		for (row = start_row, nrows = 0; row <= end_row; row++)
+		{
+			if (apdopts->param_operation_ptr &&
+				apdopts->param_operation_ptr[row] == SQL_PARAM_IGNORE)
+				continue;
+			rows[nrows++] = row;
+		}
+		if (!SC_execute_rows_one_by_one(self, rows, nrows,
+										&last, &row_failed, &with_info))
+			goto cleanup;
+	}
+	if (NULL != res)
 	{
-		const char *plan_name;
-
-		if (stmt->prepared == PREPARING_PERMANENTLY)
+		for (row = start_row; row <= end_row; row++)
 		{
-			if (prepareParameters(stmt, FALSE) == SQL_ERROR)
-				goto cleanup;
+			if (apdopts->param_operation_ptr &&
+				apdopts->param_operation_ptr[row] == SQL_PARAM_IGNORE)
+				continue;
+			if (ipdopts->param_status_ptr)
+				ipdopts->param_status_ptr[row] = row_status;
+			if (ipdopts->param_processed_ptr)
+				(*ipdopts->param_processed_ptr)++;
+		}
+		if (NULL == last)
+			SC_set_Result(self, res);
+		else
+		{
+			last->next = res;
+			self->curr_param_result = 1;
 		}
+		res = NULL;
+	}
+	/* a failed row has aborted the transaction, which discards the savepoint */
+	if (in_trans && !row_failed &&
+		!exec_param_batch_svp(conn, "RELEASE " PARAM_BATCH_SVP))
+	{
+		SC_set_error(self, STMT_INTERNAL_ERROR, "internal savepoint error in SC_execute_copy_in", func);
+		goto cleanup;
+	}
+	if (NULL == SC_get_Curres(self))
+		SC_set_Curres(self, SC_get_Result(self));
 
-		/* prepareParameters() set plan name, so don't fetch this earlier */
-		plan_name = stmt->plan_name ? stmt->plan_name : "";
+	if (row_failed)
+	{
+		if (!SC_get_errormsg(self) || !SC_get_errormsg(self)[0])
+			SC_set_errormsg(self, "Error while executing the query");
+		ret = SQL_ERROR;
+	}
+	else if (with_info)
+		ret = SQL_SUCCESS_WITH_INFO;
+	else
+		ret = SQL_SUCCESS;
 
-		/* already prepared */
-		pgres = PQexecPrepared(conn->pqconn,
-							   plan_name, 	/* portal name == plan name */
-							   nParams,
-							   (const char **) paramValues, paramLengths, paramFormats,
-							   resultFormat);
+cleanup:
+#undef	return
+	if (pgres)
+		PQclear(pgres);
+	if (res)
+		QR_Destructor(res);
+	if (buf)
+		free(buf);
+	if (rows)
+		free(rows);
+	self->exec_current_row = -1;
+	SC_SetExecuting(self, FALSE);
+	CLEANUP_FUNC_CONN_CS(func_cs_count, conn);
+	if (CONN_DOWN != conn->status)
+		conn->status = oldstatus;
+
+	return ret;
+}
+
+#ifdef	LIBPQ_HAS_PIPELINING
+/*
+ * Max number of parameter rows sent in a pipeline before reading
+ * their results.
+ */
+#define	PIPELINE_BATCH_ROWS	256
+
+/*
+ * Send the current parameter row of an already prepared statement
+ * without waiting for the result.
+ */
+static BOOL
+libpq_send_param_row(StatementClass *stmt, const ProcessedStmt *pstmt,
+					 const char *plan_name)
+{
+	CSTR		func = "libpq_send_param_row";
+	ConnectionClass	*conn = SC_get_conn(stmt);
+	int			nParams = 0;
+	Oid		   *paramTypes = NULL;
+	char	  **paramValues = NULL;
+	int		   *paramLengths = NULL;
+	int		   *paramFormats = NULL;
+	int			resultFormat;
+	BOOL		ret = FALSE;
+
+	if (!build_libpq_bind_params(stmt,
+								 &nParams,
+								 &paramTypes,
+								 &paramValues,
+								 &paramLengths, &paramFormats,
+								 &resultFormat))
+		goto cleanup;
+
+	if (pstmt)
+		ret = PQsendQueryParams(conn->pqconn,
+								pstmt->query,
+								pstmt->num_params,
+								paramTypes,
+								(const char **) paramValues,
+								paramLengths,
+								paramFormats,
+								resultFormat);
+	else
+		ret = PQsendQueryPrepared(conn->pqconn,
+								  plan_name,
+								  nParams,
+								  (const char **) paramValues, paramLengths, paramFormats,
+								  resultFormat);
+	if (!ret)
+		SC_set_error(stmt, STMT_EXEC_ERROR, PQerrorMessage(conn->pqconn), func);
+
+cleanup:
+	libpq_free_bind_params(nParams, paramTypes, paramValues, paramLengths, paramFormats);
+
+	return ret;
+}
+
+/*
+ * Execute the remaining rows (from exec_current_row to end_row) of a
+ * parameter array in libpq pipeline mode. The first row must have been
+ * executed by SC_execute() so that the statement is already prepared
+ * and the transaction/savepoint handling is done.
+ *
+ * The rows are sent in batches of PIPELINE_BATCH_ROWS and the results
+ * are read back in order. As in the row by row execution, the first
+ * failing row ends the execution and the rows not executed are left
+ * SQL_PARAM_UNUSED. In autocommit mode every row is followed by a sync
+ * so that each row is committed separately, and the rows following the
+ * failing one in its batch, which were sent already, are executed. In a
+ * transaction the server skips them.
+ */
+RETCODE
+SC_execute_pipelined(StatementClass *self, SQLLEN end_row)
+{
+	CSTR		func = "SC_execute_pipelined";
+	ConnectionClass	*conn = SC_get_conn(self);
+	APDFields	*apdopts = SC_get_APDF(self);
+	IPDFields	*ipdopts = SC_get_IPDF(self);
+	const ProcessedStmt	*pstmt = NULL;
+	const char	*plan_name = NULL;
+	SQLLEN		sent_rows[PIPELINE_BATCH_ROWS];
+	SQLLEN		row;
+	int			nsent, nsyncs, i;
+	Int2		oldstatus;
+	BOOL		was_in_trans = FALSE, in_pipeline = FALSE, unsynced;
+	BOOL		failed = FALSE, row_failed = FALSE, with_info = FALSE;
+	PGresult   *pgres;
+	QResultClass	*res, *last;
+	RETCODE		ret = SQL_ERROR;
+	int			func_cs_count = 0;
+
+#define	return	DONT_CALL_RETURN_FROM_HERE???
+	ENTER_INNER_CONN_CS(conn, func_cs_count);
+	oldstatus = conn->status;
+	if (CONN_EXECUTING == conn->status)
+	{
+		SC_set_error(self, STMT_SEQUENCE_ERROR, "Connection is already in use.", func);
+		mylog("%s: problem with connection\n", func);
+		goto cleanup;
 	}
-	if (stmt->curr_param_result)
+	if (!SC_SetExecuting(self, TRUE))
 	{
-		for (res = SC_get_Result(stmt); NULL != res && NULL != res->next; res = res->next) ;
+		SC_set_error(self, STMT_OPERATION_CANCELLED, "Cancel Reuest Accepted", func);
+		goto cleanup;
 	}
+	conn->status = CONN_EXECUTING;
+
+	if (self->prepared == PREPARING_TEMPORARILY ||
+		(self->prepared == PREPARED_TEMPORARILY && conn->unnamed_prepared_stmt != self))
+		pstmt = self->processed_statements;
 	else
-		res = NULL;
+		plan_name = self->plan_name ? self->plan_name : "";
 
-	if (!res)
+	was_in_trans = CC_is_in_trans(conn);
+	if (!conn->pqconn || !PQenterPipelineMode(conn->pqconn))
 	{
-		newres = res = QR_Constructor();
-		if (!res)
-		{
-			SC_set_error(stmt, STMT_NO_MEMORY_ERROR, "Out of memory while allocating result set", func);
-			goto cleanup;
-		}
+		SC_set_error(self, STMT_EXEC_ERROR, "Could not enter pipeline mode", func);
+		goto cleanup;
 	}
+	in_pipeline = TRUE;
+	mylog("%s: stmt=%p rows " FORMAT_LEN "-" FORMAT_LEN "\n", func, self, self->exec_current_row, end_row);
 
-	/* 3. Receive results */
-inolog("get_Result=%p %p %d\n", res, SC_get_Result(stmt), stmt->curr_param_result);
-	pgresstatus = PQresultStatus(pgres);
-	switch (pgresstatus)
+	/* the results are appended to the ones of the preceding rows */
+	for (last = SC_get_Result(self); NULL != last && NULL != last->next; last = last->next)
+		;
+	for (row = self->exec_current_row; row <= end_row && !failed && !row_failed;)
 	{
-		case PGRES_COMMAND_OK:
-			/* portal query command, no tuples returned */
-			/* read in the return message from the backend */
-			cmdtag = PQcmdStatus(pgres);
-			mylog("command response: %s\n", cmdtag);
-			QR_set_command(res, cmdtag);
-			if (QR_command_successful(res))
-				QR_set_rstatus(res, PORES_COMMAND_OK);
+		/* 1. Send a batch of rows */
+		nsent = nsyncs = 0;
+		unsynced = FALSE;
+		for (; row <= end_row && nsent < PIPELINE_BATCH_ROWS; row++)
+		{
+			if (apdopts->param_operation_ptr &&
+				apdopts->param_operation_ptr[row] == SQL_PARAM_IGNORE)
+				continue;
+			self->exec_current_row = row;
+			if (!libpq_send_param_row(self, pstmt, plan_name))
+			{
+				if (ipdopts->param_processed_ptr)
+					(*ipdopts->param_processed_ptr)++;
+				if (ipdopts->param_status_ptr)
+					ipdopts->param_status_ptr[row] = SQL_PARAM_ERROR;
+				self->diag_row_number = row + 1;
+				failed = TRUE;
+				break;
+			}
+			sent_rows[nsent++] = row;
+			unsynced = TRUE;
+			if (!was_in_trans)
+			{
+				if (!PQpipelineSync(conn->pqconn))
+				{
+					failed = TRUE;
+					break;
+				}
+				nsyncs++;
+				unsynced = FALSE;
+			}
+		}
+		if (unsynced)
+		{
+			if (PQpipelineSync(conn->pqconn))
+				nsyncs++;
+			else
+				failed = TRUE;
+		}
 
-			/* get rowcount */
-			rowcount = PQcmdTuples(pgres);
-			if (rowcount && rowcount[0])
-				res->recent_processed_row_count = atoi(rowcount);
+		/* 2. Receive the results in order */
+		for (i = 0; i < nsent; i++)
+		{
+			pgres = PQgetResult(conn->pqconn);
+			if (pgres && PQresultStatus(pgres) == PGRES_PIPELINE_SYNC)
+			{
+				PQclear(pgres);
+				nsyncs--;
+				i--;
+				continue;
+			}
+			if (!pgres)
+			{
+				if (SC_get_errornumber(self) <= 0)
+					SC_set_error(self, STMT_NO_RESPONSE, "Could not receive the response, communication down ??", func);
+				CC_on_abort(conn, CONN_DEAD);
+				failed = TRUE;
+				goto cleanup;
+			}
+			if (PQresultStatus(pgres) == PGRES_PIPELINE_ABORTED)
+			{
+				/* skipped by the server because of a preceding error */
+				mylog("%s: row " FORMAT_LEN " was not executed\n", func, sent_rows[i]);
+				PQclear(pgres);
+			}
 			else
-				res->recent_processed_row_count = -1;
-			break;
+			{
+				if (ipdopts->param_processed_ptr)
+					(*ipdopts->param_processed_ptr)++;
+				res = QR_Constructor();
+				if (!res)
+				{
+					SC_set_error(self, STMT_NO_MEMORY_ERROR, "Out of memory while allocating result set", func);
+					PQclear(pgres);
+					CC_on_abort(conn, CONN_DEAD);
+					failed = TRUE;
+					goto cleanup;
+				}
+				if (!libpq_receive_result(self, res, &pgres, func) ||
+					!conn->pqconn)
+				{
+					if (pgres)
+						PQclear(pgres);
+					QR_Destructor(res);
+					if (SC_get_errornumber(self) <= 0)
+						SC_set_error(self, STMT_NO_RESPONSE, "Could not receive the response, communication down ??", func);
+					if (conn->pqconn)
+						CC_on_abort(conn, CONN_DEAD);
+					failed = TRUE;
+					goto cleanup;
+				}
+				if (pgres)
+					PQclear(pgres);
 
-		case PGRES_EMPTY_QUERY:
-			/* We return the empty query */
-			QR_set_rstatus(res, PORES_EMPTY_QUERY);
-			break;
-		case PGRES_NONFATAL_ERROR:
-			handle_pgres_error(conn, pgres, "libpq_bind_and_exec", res, FALSE);
-			break;
+				if (QR_command_successful(res))
+				{
+					if (ipdopts->param_status_ptr)
+						ipdopts->param_status_ptr[sent_rows[i]] = SQL_PARAM_SUCCESS;
+				}
+				else if (QR_command_nonfatal(res))
+				{
+					if (ipdopts->param_status_ptr)
+						ipdopts->param_status_ptr[sent_rows[i]] = SQL_PARAM_SUCCESS_WITH_INFO;
+					with_info = TRUE;
+				}
+				else
+				{
+					if (ipdopts->param_status_ptr)
+						ipdopts->param_status_ptr[sent_rows[i]] = SQL_PARAM_ERROR;
+					if (!row_failed)
+					{
+						SC_set_errornumber(self, STMT_ERROR_TAKEN_FROM_BACKEND);
+						self->diag_row_number = sent_rows[i] + 1;
+					}
+					row_failed = TRUE;
+				}
 
-		case PGRES_BAD_RESPONSE:
-		case PGRES_FATAL_ERROR:
-			handle_pgres_error(conn, pgres, "libpq_bind_and_exec", res, TRUE);
-			break;
-		case PGRES_TUPLES_OK:
-			if (!QR_from_PGresult(res, stmt, conn, NULL, &pgres))
-				goto cleanup;
-			if (res->rstatus == PORES_TUPLES_OK && res->notice)
-				QR_set_rstatus(res, PORES_NONFATAL_ERROR);
-			break;
-		case PGRES_COPY_OUT:
-		case PGRES_COPY_IN:
-		case PGRES_COPY_BOTH:
-		default:
-			/* skip the unexpected response if possible */
-			CC_set_error(conn, CONNECTION_BACKEND_CRAZY, "Unexpected protocol character from backend (send_query)", func);
-			CC_on_abort(conn, CONN_DEAD);
+				if (NULL == last)
+					SC_set_Result(self, res);
+				else
+				{
+					last->next = res;
+					self->curr_param_result = 1;
+				}
+				last = res;
+			}
+			/* the results of a query are terminated by NULL */
+			while (pgres = PQgetResult(conn->pqconn), NULL != pgres)
+				PQclear(pgres);
+		}
 
-			mylog("send_query: error - %s\n", CC_get_errormsg(conn));
-			break;
+		/* 3. Consume the remaining sync results */
+		for (; nsyncs > 0; nsyncs--)
+		{
+			pgres = PQgetResult(conn->pqconn);
+			if (!pgres)
+			{
+				if (SC_get_errornumber(self) <= 0)
+					SC_set_error(self, STMT_NO_RESPONSE, "Could not receive the response, communication down ??", func);
+				CC_on_abort(conn, CONN_DEAD);
+				failed = TRUE;
+				goto cleanup;
+			}
+			PQclear(pgres);
+		}
 	}
 
-	if (res != newres && NULL != newres)
-		QR_Destructor(newres);
-
-	ret = TRUE;
+	if (!PQexitPipelineMode(conn->pqconn))
+	{
+		SC_set_error(self, STMT_INTERNAL_ERROR, "Could not exit pipeline mode", func);
+		CC_on_abort(conn, CONN_DEAD);
+		failed = TRUE;
+		goto cleanup;
+	}
+	if (NULL == SC_get_Curres(self))
+		SC_set_Curres(self, SC_get_Result(self));
+	if (failed || row_failed)
+	{
+		if (!SC_get_errormsg(self) || !SC_get_errormsg(self)[0])
+			SC_set_errormsg(self, "Error while executing the query");
+		ret = SQL_ERROR;
+	}
+	else if (with_info)
+		ret = SQL_SUCCESS_WITH_INFO;
+	else
+		ret = SQL_SUCCESS;
 
 cleanup:
-	if (pgres)
-		PQclear(pgres);
-	if (paramValues)
+#undef	return
+	if (in_pipeline && conn->pqconn)
 	{
-		int			i;
-		for (i = 0; i < nParams; i++)
-		{
-			if (paramValues[i] != NULL)
-				free(paramValues[i]);
-		}
-		free(paramValues);
+		/*
+		 * The transaction status seen while the pipeline was busy
+		 * isn't reliable. Take it from the server now.
+		 */
+		if (!was_in_trans)
+			CC_set_no_trans(conn);
+		LIBPQ_update_transaction_status(conn);
 	}
-	if (paramTypes)
-		free(paramTypes);
-	if (paramLengths)
-		free(paramLengths);
-	if (paramFormats)
-		free(paramFormats);
+	self->exec_current_row = -1;
+	SC_SetExecuting(self, FALSE);
+	CLEANUP_FUNC_CONN_CS(func_cs_count, conn);
+	if (CONN_DOWN != conn->status)
+		conn->status = oldstatus;
 
-	if (ret)
-		return res;
-	else
-		return NULL;
+	return ret;
 }
+#endif /* LIBPQ_HAS_PIPELINING */
 
 /*
  * Parse a query using libpq.
@@ -2618,6 +4030,7 @@ ParseWithLibpq(StatementClass *stmt, const char *plan_name,
 	Oid		   *paramTypes = NULL;
 	BOOL		retval = FALSE;
 	PGresult   *pgres = NULL;
+	char		cached_plan_name[16];
 
 	mylog("%s: plan_name=%s query=%s\n", func, plan_name, query);
 	qlog("%s: plan_name=%s query=%s\n", func, plan_name, query);
@@ -2693,6 +4106,24 @@ mylog("sta_pidx=%d end_pidx=%d num_p=%d\n", sta_pidx, end_pidx, num_params);
 
 	if (plan_name == NULL || plan_name[0] == '\0')
 		conn->unnamed_prepared_stmt = NULL;
+	else if (conn->connInfo.prepared_cache_size > 0 &&
+		 NULL != stmt->processed_statements &&
+		 NULL == stmt->processed_statements->next)
+	{
+		const char	*cached_name;
+
+		/* Use the plan cached by the connection if any */
+		if (cached_name = CC_find_cached_plan(conn, query, num_params, paramTypes), NULL != cached_name)
+		{
+			mylog("%s: using the cached plan %s\n", func, cached_name);
+			SC_set_planname(stmt, cached_name);
+			SC_set_prepared(stmt, PREPARED_PERMANENTLY);
+			retval = TRUE;
+			goto cleanup;
+		}
+		CC_new_cached_plan_name(conn, cached_plan_name, sizeof(cached_plan_name));
+		plan_name = cached_plan_name;
+	}
 
 	/* Prepare */
 	pgres = PQprepare(conn->pqconn, plan_name, query, num_params, paramTypes);
@@ -2702,6 +4133,11 @@ mylog("sta_pidx=%d end_pidx=%d num_p=%d\n", sta_pidx, end_pidx, num_params);
 		goto cleanup;
 	}
 mylog("PQprepare was successful, plan=%s\n", plan_name ? plan_name : "");
+	if (plan_name == cached_plan_name)
+	{
+		SC_set_planname(stmt, cached_plan_name);
+		CC_add_cached_plan(conn, cached_plan_name, query, num_params, paramTypes);
+	}
 	if (stmt->plan_name)
 		SC_set_prepared(stmt, PREPARED_PERMANENTLY);
 	else
@@ -2749,6 +4185,7 @@ ParseAndDescribeWithLibpq(StatementClass *stmt, const char *plan_name,
 	int			i;
 	Oid			oid;
 	SQLSMALLINT paramType;
+	BOOL		named;
 
 	mylog("%s: plan_name=%s query=%s\n", func, plan_name, query_param);
 	qlog("%s: plan_name=%s query=%s\n", func, plan_name, query_param);
@@ -2763,8 +4200,12 @@ ParseAndDescribeWithLibpq(StatementClass *stmt, const char *plan_name,
 	 * server, while before we switched to use libpq, we used to send a Parse
 	 * and Describe message followed by a single Sync.
 	 */
+	named = (NULL != plan_name && '\0' != plan_name[0]);
 	if (!ParseWithLibpq(stmt, plan_name, query_param, num_params, comment, res))
 		goto cleanup;
+	/* The plan may be a cached one */
+	if (named)
+		plan_name = stmt->plan_name;
 
 	/* Describe */
 	mylog("%s: describing plan_name=%s\n", func, plan_name);
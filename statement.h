@@ -231,6 +231,8 @@ struct StatementClass_
 	SQLLEN		last_fetch_count;	/* number of rows retrieved in
 						 * last fetch/extended fetch */
 	int		lobj_fd;		/* fd of the current large object */
+	SQLLEN		lobj_size;		/* size of the large object read by lo_get() */
+	QResultClass	*lobj_heads;		/* first bytes of the large objects of the rowset */
 
 	char	   *statement;		/* if non--null pointer to the SQL
 					 * statement that has been executed */
@@ -270,6 +272,7 @@ struct StatementClass_
 	po_ind_t	join_info;	/* have joins ? */
 	po_ind_t	parse_method;	/* parse_statement is forced or ? */
 	po_ind_t	curr_param_result; /* current param result is set ? */
+	po_ind_t	binary_result;	/* can receive the rows in binary format ? */
 	pgNAME		cursor_name;
 	char		*plan_name;
 
@@ -282,6 +285,7 @@ struct StatementClass_
 	unsigned char	miscinfo;
 	po_ind_t	updatable;
 	SQLLEN		diag_row_count;
+	SQLLEN		diag_row_number;	/* the failing row of a parameter array */
 	char		*load_statement; /* to (re)load updatable individual rows */
 	ssize_t		from_pos;
 	ssize_t		where_pos;
@@ -293,6 +297,9 @@ struct StatementClass_
 	UInt2		allocated_callbacks;
 	UInt2		num_callbacks;
 	NeedDataCallback	*callbacks;
+	Int2		conn_slot;	/* index in hdbc->stmts */
+	StatementClass	*next_pooled;	/* in the pool of dropped statements */
+	char		columnwise_fetch; /* SC_fetch() leaves the bound columns to SC_fetch_columnwise() */
 #if defined(WIN_MULTITHREAD_SUPPORT)
 	CRITICAL_SECTION	cs;
 #elif defined(POSIX_THREADMUTEX_SUPPORT)
@@ -434,6 +441,8 @@ enum
 	(SC_get_APDF(a)->paramset_size <= 1 &&								\
 	 (STMT_TYPE_SELECT == (a)->statement_type || STMT_TYPE_WITH == (a)->statement_type) )
 #define SC_may_fetch_rows(a) (STMT_TYPE_SELECT == (a)->statement_type || STMT_TYPE_WITH == (a)->statement_type)
+/* the query was sent by the previous call which returned SQL_STILL_EXECUTING */
+#define SC_is_async_running(a) (SC_get_conn(a)->async_stmt == SC_get_ancestor(a))
 
 
 /* For Multi-thread */
@@ -484,7 +493,11 @@ void		SC_set_rowset_start(StatementClass *self, SQLLEN, BOOL);
 void		SC_inc_rowset_start(StatementClass *self, SQLLEN);
 RETCODE		SC_initialize_stmts(StatementClass *self, BOOL);
 RETCODE		SC_execute(StatementClass *self);
+RETCODE		SC_execute_multirow_insert(StatementClass *self, SQLLEN end_row);
+RETCODE		SC_execute_copy_in(StatementClass *self, const char *copy_query, SQLLEN end_row);
+RETCODE		SC_execute_pipelined(StatementClass *self, SQLLEN end_row);
 RETCODE		SC_fetch(StatementClass *self);
+RETCODE		SC_fetch_columnwise(StatementClass *self, SQLLEN nrows, SQLLEN *error_row);
 void		SC_free_params(StatementClass *self, char option);
 void		SC_log_error(const char *func, const char *desc, const StatementClass *self);
 time_t		SC_get_time(StatementClass *self);
@@ -509,6 +522,7 @@ int		enqueueNeedDataCallback(StatementClass *self, NeedDataCallfunc, void *);
 RETCODE		dequeueNeedDataCallback(RETCODE, StatementClass *self);
 void		cancelNeedDataState(StatementClass *self);
 int		StartRollbackState(StatementClass *self);
+void		SC_unlink_putdata_lo(StatementClass *self);
 RETCODE		SetStatementSvp(StatementClass *self);
 RETCODE		DiscardStatementSvp(StatementClass *self, RETCODE, BOOL errorOnly);
 
@@ -521,7 +535,7 @@ QResultClass *ParseAndDescribeWithLibpq(StatementClass *stmt, const char *plan_n
 #define	SC_get_rowset_start(stmt) (stmt->rowset_start)
 #define	GIdx2RowIdx(gidx, stmt)	(gidx - stmt->rowset_start)
 /* a global index to the relative index in a resultset(not a rowset) */
-#define	GIdx2CacheIdx(gidx, s, r)	(gidx - (QR_has_valid_base(r) ? (s->rowset_start - r->base) : 0))
+#define	GIdx2CacheIdx(gidx, s, r)	(gidx - (QR_has_valid_base(r) ? (s->rowset_start - r->base) : r->stream_base))
 #define	GIdx2KResIdx(gidx, s, r)	(gidx - (QR_has_valid_base(r) ? (s->rowset_start - r->key_base) : 0))
 /* a relative index in a rowset to the global index */
 #define	RowIdx2GIdx(ridx, stmt)	(ridx + stmt->rowset_start)
@@ -0,0 +1,412 @@
+/*
+ * Micro-benchmark of the conversion layer of the driver.
+ *
+ * This doesn't need a server. convert.c is included here, so that its
+ * static functions can be called directly, and the program is linked
+ * with the other objects of the driver (see "make bench" in
+ * test/Makefile.in).
+ *
+ * Every benchmark converts a synthetic dataset of values over and over,
+ * and reports the best time per value of a few runs. The results can be
+ * saved as a baseline, and compared with it later:
+ *
+ *   conversion-bench [-r runs] [-t tolerance%] [-w baseline] [-c baseline] [name ...]
+ *
+ * With -c, a benchmark slower than the baseline by more than the tolerance
+ * (20% by default) is reported as a regression, and the exit status is 1.
+ */
+#include "../../convert.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef	WIN32
+#include <time.h>
+#endif /* WIN32 */
+
+#define	NUM_VALUES	1000		/* the size of a dataset */
+#define	TARGET_NSEC	50000000.0	/* the duration of a run */
+
+typedef struct
+{
+	const char *name;
+	void	(*setup)(void);
+	/* converts the i'th value of the dataset */
+	void	(*convert)(int i);
+} Benchmark;
+
+static ConnectionClass *conn;
+static StatementClass *stmt;
+static char	*values[NUM_VALUES];
+static char	outbuf[1024];
+static SQLLEN	outlen;
+#ifdef	UNICODE_SUPPORT
+static SQLWCHAR	woutbuf[512];
+#endif /* UNICODE_SUPPORT */
+static QueryBuild qb;
+static QueryParse qp;
+
+static double
+now_nsec(void)
+{
+#ifdef	WIN32
+	LARGE_INTEGER	freq, count;
+
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (double) count.QuadPart * 1e9 / (double) freq.QuadPart;
+#else
+	struct timespec	ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+#endif /* WIN32 */
+}
+
+/* make the dataset of 'format' with a pseudo-random number below 'modulo' */
+static void
+set_values(const char *format, int modulo)
+{
+	char	buf[256];
+	int	i;
+
+	for (i = 0; i < NUM_VALUES; i++)
+	{
+		free(values[i]);
+		snprintf(buf, sizeof(buf), format, (i * 7919) % modulo);
+		values[i] = strdup(buf);
+	}
+}
+
+/*
+ * copy_and_convert_field()
+ */
+static void setup_int4(void) { set_values("%d", 1000000); }
+static void setup_numeric(void) { set_values("%d.625", 100000); }
+static void setup_timestamp(void) { set_values("2016-02-1%d 12:34:56.789", 10); }
+static void setup_text(void) { set_values("a text value of %d characters or so", 1000); }
+#ifdef	UNICODE_SUPPORT
+static void setup_utf8(void) { set_values("\xc3\xa9t\xc3\xa9 %d \xe2\x82\xac, \xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e", 1000); }
+static void setup_lines(void) { set_values("line %d\nline two\nline three\n", 1000); }
+#endif /* UNICODE_SUPPORT */
+
+static void
+cvt_field(int i, OID type, SQLSMALLINT ctype, PTR buf, SQLLEN buflen)
+{
+	SC_set_current_col(stmt, -1);
+	copy_and_convert_field(stmt, type, -1, values[i], ctype, 0,
+						   buf, buflen, &outlen, &outlen);
+}
+
+static void cvt_int4_slong(int i) { cvt_field(i, PG_TYPE_INT4, SQL_C_SLONG, outbuf, 0); }
+static void cvt_numeric_double(int i) { cvt_field(i, PG_TYPE_NUMERIC, SQL_C_DOUBLE, outbuf, 0); }
+static void cvt_timestamp(int i) { cvt_field(i, PG_TYPE_TIMESTAMP_NO_TMZONE, SQL_C_TYPE_TIMESTAMP, outbuf, 0); }
+static void cvt_text_char(int i) { cvt_field(i, PG_TYPE_TEXT, SQL_C_CHAR, outbuf, sizeof(outbuf)); }
+#ifdef	UNICODE_SUPPORT
+static void cvt_text_wchar(int i) { cvt_field(i, PG_TYPE_TEXT, SQL_C_WCHAR, woutbuf, sizeof(woutbuf)); }
+#endif /* UNICODE_SUPPORT */
+
+/*
+ * copy_and_convert_field_bindinfo(), with the conversion plan of a
+ * bound column
+ */
+static void
+bind_column(SQLSMALLINT ctype)
+{
+	ARDFields	*opts = SC_get_ARDF(stmt);
+
+	extend_column_bindings(opts, 1);
+	opts->bindings[0].buffer = outbuf;
+	opts->bindings[0].buflen = sizeof(outbuf);
+	opts->bindings[0].used =
+	opts->bindings[0].indicator = &outlen;
+	opts->bindings[0].returntype = ctype;
+	opts->bindings[0].plan.compiled = FALSE;
+	stmt->bind_row = 0;
+}
+
+static void setup_bound_int4(void) { setup_int4(); bind_column(SQL_C_SLONG); }
+static void setup_bound_timestamp(void) { setup_timestamp(); bind_column(SQL_C_TYPE_TIMESTAMP); }
+static void bound_int4(int i) { copy_and_convert_field_bindinfo(stmt, PG_TYPE_INT4, -1, values[i], 0, FALSE); }
+static void bound_timestamp(int i) { copy_and_convert_field_bindinfo(stmt, PG_TYPE_TIMESTAMP_NO_TMZONE, -1, values[i], 0, FALSE); }
+
+/*
+ * timestamp2stime() and parse_to_numeric_struct()
+ */
+static void
+cvt_timestamp2stime(int i)
+{
+	SIMPLE_TIME	st;
+	BOOL	bZone = FALSE;
+	int	zone;
+
+	timestamp2stime(values[i], &st, &bZone, &zone);
+}
+
+static void
+cvt_numeric_struct(int i)
+{
+	SQL_NUMERIC_STRUCT	ns;
+	BOOL	overflow;
+
+	parse_to_numeric_struct(values[i], &ns, &overflow);
+}
+
+/*
+ * utf8_to_ucs2_lf()
+ */
+#ifdef	UNICODE_SUPPORT
+static void cvt_utf8_ucs2(int i) { utf8_to_ucs2_lf(values[i], SQL_NTS, FALSE, woutbuf, sizeof(woutbuf) / sizeof(woutbuf[0]), FALSE); }
+static void cvt_utf8_ucs2_lf(int i) { utf8_to_ucs2_lf(values[i], SQL_NTS, TRUE, woutbuf, sizeof(woutbuf) / sizeof(woutbuf[0]), FALSE); }
+#endif /* UNICODE_SUPPORT */
+
+/*
+ * ResolveOneParam() and convert_escape(), on a statement of the values
+ */
+static SQLINTEGER	int_param;
+static char	char_param[64];
+static SQLLEN	char_param_len = SQL_NTS;
+
+static void
+setup_query(const char *query)
+{
+	QB_Destructor(&qb);
+	free(stmt->statement);
+	stmt->statement = strdup(query);
+	QP_initialize(&qp, stmt);
+	QB_initialize(&qb, qp.stmt_len, stmt, RPM_REPLACE_PARAMS);
+}
+
+static void
+setup_int_param(void)
+{
+	PGAPI_BindParameter(stmt, 1, SQL_PARAM_INPUT, SQL_C_SLONG, SQL_INTEGER, 0, 0, &int_param, 0, NULL);
+	setup_query("?");
+}
+
+static void
+setup_char_param(void)
+{
+	strcpy(char_param, "it's a parameter");
+	PGAPI_BindParameter(stmt, 1, SQL_PARAM_INPUT, SQL_C_CHAR, SQL_VARCHAR, sizeof(char_param), 0, char_param, sizeof(char_param), &char_param_len);
+	setup_query("?");
+}
+
+static void
+resolve_param(int i)
+{
+	BOOL	isnull, isbinary;
+	OID	pgtype;
+
+	int_param = i;
+	qb.npos = 0;
+	qb.param_number = -1;
+	qp.opos = 0;
+	ResolveOneParam(&qb, &qp, &isnull, &isbinary, &pgtype);
+}
+
+static void setup_escape_fn(void) { setup_query("{fn UCASE('abc')}"); }
+static void setup_escape_date(void) { setup_query("{d '2001-02-03'}"); }
+static void setup_escape_ts(void) { setup_query("{ts '2001-02-03 04:05:06.789'}"); }
+
+static void
+cvt_escape(int i)
+{
+	qb.npos = 0;
+	qp.opos = 0;
+	convert_escape(&qp, &qb);
+}
+
+static const Benchmark benchmarks[] =
+{
+	{"field_int4_slong", setup_int4, cvt_int4_slong},
+	{"field_numeric_double", setup_numeric, cvt_numeric_double},
+	{"field_timestamp", setup_timestamp, cvt_timestamp},
+	{"field_text_char", setup_text, cvt_text_char},
+#ifdef	UNICODE_SUPPORT
+	{"field_text_wchar", setup_utf8, cvt_text_wchar},
+#endif /* UNICODE_SUPPORT */
+	{"bound_int4_slong", setup_bound_int4, bound_int4},
+	{"bound_timestamp", setup_bound_timestamp, bound_timestamp},
+	{"timestamp2stime", setup_timestamp, cvt_timestamp2stime},
+	{"parse_to_numeric_struct", setup_numeric, cvt_numeric_struct},
+#ifdef	UNICODE_SUPPORT
+	{"utf8_to_ucs2_ascii", setup_text, cvt_utf8_ucs2},
+	{"utf8_to_ucs2_utf8", setup_utf8, cvt_utf8_ucs2},
+	{"utf8_to_ucs2_lf", setup_lines, cvt_utf8_ucs2_lf},
+#endif /* UNICODE_SUPPORT */
+	{"resolve_param_int", setup_int_param, resolve_param},
+	{"resolve_param_char", setup_char_param, resolve_param},
+	{"convert_escape_fn", setup_escape_fn, cvt_escape},
+	{"convert_escape_date", setup_escape_date, cvt_escape},
+	{"convert_escape_ts", setup_escape_ts, cvt_escape}
+};
+
+#define	NUM_BENCHMARKS	(sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+/* the best time per value of 'runs' runs */
+static double
+run_benchmark(const Benchmark *bm, int runs)
+{
+	double	best = -1, start, elapsed;
+	long	loops = 1, l;
+	int	r, i;
+
+	bm->setup();
+	/* find a number of loops taking about TARGET_NSEC */
+	for (;;)
+	{
+		start = now_nsec();
+		for (l = 0; l < loops; l++)
+			for (i = 0; i < NUM_VALUES; i++)
+				bm->convert(i);
+		elapsed = now_nsec() - start;
+		if (elapsed >= TARGET_NSEC / 10)
+			break;
+		loops *= 2;
+	}
+	loops = (long) (loops * TARGET_NSEC / elapsed) + 1;
+	for (r = 0; r < runs; r++)
+	{
+		start = now_nsec();
+		for (l = 0; l < loops; l++)
+			for (i = 0; i < NUM_VALUES; i++)
+				bm->convert(i);
+		elapsed = (now_nsec() - start) / ((double) loops * NUM_VALUES);
+		if (best < 0 || elapsed < best)
+			best = elapsed;
+	}
+	return best;
+}
+
+/* the result of 'name' in the baseline file, or -1 */
+static double
+baseline_result(const char *file, const char *name)
+{
+	FILE	*fp;
+	char	line[256], bname[128];
+	double	result = -1, nsec;
+
+	if (NULL == file || NULL == (fp = fopen(file, "r")))
+		return -1;
+	while (NULL != fgets(line, sizeof(line), fp))
+	{
+		if ('#' == line[0])
+			continue;
+		if (2 == sscanf(line, "%127s %lf", bname, &nsec) &&
+			0 == strcmp(bname, name))
+		{
+			result = nsec;
+			break;
+		}
+	}
+	fclose(fp);
+	return result;
+}
+
+/* is 'name' one of the names from argv[first], or are there none? */
+static BOOL
+selected(const char *name, int argc, char **argv, int first)
+{
+	int	i;
+
+	if (first >= argc)
+		return TRUE;
+	for (i = first; i < argc; i++)
+	{
+		if (0 == strcmp(argv[i], name))
+			return TRUE;
+	}
+	return FALSE;
+}
+
+int
+main(int argc, char **argv)
+{
+	const char *write_file = NULL, *compare_file = NULL;
+	FILE	*wfp = NULL;
+	int	runs = 5, tolerance = 20, regressions = 0, i;
+	size_t	b;
+
+	for (i = 1; i < argc && '-' == argv[i][0]; i++)
+	{
+		if (i + 1 >= argc)
+			break;
+		switch (argv[i][1])
+		{
+			case 'r':
+				runs = atoi(argv[++i]);
+				break;
+			case 't':
+				tolerance = atoi(argv[++i]);
+				break;
+			case 'w':
+				write_file = argv[++i];
+				break;
+			case 'c':
+				compare_file = argv[++i];
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-r runs] [-t tolerance%%] [-w baseline] [-c baseline] [name ...]\n", argv[0]);
+				return 2;
+		}
+	}
+	if (runs <= 0)
+		runs = 1;
+	if (NULL != write_file &&
+		NULL == (wfp = fopen(write_file, "w")))
+	{
+		fprintf(stderr, "could not open %s\n", write_file);
+		return 2;
+	}
+
+	conn = CC_Constructor();
+	stmt = SC_Constructor(conn);
+	if (NULL == conn || NULL == stmt)
+	{
+		fprintf(stderr, "could not create the statement\n");
+		return 2;
+	}
+	QB_initialize(&qb, 0, stmt, RPM_REPLACE_PARAMS);
+
+	printf("%-28s %10s %10s\n", "benchmark", "ns/value", "baseline");
+	if (wfp)
+		fprintf(wfp, "# benchmark ns/value\n");
+	for (b = 0; b < NUM_BENCHMARKS; b++)
+	{
+		const Benchmark *bm = benchmarks + b;
+		double	nsec, base;
+
+		if (!selected(bm->name, argc, argv, i))
+			continue;
+		nsec = run_benchmark(bm, runs);
+		base = baseline_result(compare_file, bm->name);
+		if (base > 0)
+		{
+			BOOL	regressed = (nsec > base * (100 + tolerance) / 100);
+
+			printf("%-28s %10.1f %10.1f %+6.1f%%%s\n", bm->name, nsec, base,
+				   (nsec - base) * 100 / base, regressed ? " REGRESSION" : "");
+			if (regressed)
+				regressions++;
+		}
+		else
+			printf("%-28s %10.1f %10s\n", bm->name, nsec, "-");
+		if (wfp)
+			fprintf(wfp, "%s %.1f\n", bm->name, nsec);
+		fflush(stdout);
+	}
+	if (wfp)
+		fclose(wfp);
+
+	QB_Destructor(&qb);
+	SC_Destructor(stmt);
+	CC_Destructor(conn);
+
+	if (regressions > 0)
+	{
+		printf("%d regression(s) over %d%%\n", regressions, tolerance);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * Test asynchronous execution (SQL_ATTR_ASYNC_ENABLE).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+/* repeat SQLExecDirect until it doesn't return SQL_STILL_EXECUTING */
+static SQLRETURN
+exec_direct_wait(HSTMT hstmt, char *sql)
+{
+	SQLRETURN	rc;
+
+	while ((rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS)) == SQL_STILL_EXECUTING)
+		;
+	return rc;
+}
+
+static void
+print_async_enable(HSTMT hstmt)
+{
+	SQLRETURN	rc;
+	SQLULEN		value = 0;
+
+	rc = SQLGetStmtAttr(hstmt, SQL_ATTR_ASYNC_ENABLE, &value, 0, NULL);
+	CHECK_STMT_RESULT(rc, "SQLGetStmtAttr failed", hstmt);
+	printf("SQL_ATTR_ASYNC_ENABLE: %s\n", value == SQL_ASYNC_ENABLE_ON ? "on" : "off");
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	HSTMT		hstmt2 = SQL_NULL_HSTMT;
+	char	   *sql;
+	char		param[20] = "param value";
+	SQLLEN		cbParam = SQL_NTS;
+
+	test_connect();
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt2);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ASYNC_ENABLE, (SQLPOINTER) SQL_ASYNC_ENABLE_ON, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	print_async_enable(hstmt);
+
+	/* The first call returns before the query completes */
+	printf("executing a slow query\n");
+	sql = "SELECT 'async result' FROM pg_sleep(0.5)";
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	if (rc == SQL_STILL_EXECUTING)
+		printf("SQLExecDirect returned SQL_STILL_EXECUTING\n");
+
+	/* The connection can't be used by other statements meanwhile */
+	rc = SQLExecDirect(hstmt2, (SQLCHAR *) "SELECT 'other statement'", SQL_NTS);
+	if (!SQL_SUCCEEDED(rc))
+		printf("another statement failed as expected\n");
+	rc = exec_direct_wait(hstmt, sql);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	rc = SQLExecDirect(hstmt2, (SQLCHAR *) "SELECT 'other statement'", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt2);
+	print_result(hstmt2);
+	rc = SQLFreeStmt(hstmt2, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt2);
+
+	/* A prepared statement with a parameter */
+	printf("executing a prepared statement\n");
+	rc = SQLPrepare(hstmt, (SQLCHAR *) "SELECT ?::text FROM pg_sleep(0.5)", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrepare failed", hstmt);
+	rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT,
+						  SQL_C_CHAR,	/* value type */
+						  SQL_CHAR,		/* param type */
+						  20,			/* column size */
+						  0,			/* dec digits */
+						  param,		/* param value ptr */
+						  0,			/* buffer len */
+						  &cbParam		/* StrLen_or_IndPtr */);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	rc = SQLExecute(hstmt);
+	if (rc == SQL_STILL_EXECUTING)
+		printf("SQLExecute returned SQL_STILL_EXECUTING\n");
+	while (rc == SQL_STILL_EXECUTING)
+		rc = SQLExecute(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLExecute failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_RESET_PARAMS);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Cancel a running query */
+	printf("canceling a slow query\n");
+	sql = "SELECT 'not reached' FROM pg_sleep(10)";
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	if (rc == SQL_STILL_EXECUTING)
+	{
+		rc = SQLCancel(hstmt);
+		CHECK_STMT_RESULT(rc, "SQLCancel failed", hstmt);
+		rc = exec_direct_wait(hstmt, sql);
+	}
+	if (rc == SQL_ERROR)
+		printf("the query was canceled\n");
+	else
+		printf("SQLExecDirect returned %d\n", (int) rc);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	rc = exec_direct_wait(hstmt, "SELECT 'after cancel'");
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* The connection attribute applies to the existing statements */
+	rc = SQLSetConnectAttr(conn, SQL_ATTR_ASYNC_ENABLE, (SQLPOINTER) SQL_ASYNC_ENABLE_OFF, 0);
+	CHECK_CONN_RESULT(rc, "SQLSetConnectAttr failed", conn);
+	print_async_enable(hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT 'synchronous' FROM pg_sleep(0.1)", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
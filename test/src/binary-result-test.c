@@ -0,0 +1,97 @@
+/*
+ * Test receiving the results of prepared statements in binary format
+ * (AB=0x200). The first execution gets the text format, the following
+ * ones the binary format, so the outputs should match.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static const char *sql =
+	"SELECT i, i::int2 AS s, i::int8 * 10000000000 AS b, i / 3.0::float8 AS f8,"
+	" (i / 4.0)::float4 AS f4, i % 2 = 0 AS bo,"
+	" '2000-01-01'::date + i * 1000 AS d,"
+	" '1999-12-31 23:59:59.25'::timestamp + i * interval '1 day 1.5 sec' AS ts,"
+	" ('00112233-4455-6677-8899-aabbccddeef' || (i + 1))::uuid AS u,"
+	" 'text ' || i AS t, ('bp' || i)::char(5) AS bp"
+	" FROM generate_series(-1, ?) i";
+
+static void
+execute_and_print(HSTMT hstmt, SQLINTEGER n)
+{
+	SQLRETURN	rc;
+	SQLINTEGER	ival;
+	SQLBIGINT	bval;
+	SQLDOUBLE	dval;
+	SQL_TIMESTAMP_STRUCT tsval;
+	SQLLEN		ind[4];
+
+	rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_SLONG,
+						  SQL_INTEGER, 0, 0, &n, 0, NULL);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+
+	/* GetData */
+	rc = SQLExecute(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLExecute failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* bound columns */
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, &ival, 0, &ind[0]);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 3, SQL_C_SBIGINT, &bval, 0, &ind[1]);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 4, SQL_C_DOUBLE, &dval, 0, &ind[2]);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 8, SQL_C_TYPE_TIMESTAMP, &tsval, 0, &ind[3]);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+
+	rc = SQLExecute(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLExecute failed", hstmt);
+	while (SQL_SUCCEEDED(rc = SQLFetch(hstmt)))
+	{
+		printf("%d %s %.10f %04d-%02d-%02d %02d:%02d:%02d.%09d\n",
+			   (int) ival,
+			   bval == (SQLBIGINT) ival * 10000000000 ? "ok" : "wrong bigint",
+			   dval,
+			   tsval.year, tsval.month, tsval.day,
+			   tsval.hour, tsval.minute, tsval.second, (int) tsval.fraction);
+	}
+	if (rc != SQL_NO_DATA)
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_UNBIND);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN rc;
+	HSTMT hstmt = SQL_NULL_HSTMT;
+
+	test_connect_ext("AB=0x200;UseServerSidePrepare=1");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	rc = SQLPrepare(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrepare failed", hstmt);
+
+	printf("first execution\n");
+	execute_and_print(hstmt, 2);
+	printf("second execution\n");
+	execute_and_print(hstmt, 3);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
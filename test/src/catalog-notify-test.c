@@ -0,0 +1,96 @@
+/*
+ * Test evicting the cached column info of the tables altered by other
+ * connections (AB=0x2000). An event trigger notifies the oids of the
+ * changed tables on the psqlodbc_catalog channel.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static HSTMT hstmt = SQL_NULL_HSTMT;
+static HDBC conn2 = SQL_NULL_HDBC;
+static HSTMT hstmt2 = SQL_NULL_HSTMT;
+
+static void
+exec_direct(HSTMT hstmt, const char *sql)
+{
+	SQLRETURN	rc;
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+static void
+describe_columns(void)
+{
+	SQLRETURN	rc;
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT id, t FROM catalog_notify_test", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result_meta(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+
+	test_connect_ext("Parse=1;AB=0x2000");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	/* Another connection alters the table */
+	SQLAllocHandle(SQL_HANDLE_DBC, env, &conn2);
+	rc = SQLDriverConnect(conn2, NULL, (SQLCHAR *) "DSN=psqlodbc_test_dsn", SQL_NTS,
+						  NULL, 0, NULL, SQL_DRIVER_NOPROMPT);
+	CHECK_CONN_RESULT(rc, "SQLDriverConnect failed", conn2);
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn2, &hstmt2);
+	CHECK_CONN_RESULT(rc, "failed to allocate stmt handle", conn2);
+
+	exec_direct(hstmt2, "DROP EVENT TRIGGER IF EXISTS psqlodbc_catalog_notify");
+	exec_direct(hstmt2,
+		"CREATE OR REPLACE FUNCTION psqlodbc_catalog_notify() RETURNS event_trigger AS $$\n"
+		"DECLARE oids text;\n"
+		"BEGIN\n"
+		"  SELECT string_agg(DISTINCT objid::text, ',') INTO oids\n"
+		"    FROM pg_event_trigger_ddl_commands() WHERE classid = 'pg_class'::regclass;\n"
+		"  IF oids IS NOT NULL THEN\n"
+		"    PERFORM pg_notify('psqlodbc_catalog', oids);\n"
+		"  END IF;\n"
+		"END $$ LANGUAGE plpgsql");
+	exec_direct(hstmt2, "CREATE EVENT TRIGGER psqlodbc_catalog_notify ON ddl_command_end EXECUTE PROCEDURE psqlodbc_catalog_notify()");
+	exec_direct(hstmt2, "DROP TABLE IF EXISTS catalog_notify_test");
+	exec_direct(hstmt2, "CREATE TABLE catalog_notify_test (id integer PRIMARY KEY, t varchar(20))");
+
+	printf("describing the table\n");
+	describe_columns();
+	describe_columns();
+
+	printf("altering the table in another connection\n");
+	exec_direct(hstmt2, "ALTER TABLE catalog_notify_test ALTER COLUMN t TYPE varchar(40)");
+	describe_columns();
+
+	printf("altering the table again\n");
+	exec_direct(hstmt2, "ALTER TABLE catalog_notify_test ALTER COLUMN t TYPE varchar(60)");
+	describe_columns();
+
+	/* Clean up */
+	exec_direct(hstmt2, "DROP TABLE catalog_notify_test");
+	exec_direct(hstmt2, "DROP EVENT TRIGGER psqlodbc_catalog_notify");
+	exec_direct(hstmt2, "DROP FUNCTION psqlodbc_catalog_notify()");
+	SQLFreeHandle(SQL_HANDLE_STMT, hstmt2);
+	SQLDisconnect(conn2);
+	SQLFreeHandle(SQL_HANDLE_DBC, conn2);
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,191 @@
+/*
+ * Test fetching rowsets with column-wise binding. The bound columns of
+ * a rowset are converted column by column. The values the column-wise
+ * conversion doesn't handle, like NULLs and non-canonical values, must
+ * come out the same as with the row-wise conversion. When a conversion
+ * fails, the rowset ends at the first failing row.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define ROWSET_SIZE 5
+
+static HSTMT hstmt = SQL_NULL_HSTMT;
+static SQLINTEGER ivals[ROWSET_SIZE];
+static SQLDOUBLE dvals[ROWSET_SIZE];
+static SQLDOUBLE nvals[ROWSET_SIZE];
+static TIMESTAMP_STRUCT tsvals[ROWSET_SIZE];
+static char strvals[ROWSET_SIZE][10];
+static SQLLEN ind[5][ROWSET_SIZE];
+static SQLLEN strbuflen;
+static SQLULEN nrows;
+static SQLUSMALLINT rowstatus[ROWSET_SIZE];
+
+static void
+bind_columns(SQLLEN buflen)
+{
+	SQLRETURN	rc;
+
+	strbuflen = buflen;
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, ivals, 0, ind[0]);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 2, SQL_C_DOUBLE, dvals, 0, ind[1]);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 3, SQL_C_DOUBLE, nvals, 0, ind[2]);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 4, SQL_C_TYPE_TIMESTAMP, tsvals, 0, ind[3]);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 5, SQL_C_CHAR, strvals, buflen, ind[4]);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+}
+
+/* fetch all the rowsets and print them */
+static void
+fetch_all(void)
+{
+	SQLRETURN	rc;
+	SQLULEN		i;
+
+	while (SQL_SUCCEEDED(rc = SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0)))
+	{
+		if (rc == SQL_SUCCESS_WITH_INFO)
+			printf("SQLFetchScroll returned SQL_SUCCESS_WITH_INFO\n");
+		printf("%d rows\n", (int) nrows);
+		for (i = 0; i < nrows; i++)
+		{
+			if (ind[0][i] == SQL_NULL_DATA)
+				printf("NULL");
+			else
+				printf("%d", (int) ivals[i]);
+			if (ind[1][i] == SQL_NULL_DATA)
+				printf(" NULL");
+			else
+				printf(" %g", dvals[i]);
+			if (ind[2][i] == SQL_NULL_DATA)
+				printf(" NULL");
+			else
+				printf(" %g", nvals[i]);
+			if (ind[3][i] == SQL_NULL_DATA)
+				printf(" NULL");
+			else
+				printf(" %04d-%02d-%02d %02d:%02d:%02d.%09u",
+					   tsvals[i].year, tsvals[i].month, tsvals[i].day,
+					   tsvals[i].hour, tsvals[i].minute, tsvals[i].second,
+					   (unsigned int) tsvals[i].fraction);
+			if (ind[4][i] == SQL_NULL_DATA)
+				printf(" NULL\n");
+			else
+				printf(" %s\n", (char *) strvals + i * strbuflen);
+		}
+	}
+	if (rc != SQL_NO_DATA)
+		CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+/* fetch a rowset whose conversion fails and print the row statuses */
+static void
+fetch_failing_rowset(void)
+{
+	SQLRETURN	rc;
+	SQLGUID		guids[2][ROWSET_SIZE];
+	SQLLEN		rownumber;
+	SQLULEN		i;
+
+	rc = SQLFreeStmt(hstmt, SQL_UNBIND);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_STATUS_PTR, (SQLPOINTER) rowstatus, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, ivals, 0, ind[0]);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 2, SQL_C_GUID, guids[0], 0, ind[1]);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 3, SQL_C_GUID, guids[1], 0, ind[2]);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+
+	/* The second column fails at the 4th row, the third one at the 2nd */
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g, CASE WHEN g = 4 THEN 'bad' ELSE '12345678-1234-1234-1234-12345678901' || g END, CASE WHEN g = 2 THEN 'bad' ELSE '12345678-1234-1234-1234-12345678902' || g END FROM generate_series(1, 5) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0);
+	if (rc != SQL_ERROR)
+	{
+		printf("SQLFetchScroll returned %d\n", (int) rc);
+		exit(1);
+	}
+	print_diag("SQLFetchScroll failed as expected", SQL_HANDLE_STMT, hstmt);
+	rc = SQLGetDiagField(SQL_HANDLE_STMT, hstmt, 1, SQL_DIAG_ROW_NUMBER, &rownumber, 0, NULL);
+	CHECK_STMT_RESULT(rc, "SQLGetDiagField failed", hstmt);
+	printf("diagnostic row number: %d\n", (int) rownumber);
+	printf("%d rows\n", (int) nrows);
+	for (i = 0; i < ROWSET_SIZE; i++)
+	{
+		switch (rowstatus[i])
+		{
+			case SQL_ROW_SUCCESS:
+				printf("row %d: %d %08X\n", (int) i + 1, (int) ivals[i], (unsigned int) guids[0][i].Data1);
+				break;
+			case SQL_ROW_ERROR:
+				printf("row %d: error\n", (int) i + 1);
+				break;
+			case SQL_ROW_NOROW:
+				printf("row %d: no row\n", (int) i + 1);
+				break;
+			default:
+				printf("row %d: status %d\n", (int) i + 1, (int) rowstatus[i]);
+				break;
+		}
+	}
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+
+	test_connect();
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) ROWSET_SIZE, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, (SQLPOINTER) &nrows, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	bind_columns(sizeof(strvals[0]));
+
+	/* Rowsets of canonical values, and NULLs */
+	printf("fetching rowsets\n");
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g, g * 1.5::float8, (g * 0.25)::numeric, CASE WHEN g % 4 = 0 THEN NULL ELSE '2016-02-29 12:34:56.789'::timestamp + g * interval '1 day' END, 'text' || g FROM generate_series(1, 12) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	fetch_all();
+
+	/* Values left to the row-wise conversion */
+	printf("fetching special values\n");
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT * FROM (VALUES (2147483647, 1e300::float8, -0.5::numeric, '-infinity'::timestamp, 'x'), (-7, NULL, 12345678901234.5, '0099-01-01 01:02:03 BC', 'y'), (NULL, -2.5, NULL, '2001-02-03 04:05:06.1234567', 'z')) v", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	fetch_all();
+
+	/* Truncation of a column */
+	printf("fetching truncated values\n");
+	bind_columns(4);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g, g * 2.0::float8, g::numeric, '2000-01-01'::timestamp + g * interval '1 hour', 'text' || g FROM generate_series(1, 3) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	fetch_all();
+
+	/* Failing conversion */
+	printf("fetching a rowset with failing values\n");
+	fetch_failing_rowset();
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ * Test the connection settings (ConnSettings). They are sent in one query
+ * with the settings of the driver and the probes of the session. If one
+ * of them fails, the others are sent one by one and take effect anyway.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+static HDBC conn2 = SQL_NULL_HDBC;
+
+/* execute 'sql' on conn2 and print the first column of the first row */
+static void
+print_value(const char *sql)
+{
+	SQLRETURN	rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	char		buf[100];
+	SQLLEN		ind;
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn2, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn2);
+		exit(1);
+	}
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	rc = SQLGetData(hstmt, 1, SQL_C_CHAR, buf, sizeof(buf), &ind);
+	CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+	printf("%s: %s\n", sql, buf);
+	rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmt);
+}
+
+/* print the SQL type of a column of the type lo */
+static void
+print_lo_type(void)
+{
+	SQLRETURN	rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	SQLSMALLINT	sqltype;
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn2, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn2);
+		exit(1);
+	}
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT 0::lo", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLDescribeCol(hstmt, 1, NULL, 0, NULL, &sqltype, NULL, NULL, NULL);
+	CHECK_STMT_RESULT(rc, "SQLDescribeCol failed", hstmt);
+	printf("lo column is %s\n", sqltype == SQL_LONGVARBINARY ? "SQL_LONGVARBINARY" : "not SQL_LONGVARBINARY");
+	rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmt);
+}
+
+static void
+test_settings(const char *settings)
+{
+	SQLRETURN	rc;
+	char		connstr[512];
+
+	printf("\nConnSettings: %s\n", settings);
+	snprintf(connstr, sizeof(connstr), "DSN=psqlodbc_test_dsn;ConnSettings={%s}", settings);
+	rc = SQLDriverConnect(conn2, NULL, (SQLCHAR *) connstr, SQL_NTS,
+						  NULL, 0, NULL, SQL_DRIVER_NOPROMPT);
+	CHECK_CONN_RESULT(rc, "SQLDriverConnect failed", conn2);
+	printf("connected%s\n", rc == SQL_SUCCESS_WITH_INFO ? " with info" : "");
+
+	print_value("SELECT current_setting('work_mem')");
+	print_value("SELECT current_setting('application_name')");
+	print_value("SELECT (current_setting('DateStyle') LIKE 'ISO%')::text");
+	print_value("SELECT current_setting('extra_float_digits')");
+	print_lo_type();
+
+	rc = SQLDisconnect(conn2);
+	CHECK_CONN_RESULT(rc, "SQLDisconnect failed", conn2);
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+
+	test_connect();
+
+	rc = SQLAllocHandle(SQL_HANDLE_DBC, env, &conn2);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate connection handle", SQL_HANDLE_ENV, env);
+		exit(1);
+	}
+
+	test_settings("set work_mem to '2345kB';set application_name to 'conn_settings_test'");
+	/* a failing setting doesn't prevent the others */
+	test_settings("set work_mem to '3456kB';set no_such_setting to 1;set application_name to 'conn_settings_test2'");
+
+	rc = SQLFreeHandle(SQL_HANDLE_DBC, conn2);
+	CHECK_CONN_RESULT(rc, "SQLFreeHandle failed", conn2);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
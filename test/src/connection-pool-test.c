@@ -0,0 +1,150 @@
+/*
+ * Test the connection pool of the driver (AB=0x4000). A connection
+ * reuses the session of the previous connection with the same options,
+ * after its transaction has been rolled back and its state has been
+ * reset, and the settings of the driver are sent again.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+#define POOL_DSN "DSN=psqlodbc_test_dsn;AB=0x4000"
+
+static HDBC conn2 = SQL_NULL_HDBC;
+
+static void
+connect_pooled(const char *dsn)
+{
+	SQLRETURN	rc;
+	SQLCHAR		str[1024];
+	SQLSMALLINT	strl;
+
+	rc = SQLDriverConnect(conn2, NULL, (SQLCHAR *) dsn, SQL_NTS,
+						  str, sizeof(str), &strl,
+						  SQL_DRIVER_COMPLETE);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("SQLDriverConnect failed", SQL_HANDLE_DBC, conn2);
+		exit(1);
+	}
+}
+
+static void
+disconnect_pooled(void)
+{
+	SQLRETURN	rc;
+
+	rc = SQLDisconnect(conn2);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("SQLDisconnect failed", SQL_HANDLE_DBC, conn2);
+		exit(1);
+	}
+}
+
+/* execute 'sql' on 'hdbc' and return the first column of the first row */
+static char *
+exec_value(HDBC hdbc, const char *sql)
+{
+	SQLRETURN	rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	static char	buf[100];
+	SQLLEN		ind;
+	SQLSMALLINT	ncols;
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, hdbc, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, hdbc);
+		exit(1);
+	}
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	buf[0] = '\0';
+	rc = SQLNumResultCols(hstmt, &ncols);
+	CHECK_STMT_RESULT(rc, "SQLNumResultCols failed", hstmt);
+	if (ncols > 0)
+	{
+		rc = SQLFetch(hstmt);
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+		rc = SQLGetData(hstmt, 1, SQL_C_CHAR, buf, sizeof(buf), &ind);
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+	}
+	rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmt);
+
+	return buf;
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+	char		pid[100];
+
+	/* this connection keeps the driver loaded */
+	test_connect_ext("AB=0x4000");
+
+	rc = SQLAllocHandle(SQL_HANDLE_DBC, env, &conn2);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate connection handle", SQL_HANDLE_ENV, env);
+		exit(1);
+	}
+
+	/* Change the state of a session, and leave a transaction open */
+	printf("first connection\n");
+	connect_pooled(POOL_DSN);
+	strcpy(pid, exec_value(conn2, "SELECT pg_backend_pid()"));
+	exec_value(conn2, "SET work_mem = '1234kB'");
+	exec_value(conn2, "CREATE TEMPORARY TABLE pool_tmp (id int4)");
+	rc = SQLSetConnectAttr(conn2, SQL_ATTR_AUTOCOMMIT, (SQLPOINTER) SQL_AUTOCOMMIT_OFF, 0);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("SQLSetConnectAttr failed", SQL_HANDLE_DBC, conn2);
+		exit(1);
+	}
+	exec_value(conn2, "SELECT pg_advisory_xact_lock(4242)");
+	printf("lock available from another session: %s\n",
+		   exec_value(conn, "SELECT pg_try_advisory_lock(4242)::text"));
+	disconnect_pooled();
+
+	/* The next connection reuses the session, reset */
+	printf("second connection\n");
+	connect_pooled(POOL_DSN);
+	printf("same session: %s\n",
+		   strcmp(pid, exec_value(conn2, "SELECT pg_backend_pid()")) == 0 ? "yes" : "no");
+	printf("work_mem kept: %s\n",
+		   exec_value(conn2, "SELECT (current_setting('work_mem') = '1234kB')::text"));
+	printf("temporary table kept: %s\n",
+		   exec_value(conn2, "SELECT count(*) FROM pg_class WHERE relname = 'pool_tmp' AND relnamespace = pg_my_temp_schema()"));
+	printf("lock available from another session: %s\n",
+		   exec_value(conn, "SELECT pg_try_advisory_lock(4242)::text"));
+	exec_value(conn, "SELECT pg_advisory_unlock(4242)");
+	printf("DateStyle: %s\n",
+		   exec_value(conn2, "SELECT (current_setting('DateStyle') LIKE 'ISO%')::text"));
+	printf("extra_float_digits: %s\n",
+		   exec_value(conn2, "SELECT current_setting('extra_float_digits')"));
+	strcpy(pid, exec_value(conn2, "SELECT pg_backend_pid()"));
+	disconnect_pooled();
+
+	/* A session is reused only with exactly the same password */
+	printf("connection with another password\n");
+	connect_pooled(POOL_DSN ";Password=another");
+	printf("same session: %s\n",
+		   strcmp(pid, exec_value(conn2, "SELECT pg_backend_pid()")) == 0 ? "yes" : "no");
+	disconnect_pooled();
+
+	rc = SQLFreeHandle(SQL_HANDLE_DBC, conn2);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("SQLFreeHandle failed", SQL_HANDLE_DBC, conn2);
+		exit(1);
+	}
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
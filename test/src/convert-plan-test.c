@@ -0,0 +1,144 @@
+/*
+ * Test the conversion plans of the bound columns. The conversion of a
+ * bound column is compiled for the type of the result column, and must
+ * follow the binding and the result when they change.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define ROWSET_SIZE 3
+
+/* a row for row-wise binding */
+typedef struct
+{
+	SQLINTEGER	ival;
+	SQLLEN		iind;
+	SQLDOUBLE	dval;
+	SQLLEN		dind;
+	DATE_STRUCT	dtval;
+	SQLLEN		dtind;
+	TIMESTAMP_STRUCT tsval;
+	SQLLEN		tsind;
+} Row;
+
+static HSTMT hstmt = SQL_NULL_HSTMT;
+static Row rows[ROWSET_SIZE];
+static SQLULEN nrows;
+
+static void
+print_row(const Row *row)
+{
+	if (row->iind == SQL_NULL_DATA)
+		printf("NULL");
+	else
+		printf("%d", (int) row->ival);
+	if (row->dind == SQL_NULL_DATA)
+		printf(" NULL");
+	else
+		printf(" %g", row->dval);
+	if (row->dtind == SQL_NULL_DATA)
+		printf(" NULL");
+	else
+		printf(" %04d-%02d-%02d", row->dtval.year, row->dtval.month, row->dtval.day);
+	if (row->tsind == SQL_NULL_DATA)
+		printf(" NULL\n");
+	else
+		printf(" %04d-%02d-%02d %02d:%02d:%02d.%09u\n",
+			   row->tsval.year, row->tsval.month, row->tsval.day,
+			   row->tsval.hour, row->tsval.minute, row->tsval.second,
+			   (unsigned int) row->tsval.fraction);
+}
+
+/* fetch all the rowsets and print them */
+static void
+fetch_all(void)
+{
+	SQLRETURN	rc;
+	SQLULEN		i;
+
+	while (SQL_SUCCEEDED(rc = SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0)))
+	{
+		printf("%d rows\n", (int) nrows);
+		for (i = 0; i < nrows; i++)
+			print_row(&rows[i]);
+	}
+	if (rc != SQL_NO_DATA)
+		CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+	SQLINTEGER	ival;
+	SQLLEN		iind;
+	DATE_STRUCT	dtval;
+	SQLLEN		dtind;
+
+	test_connect();
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	/* Row-wise binding */
+	printf("row-wise binding\n");
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_BIND_TYPE, (SQLPOINTER) sizeof(Row), 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) ROWSET_SIZE, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, (SQLPOINTER) &nrows, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, &rows[0].ival, 0, &rows[0].iind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 2, SQL_C_DOUBLE, &rows[0].dval, 0, &rows[0].dind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 3, SQL_C_TYPE_DATE, &rows[0].dtval, 0, &rows[0].dtind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 4, SQL_C_TYPE_TIMESTAMP, &rows[0].tsval, 0, &rows[0].tsind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g, g / 4.0, '2020-02-27'::date + g, '2020-02-27 23:59:59.5'::timestamp + g * interval '1 hour' FROM generate_series(1, 4) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	fetch_all();
+
+	/* The same bindings for other types */
+	printf("other result types\n");
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g::int8, g::float4, NULL::date, '-infinity'::timestamp FROM generate_series(5, 6) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	fetch_all();
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT '7'::text, 7, '0099-01-01 BC'::date, '2000-01-01 00:00:00'::timestamp", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	fetch_all();
+	rc = SQLFreeStmt(hstmt, SQL_UNBIND);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Rebinding with SQL_C_DEFAULT, and fetching row by row */
+	printf("SQL_C_DEFAULT\n");
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_BIND_TYPE, (SQLPOINTER) SQL_BIND_BY_COLUMN, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 1, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_DEFAULT, &ival, sizeof(ival), &iind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 2, SQL_C_DEFAULT, &dtval, sizeof(dtval), &dtind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g, '1999-12-30'::date + g FROM generate_series(1, 3) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	while (SQL_SUCCEEDED(rc = SQLFetch(hstmt)))
+		printf("%d %04d-%02d-%02d\n", (int) ival, dtval.year, dtval.month, dtval.day);
+	if (rc != SQL_NO_DATA)
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * Test adapting the FETCH count of UseDeclareFetch cursors to the size
+ * of the rows (FetchCacheBytes, D7). The number of rows of each FETCH
+ * varies, but no row may be lost or fetched twice.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+static HSTMT hstmt = SQL_NULL_HSTMT;
+
+/* fetch all the rows, and print every 100th row */
+static void
+fetch_all(const char *sql)
+{
+	SQLRETURN	rc;
+	SQLINTEGER	ival;
+	char		buf[2000];
+	SQLLEN		ind;
+	int			count = 0;
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	while (SQL_SUCCEEDED(rc = SQLFetch(hstmt)))
+	{
+		count++;
+		rc = SQLGetData(hstmt, 1, SQL_C_SLONG, &ival, 0, &ind);
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+		rc = SQLGetData(hstmt, 2, SQL_C_CHAR, buf, sizeof(buf), &ind);
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+		if (ival != count)
+			printf("row %d has value %d\n", count, (int) ival);
+		if (ival % 100 == 0)
+			printf("%d %d\n", (int) ival, (int) strlen(buf));
+	}
+	if (rc != SQL_NO_DATA)
+		CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	printf("fetched %d rows\n", count);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+
+	test_connect_ext("UseDeclareFetch=1;Fetch=10;D7=16384");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	/* Narrow rows, the FETCH count may grow */
+	printf("fetching narrow rows\n");
+	fetch_all("SELECT g, 'x' FROM generate_series(1, 1000) g");
+
+	/* Wide rows, the FETCH count must shrink to fit in the budget */
+	printf("fetching wide rows\n");
+	fetch_all("SELECT g, repeat('x', 1000) FROM generate_series(1, 300) g");
+
+	/* Rows getting wider in the middle */
+	printf("fetching rows of changing width\n");
+	fetch_all("SELECT g, repeat('x', CASE WHEN g > 250 THEN 1500 ELSE 5 END) FROM generate_series(1, 500) g");
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
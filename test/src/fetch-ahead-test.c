@@ -0,0 +1,172 @@
+/*
+ * Test reading ahead the next block of rows with UseDeclareFetch (AB=0x800).
+ * The FETCH of the next block of Fetch rows is sent as soon as a block
+ * is received. The rows read ahead must not be lost when the connection
+ * is used for something else, or when the cursor is moved.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static HSTMT hstmt = SQL_NULL_HSTMT;
+static SQLINTEGER ivals[10];
+static SQLLEN inds[10];
+static SQLULEN nrows;
+
+/* fetch up to 'n' rows (all if n < 0), and print every 10th row */
+static int
+fetch_rows(int n)
+{
+	SQLRETURN	rc = SQL_SUCCESS;
+	SQLINTEGER	ival;
+	SQLLEN		ind;
+	int			count = 0;
+
+	while ((n < 0 || count < n) && SQL_SUCCEEDED(rc = SQLFetch(hstmt)))
+	{
+		count++;
+		rc = SQLGetData(hstmt, 1, SQL_C_SLONG, &ival, 0, &ind);
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+		if (ival % 10 == 0)
+			printf("%d\n", (int) ival);
+	}
+	if (count < n || n < 0)
+	{
+		if (rc != SQL_NO_DATA)
+			CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	}
+	return count;
+}
+
+/* fetch a rowset and print it */
+static void
+fetch_scroll(const char *desc, SQLSMALLINT orientation, SQLLEN offset)
+{
+	SQLRETURN	rc;
+	SQLULEN		i;
+
+	printf("%s: ", desc);
+	rc = SQLFetchScroll(hstmt, orientation, offset);
+	if (rc == SQL_NO_DATA)
+	{
+		printf("no data\n");
+		return;
+	}
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	for (i = 0; i < nrows; i++)
+		printf("%s%d", i == 0 ? "" : " ", (int) ivals[i]);
+	printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+	HSTMT		hstmt2 = SQL_NULL_HSTMT;
+	int			count;
+
+	test_connect_ext("UseDeclareFetch=1;Fetch=10;AB=0x800");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt2);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	/* Fetch all the rows block by block */
+	printf("fetching all the rows\n");
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, 35) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	count = fetch_rows(-1);
+	printf("fetched %d rows\n", count);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Execute another statement while the next block is being fetched */
+	printf("executing another statement in the middle\n");
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, 25) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	count = fetch_rows(12);
+	rc = SQLExecDirect(hstmt2, (SQLCHAR *) "SELECT 'other statement'", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt2);
+	print_result(hstmt2);
+	rc = SQLFreeStmt(hstmt2, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt2);
+	count += fetch_rows(-1);
+	printf("fetched %d rows\n", count);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Close the statement while the next block is being fetched */
+	printf("closing in the middle\n");
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, 1000) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	count = fetch_rows(15);
+	printf("fetched %d rows\n", count);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT 'after close'", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Change the rowset size across the blocks */
+	printf("changing the rowset size\n");
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 3, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, (SQLPOINTER) &nrows, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, ivals, 0, inds);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, 30) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	fetch_scroll("next", SQL_FETCH_NEXT, 0);
+	fetch_scroll("next", SQL_FETCH_NEXT, 0);
+	fetch_scroll("next", SQL_FETCH_NEXT, 0);
+	fetch_scroll("next", SQL_FETCH_NEXT, 0);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 7, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	fetch_scroll("next", SQL_FETCH_NEXT, 0);
+	fetch_scroll("next", SQL_FETCH_NEXT, 0);
+	fetch_scroll("next", SQL_FETCH_NEXT, 0);
+	fetch_scroll("next", SQL_FETCH_NEXT, 0);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Scroll backward and forward with a static cursor */
+	printf("scrolling\n");
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE, (SQLPOINTER) SQL_CURSOR_STATIC, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 4, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, 45) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	fetch_scroll("next", SQL_FETCH_NEXT, 0);
+	fetch_scroll("next", SQL_FETCH_NEXT, 0);
+	fetch_scroll("next", SQL_FETCH_NEXT, 0);
+	fetch_scroll("prior", SQL_FETCH_PRIOR, 0);
+	fetch_scroll("absolute 30", SQL_FETCH_ABSOLUTE, 30);
+	fetch_scroll("relative -20", SQL_FETCH_RELATIVE, -20);
+	fetch_scroll("next", SQL_FETCH_NEXT, 0);
+	fetch_scroll("last", SQL_FETCH_LAST, 0);
+	fetch_scroll("first", SQL_FETCH_FIRST, 0);
+	fetch_scroll("absolute 40", SQL_FETCH_ABSOLUTE, 40);
+	fetch_scroll("next", SQL_FETCH_NEXT, 0);
+	fetch_scroll("next", SQL_FETCH_NEXT, 0);
+	fetch_scroll("prior", SQL_FETCH_PRIOR, 0);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * Test reading long text and bytea values in pieces with SQLGetData. Each
+ * call converts only the piece it returns, so the pieces split CR+LF
+ * (CX=1) and surrogate pairs, and the hex format of bytea, at any point.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+static HSTMT hstmt = SQL_NULL_HSTMT;
+
+static void
+print_piece(SQLSMALLINT ctype, const void *buf, SQLLEN buflen, SQLLEN ind)
+{
+	SQLLEN		i, len;
+
+	len = ind < buflen ? ind : buflen;
+	if (ctype == SQL_C_BINARY)
+	{
+		printf("hex: ");
+		for (i = 0; i < len; i++)
+			printf("%02X", ((const unsigned char *) buf)[i]);
+	}
+	else if (ctype == SQL_C_WCHAR)
+	{
+		const SQLWCHAR *wbuf = (const SQLWCHAR *) buf;
+
+		for (i = 0; wbuf[i] != 0; i++)
+		{
+			if (wbuf[i] > 0x20 && wbuf[i] < 0x7f)
+				printf("%c", (char) wbuf[i]);
+			else
+				printf("<%04X>", (unsigned int) wbuf[i]);
+		}
+	}
+	else
+		printf("%s", (const char *) buf);
+	printf("\n");
+}
+
+/* read the first column of 'sql' in pieces of 'buflen' bytes */
+static void
+get_data_in_pieces(const char *sql, SQLSMALLINT ctype, SQLLEN buflen)
+{
+	SQLRETURN	rc;
+	char		buf[20];
+	SQLLEN		ind;
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	while (SQL_SUCCEEDED(rc = SQLGetData(hstmt, 1, ctype, buf, buflen, &ind)))
+	{
+		printf("len %d, ", (int) ind);
+		print_piece(ctype, buf, buflen, ind);
+	}
+	if (rc != SQL_NO_DATA)
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+/* read a long value in pieces and check it against 'pattern' repeated */
+static void
+check_long_value(const char *sql, SQLSMALLINT ctype, SQLLEN buflen,
+				 const void *pattern, int patlen)
+{
+	SQLRETURN	rc;
+	char	   *buf;
+	SQLLEN		ind, len, total = 0;
+	int			pieces = 0, mismatch = 0, i, tlen;
+
+	tlen = ctype == SQL_C_BINARY ? 0 : (ctype == SQL_C_WCHAR ? sizeof(SQLWCHAR) : 1);
+	buf = malloc(buflen);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	while (SQL_SUCCEEDED(rc = SQLGetData(hstmt, 1, ctype, buf, buflen, &ind)))
+	{
+		len = ind + tlen <= buflen ? ind : buflen - tlen;
+		for (i = 0; i < len; i++)
+		{
+			if (buf[i] != ((const char *) pattern)[(total + i) % patlen])
+				mismatch++;
+		}
+		total += len;
+		pieces++;
+	}
+	if (rc != SQL_NO_DATA)
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+	printf("%d bytes in %d pieces, %d mismatches\n", (int) total, pieces, mismatch);
+	free(buf);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+	SQLWCHAR	wbuf[4];
+	SQLLEN		ind;
+	SQLWCHAR	wpattern[3] = {'\r', '\n', 'x'};
+	const unsigned char bpattern[8] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef};
+
+	/* Enable LF -> CR+LF conversion */
+	test_connect_ext("CX=1");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	printf("reading text in pieces as SQLWCHARs\n");
+	get_data_in_pieces("SELECT E'ab\\ncd' || chr(233) || chr(8364) || chr(128512) || 'x'", SQL_C_WCHAR, 8);
+	printf("reading text in pieces as chars\n");
+	get_data_in_pieces("SELECT 'abcdefghijklmnopqrstuvwxyz'::text", SQL_C_CHAR, 10);
+	printf("reading bytea in pieces as binary\n");
+	get_data_in_pieces("SELECT '\\x0102030405060708090a0b'::bytea", SQL_C_BINARY, 4);
+	printf("reading bytea in pieces as chars\n");
+	get_data_in_pieces("SELECT '\\x0102030405060708090a0b'::bytea", SQL_C_CHAR, 9);
+	printf("reading bytea in pieces as SQLWCHARs\n");
+	get_data_in_pieces("SELECT '\\x0102030405060708090a0b'::bytea", SQL_C_WCHAR, 10);
+
+	/* a bound column is converted as far as it fits */
+	printf("fetching text into a bound SQLWCHAR column\n");
+	rc = SQLBindCol(hstmt, 1, SQL_C_WCHAR, wbuf, sizeof(wbuf), &ind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT E'ab\\ncd'", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	printf("len %d, ", (int) ind);
+	print_piece(SQL_C_WCHAR, wbuf, sizeof(wbuf), ind);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_UNBIND);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	printf("reading long values in pieces\n");
+	check_long_value("SELECT repeat(E'\\nx', 100000)", SQL_C_WCHAR, 1000,
+					 wpattern, sizeof(wpattern));
+	check_long_value("SELECT decode(repeat('0123456789abcdef', 20000), 'hex')", SQL_C_BINARY, 4096,
+					 bpattern, sizeof(bpattern));
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
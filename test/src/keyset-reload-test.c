@@ -0,0 +1,107 @@
+/*
+ * Test reloading the rowsets of a keyset-driven cursor. The rows of a
+ * rowset are reloaded by their ctids in one query, and mapped back to
+ * their positions in the rowset.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define ROWSET_SIZE	100
+
+static HSTMT hstmt = SQL_NULL_HSTMT;
+static SQLINTEGER ids[ROWSET_SIZE];
+static SQLLEN id_inds[ROWSET_SIZE];
+static char texts[ROWSET_SIZE][20];
+static SQLLEN text_inds[ROWSET_SIZE];
+static SQLUSMALLINT statuses[ROWSET_SIZE];
+static SQLULEN nrows;
+
+/* fetch a rowset, and print every 50th row and the deleted rows */
+static void
+fetch_scroll(const char *desc, SQLSMALLINT orientation, SQLLEN offset)
+{
+	SQLRETURN	rc;
+	SQLULEN		i;
+
+	printf("%s\n", desc);
+	rc = SQLFetchScroll(hstmt, orientation, offset);
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	for (i = 0; i < nrows; i++)
+	{
+		if (statuses[i] == SQL_ROW_DELETED)
+			printf("row %d deleted\n", (int) i + 1);
+		else if (ids[i] % 50 == 0)
+			printf("%d %s\n", (int) ids[i], texts[i]);
+	}
+	printf("fetched %d rows\n", (int) nrows);
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+	HSTMT		hstmt2 = SQL_NULL_HSTMT;
+
+	test_connect();
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt2);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	rc = SQLExecDirect(hstmt2, (SQLCHAR *) "CREATE TEMPORARY TABLE keyset_test(id int4 primary key, t text)", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt2);
+	rc = SQLExecDirect(hstmt2, (SQLCHAR *) "INSERT INTO keyset_test SELECT g, 'foo' || g FROM generate_series(1, 1000) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt2);
+	rc = SQLFreeStmt(hstmt2, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt2);
+
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_CONCURRENCY, (SQLPOINTER) SQL_CONCUR_ROWVER, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_CURSOR_TYPE, (SQLPOINTER) SQL_CURSOR_KEYSET_DRIVEN, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) ROWSET_SIZE, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_STATUS_PTR, (SQLPOINTER) statuses, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, (SQLPOINTER) &nrows, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, ids, 0, id_inds);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 2, SQL_C_CHAR, texts, sizeof(texts[0]), text_inds);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT id, t FROM keyset_test ORDER BY id", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	fetch_scroll("next", SQL_FETCH_NEXT, 0);
+	fetch_scroll("absolute 501", SQL_FETCH_ABSOLUTE, 501);
+
+	/* Modify some rows behind the cursor */
+	rc = SQLExecDirect(hstmt2, (SQLCHAR *) "UPDATE keyset_test SET t = 'bar' || id WHERE id % 50 = 0", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt2);
+	rc = SQLExecDirect(hstmt2, (SQLCHAR *) "DELETE FROM keyset_test WHERE id = 555", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt2);
+	rc = SQLFreeStmt(hstmt2, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt2);
+
+	fetch_scroll("prior", SQL_FETCH_PRIOR, 0);
+	fetch_scroll("absolute 501", SQL_FETCH_ABSOLUTE, 501);
+	fetch_scroll("last", SQL_FETCH_LAST, 0);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
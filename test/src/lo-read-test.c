@@ -0,0 +1,165 @@
+/*
+ * Test reading large objects. With 9.4 or later servers, the size and the
+ * first bytes of a large object are read in one query, for all the large
+ * objects of a rowset at once with column-wise binding, and the following
+ * SQLGetData calls read the next bytes with lo_get(). The rowset of a
+ * streamed result (AB=0x400) is converted row by row, and the query
+ * reading the first large object reads the rest of the result.
+ */
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define ROWSET_SIZE 4
+
+static HSTMT hstmt = SQL_NULL_HSTMT;
+
+static void
+printhex(unsigned char *b, int len)
+{
+	int i;
+
+	printf("hex: ");
+	for (i = 0; i < len; i++)
+		printf("%02X", b[i]);
+}
+
+/* fetch the rowset of all the rows of lo_read_tab with column-wise binding */
+static void
+fetch_rowset(SQLSMALLINT ctype, SQLLEN buflen)
+{
+	SQLRETURN	rc;
+	SQLINTEGER	ids[ROWSET_SIZE];
+	char		bufs[ROWSET_SIZE][20];
+	SQLLEN		id_ind[ROWSET_SIZE];
+	SQLLEN		ind[ROWSET_SIZE];
+	SQLULEN		nrows;
+	SQLULEN		i;
+
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) ROWSET_SIZE, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, (SQLPOINTER) &nrows, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, ids, 0, id_ind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLBindCol(hstmt, 2, ctype, bufs, buflen, ind);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT id, data FROM lo_read_tab ORDER BY id", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0);
+	CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	if (rc == SQL_SUCCESS_WITH_INFO)
+		printf("SQLFetchScroll returned SQL_SUCCESS_WITH_INFO\n");
+	for (i = 0; i < nrows; i++)
+	{
+		printf("%d: ", (int) ids[i]);
+		if (ind[i] == SQL_NULL_DATA)
+			printf("NULL");
+		else if (ctype == SQL_C_BINARY)
+		{
+			printf("len %d, ", (int) ind[i]);
+			printhex((unsigned char *) bufs[i], ind[i] < buflen ? (int) ind[i] : (int) buflen);
+		}
+		else
+			printf("len %d, %s", (int) ind[i], bufs[i]);
+		printf("\n");
+	}
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_UNBIND);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 1, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+}
+
+/* read the large object of row 'id' in pieces of 'buflen' bytes */
+static void
+get_data_in_pieces(int id, SQLSMALLINT ctype, SQLLEN buflen)
+{
+	SQLRETURN	rc;
+	char		sql[100];
+	char		buf[20];
+	SQLLEN		ind;
+
+	snprintf(sql, sizeof(sql), "SELECT data FROM lo_read_tab WHERE id = %d", id);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	while (SQL_SUCCEEDED(rc = SQLGetData(hstmt, 1, ctype, buf, buflen, &ind)))
+	{
+		printf("len %d, ", (int) ind);
+		if (ctype == SQL_C_BINARY)
+			printhex((unsigned char *) buf, ind < buflen ? (int) ind : (int) buflen);
+		else
+			printf("%s", buf);
+		printf("\n");
+	}
+	if (rc != SQL_NO_DATA)
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+/* connect with 'extra' and create lo_read_tab */
+static void
+setup(char *extra)
+{
+	SQLRETURN	rc;
+
+	test_connect_ext(extra);
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "CREATE TEMPORARY TABLE lo_read_tab (id int4, data lo)", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *)
+		"INSERT INTO lo_read_tab VALUES "
+		"(1, lo_from_bytea(0, '\\x0102030405060708')), "
+		"(2, lo_from_bytea(0, 'abcdefghijklmnop')), "
+		"(3, NULL), "
+		"(4, lo_from_bytea(0, '')), "
+		"(5, lo_from_bytea(0, 'qrstuvwx')), "
+		"(6, lo_from_bytea(0, 'yz'))", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+}
+
+int main(int argc, char **argv)
+{
+	setup(NULL);
+
+	printf("fetching a rowset as binary\n");
+	fetch_rowset(SQL_C_BINARY, 10);
+	printf("fetching a rowset as char\n");
+	fetch_rowset(SQL_C_CHAR, 11);
+
+	printf("reading a large object in pieces as binary\n");
+	get_data_in_pieces(2, SQL_C_BINARY, 5);
+	printf("reading a large object in pieces as char\n");
+	get_data_in_pieces(2, SQL_C_CHAR, 9);
+	printf("reading an empty large object\n");
+	get_data_in_pieces(4, SQL_C_BINARY, 5);
+	test_disconnect();
+
+	/* The rows of the rowset are still being received */
+	setup("AB=0x400;Fetch=2");
+	printf("fetching a rowset of a streamed result as binary\n");
+	fetch_rowset(SQL_C_BINARY, 10);
+	printf("fetching a rowset of a streamed result as char\n");
+	fetch_rowset(SQL_C_CHAR, 11);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
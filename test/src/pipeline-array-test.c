@@ -0,0 +1,215 @@
+/*
+ * Test executing arrays of parameters in pipeline mode (AB=0x80).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define ARRAY_SIZE 1000
+#define ARRAY_SIZE_SMALL 10
+#define ARRAY_SIZE_MEDIUM 300
+
+static void
+print_param_status(SQLUSMALLINT *status_array, SQLULEN nrows)
+{
+	SQLULEN		i;
+
+	printf("Parameter	Status\n");
+	for (i = 0; i < nrows; i++)
+	{
+		switch (status_array[i])
+		{
+			case SQL_PARAM_SUCCESS:
+			case SQL_PARAM_SUCCESS_WITH_INFO:
+				break;
+
+			case SQL_PARAM_ERROR:
+				printf("%d\tError\n", (int) i);
+				break;
+
+			case SQL_PARAM_UNUSED:
+				printf("%d\tUnused\n", (int) i);
+				break;
+
+			case SQL_PARAM_DIAG_UNAVAILABLE:
+				printf("%d\tDiag unavailable\n", (int) i);
+				break;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN rc;
+	HSTMT hstmt = SQL_NULL_HSTMT;
+	char *sql;
+
+	int i;
+
+	SQLUINTEGER int_array[ARRAY_SIZE];
+	SQLCHAR str_array[ARRAY_SIZE][30];
+	SQLLEN int_ind_array[ARRAY_SIZE];
+	SQLLEN str_ind_array[ARRAY_SIZE];
+	SQLUSMALLINT status_array[ARRAY_SIZE];
+	SQLULEN nprocessed;
+	SQLLEN rownumber;
+
+	test_connect_ext("AB=0x80;UseServerSidePrepare=1");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	sql = "CREATE TEMPORARY TABLE tmptable (i int4 PRIMARY KEY, t text)";
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed while creating temp table", hstmt);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/****
+	 * 1. Insert more rows than fit in one pipeline batch, in autocommit mode
+	 */
+	for (i = 0; i < ARRAY_SIZE; i++)
+	{
+		int_array[i] = i;
+		int_ind_array[i] = 0;
+		sprintf(str_array[i], "pipelined %d", i);
+		str_ind_array[i] = SQL_NTS;
+	}
+
+	SQLSetStmtAttr(hstmt, SQL_ATTR_PARAM_BIND_TYPE, SQL_PARAM_BIND_BY_COLUMN, 0);
+	SQLSetStmtAttr(hstmt, SQL_ATTR_PARAM_STATUS_PTR, status_array, 0);
+	SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMS_PROCESSED_PTR, &nprocessed, 0);
+	SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER) ARRAY_SIZE, 0);
+
+	/* Bind the parameter arrays. */
+	SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT, SQL_C_ULONG, SQL_INTEGER, 5, 0,
+					 int_array, 0, int_ind_array);
+	SQLBindParameter(hstmt, 2, SQL_PARAM_INPUT, SQL_C_CHAR, SQL_CHAR, 29, 0,
+					 str_array, 30, str_ind_array);
+
+	/* Execute */
+	sql = "INSERT INTO tmptable VALUES (?, ?)";
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+
+	print_param_status(status_array, nprocessed);
+	printf("Rows processed: %d\n", (int) nprocessed);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/****
+	 * 2. A failing row in a transaction. The rows after it are not
+	 * executed.
+	 */
+	rc = SQLSetConnectAttr(conn, SQL_ATTR_AUTOCOMMIT,
+						   (SQLPOINTER) SQL_AUTOCOMMIT_OFF, SQL_IS_UINTEGER);
+	CHECK_STMT_RESULT(rc, "SQLSetConnectAttr failed", hstmt);
+
+	for (i = 0; i < ARRAY_SIZE_SMALL; i++)
+	{
+		int_array[i] = 2000 + i;
+		sprintf(str_array[i], "transaction %d", i);
+	}
+	/* duplicate key */
+	int_array[5] = 1;
+
+	SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER) ARRAY_SIZE_SMALL, 0);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	if (rc != SQL_ERROR)
+	{
+		printf("SQLExecDirect should have failed\n");
+		exit(1);
+	}
+	printf("SQLExecDirect failed as expected\n");
+
+	print_param_status(status_array, ARRAY_SIZE_SMALL);
+	printf("Rows processed: %d\n", (int) nprocessed);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	rc = SQLEndTran(SQL_HANDLE_DBC, conn, SQL_ROLLBACK);
+	CHECK_STMT_RESULT(rc, "SQLEndTran failed", hstmt);
+
+	rc = SQLSetConnectAttr(conn, SQL_ATTR_AUTOCOMMIT,
+						   (SQLPOINTER) SQL_AUTOCOMMIT_ON, SQL_IS_UINTEGER);
+	CHECK_STMT_RESULT(rc, "SQLSetConnectAttr failed", hstmt);
+
+	/****
+	 * 3. Failing rows in autocommit mode, in two pipeline batches. The
+	 * rows after the first one in its batch, which have been sent already,
+	 * are executed. The next batch is not sent.
+	 */
+	for (i = 0; i < ARRAY_SIZE_MEDIUM; i++)
+	{
+		int_array[i] = 3000 + i;
+		sprintf(str_array[i], "autocommit %d", i);
+	}
+	/* duplicate keys */
+	int_array[5] = 1;
+	int_array[280] = 2;
+
+	SQLSetStmtAttr(hstmt, SQL_ATTR_PARAMSET_SIZE, (SQLPOINTER) ARRAY_SIZE_MEDIUM, 0);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	if (rc != SQL_ERROR)
+	{
+		printf("SQLExecDirect should have failed\n");
+		exit(1);
+	}
+	printf("SQLExecDirect failed as expected\n");
+
+	print_param_status(status_array, ARRAY_SIZE_MEDIUM);
+	printf("Rows processed: %d\n", (int) nprocessed);
+
+	rc = SQLGetDiagField(SQL_HANDLE_STMT, hstmt, 1, SQL_DIAG_ROW_NUMBER,
+						 &rownumber, 0, NULL);
+	CHECK_STMT_RESULT(rc, "SQLGetDiagField failed", hstmt);
+	printf("Diagnostic row number: %d\n", (int) rownumber);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/*
+	 * Free and allocate a new handle for the next SELECT statement, as we don't
+	 * want to array bind that one.
+	 */
+	rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmt);
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	/* Check that only the rows of the first and the third arrays are there */
+	sql = "SELECT COUNT(*), MIN(i), MAX(i) FROM tmptable";
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Check the contents of a few rows */
+	sql = "SELECT * FROM tmptable WHERE i IN (0, 255, 256, 999, 3256, 3257) ORDER BY i";
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
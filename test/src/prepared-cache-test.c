@@ -0,0 +1,99 @@
+/*
+ * Test the cache of the statements prepared at the server (D8, that is
+ * PreparedCacheSize). The plans outlive the statement handles, and are
+ * reused by the statements preparing the same query with the same
+ * parameter types.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static HSTMT hstmt = SQL_NULL_HSTMT;
+
+/* prepare and execute the query in a new statement handle */
+static void
+prepare_and_execute(const char *sql, SQLSMALLINT ctype, SQLSMALLINT sqltype, void *param)
+{
+	SQLRETURN	rc;
+	HSTMT		hstmt2 = SQL_NULL_HSTMT;
+	SQLLEN		cbParam = SQL_NTS;
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt2);
+	CHECK_CONN_RESULT(rc, "failed to allocate stmt handle", conn);
+	rc = SQLPrepare(hstmt2, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrepare failed", hstmt2);
+	rc = SQLBindParameter(hstmt2, 1, SQL_PARAM_INPUT,
+						  ctype,	/* value type */
+						  sqltype,	/* param type */
+						  20,		/* column size */
+						  0,		/* dec digits */
+						  param,	/* param value ptr */
+						  0,		/* buffer len */
+						  ctype == SQL_C_CHAR ? &cbParam : NULL);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt2);
+	rc = SQLExecute(hstmt2);
+	CHECK_STMT_RESULT(rc, "SQLExecute failed", hstmt2);
+	print_result(hstmt2);
+	rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmt2);
+	CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmt2);
+}
+
+static void
+print_plan_count(void)
+{
+	SQLRETURN	rc;
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT count(*) FROM pg_prepared_statements WHERE name ~ '^_PC'", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	printf("cached plans: ");
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+	SQLINTEGER	ival;
+	char		sval[20];
+	int			i;
+
+	test_connect_ext("UseServerSidePrepare=1;D8=2");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	/* The same query prepared by successive handles */
+	printf("preparing the same query\n");
+	for (i = 1; i <= 3; i++)
+	{
+		ival = i;
+		prepare_and_execute("SELECT ?::int4 + 1", SQL_C_SLONG, SQL_INTEGER, &ival);
+	}
+	print_plan_count();
+
+	/* More distinct queries than the cache keeps */
+	printf("preparing distinct queries\n");
+	ival = 5;
+	prepare_and_execute("SELECT ?::int4 + 10", SQL_C_SLONG, SQL_INTEGER, &ival);
+	prepare_and_execute("SELECT ?::int4 + 20", SQL_C_SLONG, SQL_INTEGER, &ival);
+	prepare_and_execute("SELECT ?::int4 + 30", SQL_C_SLONG, SQL_INTEGER, &ival);
+	print_plan_count();
+
+	/* The same query with another parameter type */
+	printf("preparing with another parameter type\n");
+	strcpy(sval, "7");
+	prepare_and_execute("SELECT ?::int4 + 30", SQL_C_CHAR, SQL_VARCHAR, sval);
+	prepare_and_execute("SELECT ?::int4 + 30", SQL_C_SLONG, SQL_INTEGER, &ival);
+	print_plan_count();
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
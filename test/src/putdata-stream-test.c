@@ -0,0 +1,134 @@
+/*
+ * Test sending large data at execution with SQLPutData. The pieces of a
+ * large object parameter are written to the large object as they arrive.
+ * With UseServerSidePrepare=0, a bytea parameter that grows large is moved
+ * to a temporary large object as well, which is removed after the
+ * statement has been executed, or when it fails or is cancelled.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+#define PIECE_SIZE	(64 * 1024)
+
+/* how put_param() ends */
+#define PUT_EXECUTE	0
+#define PUT_FAIL	1
+#define PUT_CANCEL	2
+
+static HSTMT hstmt = SQL_NULL_HSTMT;
+
+/* execute 'sql' with one parameter of 'total' bytes sent in pieces */
+static void
+put_param(const char *sql, SQLSMALLINT sqltype, SQLLEN total, SQLLEN piece, int mode)
+{
+	SQLRETURN	rc;
+	SQLLEN		cbParam = SQL_DATA_AT_EXEC;
+	SQLLEN		offset, len, i;
+	PTR			paramid;
+	static char buf[PIECE_SIZE];
+
+	rc = SQLPrepare(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrepare failed", hstmt);
+	rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT,
+						  SQL_C_BINARY,	/* value type */
+						  sqltype,		/* param type */
+						  total,		/* column size */
+						  0,			/* dec digits */
+						  (void *) 1,	/* param value ptr. For a data-at-exec
+										 * param, this is a "parameter id" */
+						  0,			/* buffer len */
+						  &cbParam		/* StrLen_or_IndPtr */);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+
+	rc = SQLExecute(hstmt);
+	if (rc != SQL_NEED_DATA)
+		CHECK_STMT_RESULT(rc, "SQLExecute failed", hstmt);
+	while ((rc = SQLParamData(hstmt, &paramid)) == SQL_NEED_DATA)
+	{
+		for (offset = 0; offset < total; offset += len)
+		{
+			len = total - offset < piece ? total - offset : piece;
+			for (i = 0; i < len; i++)
+				buf[i] = (char) ((offset + i) % 251);
+			rc = SQLPutData(hstmt, buf, len);
+			CHECK_STMT_RESULT(rc, "SQLPutData failed", hstmt);
+		}
+		if (PUT_CANCEL == mode)
+		{
+			rc = SQLCancel(hstmt);
+			CHECK_STMT_RESULT(rc, "SQLCancel failed", hstmt);
+			printf("cancelled\n");
+			break;
+		}
+	}
+	if (PUT_FAIL == mode)
+	{
+		if (rc != SQL_ERROR)
+		{
+			printf("SQLParamData should have failed\n");
+			exit(1);
+		}
+		printf("SQLParamData failed as expected\n");
+	}
+	else if (PUT_EXECUTE == mode)
+		CHECK_STMT_RESULT(rc, "SQLParamData failed", hstmt);
+
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_RESET_PARAMS);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+static void
+exec_print(const char *sql)
+{
+	SQLRETURN	rc;
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+
+	test_connect_ext("UseServerSidePrepare=0");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "CREATE TEMPORARY TABLE putdata_tab (id int4, b bytea, l lo)", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "CREATE TEMPORARY TABLE putdata_lo_count AS SELECT count(*) AS n FROM pg_largeobject_metadata", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+
+	printf("sending a small bytea value\n");
+	put_param("INSERT INTO putdata_tab (id, b) VALUES (1, ?)", SQL_VARBINARY, 1000, 300, PUT_EXECUTE);
+	printf("sending a large bytea value\n");
+	put_param("INSERT INTO putdata_tab (id, b) VALUES (2, ?)", SQL_VARBINARY, 3 * 1024 * 1024, PIECE_SIZE, PUT_EXECUTE);
+	printf("sending a large object\n");
+	put_param("INSERT INTO putdata_tab (id, l) VALUES (3, ?)", SQL_LONGVARBINARY, 3 * 1024 * 1024, PIECE_SIZE, PUT_EXECUTE);
+	printf("sending a large bytea value to a failing statement\n");
+	put_param("INSERT INTO putdata_tab (id, b) VALUES (1 / 0, ?)", SQL_VARBINARY, 3 * 1024 * 1024, PIECE_SIZE, PUT_FAIL);
+	printf("cancelling a large bytea value\n");
+	put_param("INSERT INTO putdata_tab (id, b) VALUES (4, ?)", SQL_VARBINARY, 3 * 1024 * 1024, PIECE_SIZE, PUT_CANCEL);
+
+	exec_print("SELECT id, length(b), md5(b), length(lo_get(l)), md5(lo_get(l)) FROM putdata_tab ORDER BY id");
+	/* only the large object of the lo column remains */
+	exec_print("SELECT count(*) - (SELECT n FROM putdata_lo_count) FROM pg_largeobject_metadata");
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,82 @@
+/*
+ * Test sharing the column info cache among the connections (AB=0x1000).
+ * The columns described by a connection must be those of the current
+ * table definition, whether they come from the shared cache or not.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static HSTMT hstmt = SQL_NULL_HSTMT;
+
+static void
+connect_and_alloc(void)
+{
+	SQLRETURN	rc;
+
+	test_connect_ext("Parse=1;AB=0x1000");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+}
+
+static void
+exec_direct(const char *sql)
+{
+	SQLRETURN	rc;
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+static void
+describe_columns(void)
+{
+	SQLRETURN	rc;
+
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT id, t FROM colinfo_test", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result_meta(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int main(int argc, char **argv)
+{
+	connect_and_alloc();
+	exec_direct("DROP TABLE IF EXISTS colinfo_test");
+	exec_direct("CREATE TABLE colinfo_test (id integer PRIMARY KEY, t varchar(20))");
+
+	printf("describing in the first connection\n");
+	describe_columns();
+	describe_columns();
+	test_disconnect();
+
+	/* The column info may come from the shared cache */
+	connect_and_alloc();
+	printf("describing in the second connection\n");
+	describe_columns();
+
+	/* ALTER TABLE must clear the shared column info */
+	printf("altering the table\n");
+	exec_direct("ALTER TABLE colinfo_test ALTER COLUMN t TYPE varchar(40)");
+	describe_columns();
+	test_disconnect();
+
+	connect_and_alloc();
+	printf("describing in the third connection\n");
+	describe_columns();
+	exec_direct("DROP TABLE colinfo_test");
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,128 @@
+/*
+ * Test executing the same statements again with UseServerSidePrepare=0.
+ * The statements are converted once, and the next executions reuse the
+ * result of the conversion with the new parameter values.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static HSTMT hstmt = SQL_NULL_HSTMT;
+static SQLINTEGER intparam;
+static char strparam[20];
+static SQLLEN cbInt, cbStr;
+
+/* execute the statement with the given parameter values */
+static void
+execute_with(const char *sql, int ival, const char *sval)
+{
+	SQLRETURN	rc;
+
+	intparam = ival;
+	cbInt = sizeof(intparam);
+	strcpy(strparam, sval);
+	cbStr = SQL_NTS;
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+static void
+run_tests(void)
+{
+	SQLRETURN	rc;
+	int			i;
+	const char *sql;
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+	rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT,
+						  SQL_C_SLONG,	/* value type */
+						  SQL_INTEGER,	/* param type */
+						  0,			/* column size (ignored for SQL_INTEGER) */
+						  0,			/* dec digits */
+						  &intparam,	/* param value ptr */
+						  0,			/* buffer len (ignored for SQL_INTEGER) */
+						  &cbInt		/* StrLen_or_IndPtr */);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	rc = SQLBindParameter(hstmt, 2, SQL_PARAM_INPUT,
+						  SQL_C_CHAR,	/* value type */
+						  SQL_CHAR,		/* param type */
+						  20,			/* column size */
+						  0,			/* dec digits */
+						  strparam,		/* param value ptr */
+						  sizeof(strparam), /* buffer len */
+						  &cbStr		/* StrLen_or_IndPtr */);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+
+	/* Literals, comments and escapes around the parameter markers */
+	sql = "SELECT ? + 1 AS \"a?\", '?' || ? AS b /* ? */, {d '2014-01-02'} AS c -- ?\n";
+	for (i = 0; i < 3; i++)
+		execute_with(sql, i * 10, i == 1 ? "it's" : "foo");
+
+	/* Parameters in the arguments of an escaped function */
+	sql = "SELECT ?, {fn ucase(?)}";
+	for (i = 0; i < 2; i++)
+		execute_with(sql, i, i == 0 ? "bar" : "baz");
+
+	/* NULL values */
+	sql = "SELECT coalesce(?, -1), coalesce(?, 'null')";
+	execute_with(sql, 1, "not null");
+	cbInt = SQL_NULL_DATA;
+	cbStr = SQL_NULL_DATA;
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* SQLPrepare and SQLExecute */
+	rc = SQLPrepare(hstmt, (SQLCHAR *) "SELECT g, ? FROM generate_series(1, ?) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrepare failed", hstmt);
+	rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT,
+						  SQL_C_CHAR, SQL_CHAR, 20, 0,
+						  strparam, sizeof(strparam), &cbStr);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	rc = SQLBindParameter(hstmt, 2, SQL_PARAM_INPUT,
+						  SQL_C_SLONG, SQL_INTEGER, 0, 0,
+						  &intparam, 0, &cbInt);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	for (i = 1; i <= 3; i++)
+	{
+		intparam = i;
+		cbInt = sizeof(intparam);
+		sprintf(strparam, "row %d", i);
+		cbStr = SQL_NTS;
+		rc = SQLExecute(hstmt);
+		CHECK_STMT_RESULT(rc, "SQLExecute failed", hstmt);
+		print_result(hstmt);
+		rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+		CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	}
+
+	rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFreeHandle failed", hstmt);
+}
+
+int main(int argc, char **argv)
+{
+	printf("Testing with UseServerSidePrepare=0\n");
+	test_connect_ext("UseServerSidePrepare=0");
+	run_tests();
+	test_disconnect();
+
+	/* The statements are converted into declare cursor statements */
+	printf("Testing with UseServerSidePrepare=0;UseDeclareFetch=1\n");
+	test_connect_ext("UseServerSidePrepare=0;UseDeclareFetch=1");
+	run_tests();
+	test_disconnect();
+
+	return 0;
+}
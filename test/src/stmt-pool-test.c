@@ -0,0 +1,123 @@
+/*
+ * Test allocating and dropping many statement handles. The dropped
+ * statements are kept by the connection for reuse, so a new handle must
+ * not inherit anything from the statement it was recycled from.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define NUM_HANDLES	40
+
+static HSTMT
+alloc_stmt(void)
+{
+	SQLRETURN	rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+	return hstmt;
+}
+
+static void
+free_stmt(HSTMT hstmt)
+{
+	SQLRETURN	rc;
+
+	rc = SQLFreeHandle(SQL_HANDLE_STMT, hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("SQLFreeHandle failed", SQL_HANDLE_STMT, hstmt);
+		exit(1);
+	}
+}
+
+/* run a query returning the given number, and check the result */
+static void
+check_stmt(HSTMT hstmt, int n)
+{
+	SQLRETURN	rc;
+	char		sql[64];
+	SQLINTEGER	ival;
+	SQLLEN		ind;
+
+	snprintf(sql, sizeof(sql), "SELECT %d", n);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	rc = SQLGetData(hstmt, 1, SQL_C_SLONG, &ival, 0, &ind);
+	CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+	if (ival != n)
+		printf("statement %d returned %d\n", n, (int) ival);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+	HSTMT		hstmts[NUM_HANDLES];
+	HSTMT		hstmt;
+	SQLULEN		maxrows;
+	SQLINTEGER	ivals[3];
+	SQLLEN		inds[3];
+	int			i;
+
+	test_connect();
+
+	/* Allocate more handles than fit in the initial slots */
+	printf("allocating %d handles\n", NUM_HANDLES);
+	for (i = 0; i < NUM_HANDLES; i++)
+		hstmts[i] = alloc_stmt();
+	for (i = 0; i < NUM_HANDLES; i++)
+		check_stmt(hstmts[i], i);
+
+	/* Drop every other handle, and reallocate them */
+	printf("dropping and reallocating every other handle\n");
+	for (i = 0; i < NUM_HANDLES; i += 2)
+		free_stmt(hstmts[i]);
+	for (i = 0; i < NUM_HANDLES; i += 2)
+		hstmts[i] = alloc_stmt();
+	for (i = 0; i < NUM_HANDLES; i++)
+		check_stmt(hstmts[i], i + 100);
+
+	printf("dropping all the handles\n");
+	for (i = 0; i < NUM_HANDLES; i++)
+		free_stmt(hstmts[i]);
+
+	/* Set attributes, bind a column and prepare, then drop the handle */
+	hstmt = alloc_stmt();
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_MAX_ROWS, (SQLPOINTER) 1, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, ivals, 0, inds);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLPrepare(hstmt, (SQLCHAR *) "SELECT 'prepared on the dropped handle'", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLPrepare failed", hstmt);
+	free_stmt(hstmt);
+
+	/* A new handle has none of them */
+	printf("checking a new handle\n");
+	hstmt = alloc_stmt();
+	rc = SQLGetStmtAttr(hstmt, SQL_ATTR_MAX_ROWS, &maxrows, 0, NULL);
+	CHECK_STMT_RESULT(rc, "SQLGetStmtAttr failed", hstmt);
+	printf("SQL_ATTR_MAX_ROWS: %d\n", (int) maxrows);
+	rc = SQLExecute(hstmt);
+	if (!SQL_SUCCEEDED(rc))
+		printf("SQLExecute failed as expected\n");
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, 3) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+	free_stmt(hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
@@ -0,0 +1,143 @@
+/*
+ * Test streaming the rows of forward-only, read-only results (AB=0x400).
+ * The rows are read from the server by the block of Fetch rows as they
+ * are fetched.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+/* fetch up to 'n' rows (all if n < 0), and print every 10th row */
+static int
+fetch_rows(HSTMT hstmt, int n)
+{
+	SQLRETURN	rc = SQL_SUCCESS;
+	SQLINTEGER	ival;
+	char		buf[40];
+	SQLLEN		ind;
+	int			count = 0;
+
+	while ((n < 0 || count < n) && SQL_SUCCEEDED(rc = SQLFetch(hstmt)))
+	{
+		count++;
+		rc = SQLGetData(hstmt, 1, SQL_C_SLONG, &ival, 0, &ind);
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+		rc = SQLGetData(hstmt, 2, SQL_C_CHAR, buf, sizeof(buf), &ind);
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+		if (ival % 10 == 0)
+			printf("%d %s\n", (int) ival, buf);
+	}
+	if (count < n || n < 0)
+	{
+		if (rc != SQL_NO_DATA)
+			CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	}
+	return count;
+}
+
+static void
+print_rowcount(HSTMT hstmt)
+{
+	SQLRETURN	rc;
+	SQLLEN		rowcount;
+
+	rc = SQLRowCount(hstmt, &rowcount);
+	CHECK_STMT_RESULT(rc, "SQLRowCount failed", hstmt);
+	printf("row count: %d\n", (int) rowcount);
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+	HSTMT		hstmt = SQL_NULL_HSTMT;
+	HSTMT		hstmt2 = SQL_NULL_HSTMT;
+	SQLINTEGER	ivals[4];
+	SQLLEN		inds[4];
+	SQLULEN		nrows;
+	int			count;
+
+	test_connect_ext("AB=0x400;Fetch=10");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt2);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	/* Fetch all the rows block by block */
+	printf("fetching all the rows\n");
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g, 'foo' || g FROM generate_series(1, 35) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_rowcount(hstmt);
+	count = fetch_rows(hstmt, -1);
+	printf("fetched %d rows\n", count);
+	print_rowcount(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Execute another statement while rows are pending */
+	printf("executing another statement in the middle\n");
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g, 'bar' || g FROM generate_series(1, 25) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	count = fetch_rows(hstmt, 12);
+	rc = SQLExecDirect(hstmt2, (SQLCHAR *) "SELECT 'other statement'", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt2);
+	print_result(hstmt2);
+	rc = SQLFreeStmt(hstmt2, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt2);
+	count += fetch_rows(hstmt, -1);
+	printf("fetched %d rows\n", count);
+	print_rowcount(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Close the statement while rows are pending */
+	printf("closing in the middle\n");
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g, 'baz' || g FROM generate_series(1, 1000) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	count = fetch_rows(hstmt, 15);
+	printf("fetched %d rows\n", count);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT 'after close'", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	print_result(hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Rowsets crossing the blocks */
+	printf("fetching rowsets of 4 rows\n");
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER) 4, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLSetStmtAttr(hstmt, SQL_ATTR_ROWS_FETCHED_PTR, (SQLPOINTER) &nrows, 0);
+	CHECK_STMT_RESULT(rc, "SQLSetStmtAttr failed", hstmt);
+	rc = SQLBindCol(hstmt, 1, SQL_C_SLONG, ivals, 0, inds);
+	CHECK_STMT_RESULT(rc, "SQLBindCol failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT g FROM generate_series(1, 22) g", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	while (SQL_SUCCEEDED(rc = SQLFetchScroll(hstmt, SQL_FETCH_NEXT, 0)))
+	{
+		SQLULEN		i;
+
+		for (i = 0; i < nrows; i++)
+			printf("%s%d", i == 0 ? "" : " ", (int) ivals[i]);
+		printf("\n");
+	}
+	if (rc != SQL_NO_DATA)
+		CHECK_STMT_RESULT(rc, "SQLFetchScroll failed", hstmt);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
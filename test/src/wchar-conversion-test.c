@@ -0,0 +1,128 @@
+/*
+ * Test the conversions between UTF-8 and SQLWCHARs of long strings.
+ * The runs of ASCII characters are converted in blocks, so the strings
+ * have LFs to convert to CR+LF (CX=1) around the block boundaries.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+#define MAXLEN 200
+
+static HSTMT hstmt = SQL_NULL_HSTMT;
+
+/* fetch a string of 'n' x's, LF, 'n' y's, CR+LF and z as SQLWCHARs */
+static void
+fetch_wchar(int n)
+{
+	SQLRETURN	rc;
+	char		sql[100];
+	SQLWCHAR	wbuf[2 * MAXLEN + 10];
+	SQLWCHAR	expected[2 * MAXLEN + 10];
+	SQLLEN		ind;
+	int			i, len = 0;
+
+	for (i = 0; i < n; i++)
+		expected[len++] = 'x';
+	expected[len++] = '\r';
+	expected[len++] = '\n';
+	for (i = 0; i < n; i++)
+		expected[len++] = 'y';
+	expected[len++] = '\r';
+	expected[len++] = '\n';
+	expected[len++] = 'z';
+	expected[len] = 0;
+
+	snprintf(sql, sizeof(sql), "SELECT repeat('x', %d) || E'\\n' || repeat('y', %d) || E'\\r\\nz'", n, n);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	rc = SQLGetData(hstmt, 1, SQL_C_WCHAR, wbuf, sizeof(wbuf), &ind);
+	CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+	if (ind == len * sizeof(SQLWCHAR) &&
+		memcmp(wbuf, expected, (len + 1) * sizeof(SQLWCHAR)) == 0)
+		printf("%d: %d chars ok\n", n, len);
+	else
+		printf("%d: mismatch, SQLGetData claims %d bytes\n", n, (int) ind);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* the same, truncated after the x's */
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) sql, SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	rc = SQLGetData(hstmt, 1, SQL_C_WCHAR, wbuf, (n + 1) * sizeof(SQLWCHAR), &ind);
+	if (rc != SQL_SUCCESS_WITH_INFO)
+		CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+	if (memcmp(wbuf, expected, n * sizeof(SQLWCHAR)) == 0 && wbuf[n] == 0)
+		printf("%d: truncated ok\n", n);
+	else
+		printf("%d: truncated mismatch\n", n);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+}
+
+int main(int argc, char **argv)
+{
+	SQLRETURN	rc;
+	static const int lengths[] = {1, 7, 8, 9, 15, 16, 17, 31, 32, 33, MAXLEN};
+	SQLWCHAR	wparam[MAXLEN + 1];
+	char		expected[MAXLEN + 1];
+	char		buf[MAXLEN + 10];
+	SQLLEN		ind, cbParam = SQL_NTS;
+	int			i;
+
+	/* Enable LF -> CR+LF conversion */
+	test_connect_ext("CX=1");
+
+	rc = SQLAllocHandle(SQL_HANDLE_STMT, conn, &hstmt);
+	if (!SQL_SUCCEEDED(rc))
+	{
+		print_diag("failed to allocate stmt handle", SQL_HANDLE_DBC, conn);
+		exit(1);
+	}
+
+	printf("fetching as SQLWCHARs\n");
+	for (i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++)
+		fetch_wchar(lengths[i]);
+
+	/* A long SQLWCHAR parameter */
+	printf("SQLWCHAR parameter\n");
+	for (i = 0; i < MAXLEN; i++)
+	{
+		expected[i] = 'a' + i % 26;
+		wparam[i] = expected[i];
+	}
+	expected[MAXLEN] = '\0';
+	wparam[MAXLEN] = 0;
+	rc = SQLBindParameter(hstmt, 1, SQL_PARAM_INPUT,
+						  SQL_C_WCHAR,	/* value type */
+						  SQL_WVARCHAR,	/* param type */
+						  MAXLEN,		/* column size */
+						  0,			/* dec digits */
+						  wparam,		/* param value ptr */
+						  sizeof(wparam), /* buffer len */
+						  &cbParam		/* StrLen_or_IndPtr */);
+	CHECK_STMT_RESULT(rc, "SQLBindParameter failed", hstmt);
+	rc = SQLExecDirect(hstmt, (SQLCHAR *) "SELECT ?::text", SQL_NTS);
+	CHECK_STMT_RESULT(rc, "SQLExecDirect failed", hstmt);
+	rc = SQLFetch(hstmt);
+	CHECK_STMT_RESULT(rc, "SQLFetch failed", hstmt);
+	rc = SQLGetData(hstmt, 1, SQL_C_CHAR, buf, sizeof(buf), &ind);
+	CHECK_STMT_RESULT(rc, "SQLGetData failed", hstmt);
+	if (strcmp(buf, expected) == 0)
+		printf("%d chars ok\n", (int) ind);
+	else
+		printf("mismatch: %s\n", buf);
+	rc = SQLFreeStmt(hstmt, SQL_CLOSE);
+	CHECK_STMT_RESULT(rc, "SQLFreeStmt failed", hstmt);
+
+	/* Clean up */
+	test_disconnect();
+
+	return 0;
+}
@@ -12,6 +12,28 @@
 #include <string.h>
 #include <ctype.h>
 
+/*
+ * The runs of ASCII characters, which are most of the text in practice,
+ * are scanned and copied 16 bytes at a time with SSE2 where it's
+ * available, i.e. on any x86-64.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define	USE_SSE2
+#include <emmintrin.h>
+#ifdef	_MSC_VER
+#include <intrin.h>
+static int lowest_bit(unsigned int mask)
+{
+	unsigned long	idx;
+
+	_BitScanForward(&idx, mask);
+	return (int) idx;
+}
+#else
+#define	lowest_bit(mask)	__builtin_ctz(mask)
+#endif /* _MSC_VER */
+#endif /* __SSE2__ */
+
 #define	byte3check	0xfffff800
 #define	byte2_base	0x80c0
 #define	byte2_mask1	0x07c0
@@ -41,6 +63,121 @@ SQLULEN	ucs2strlen(const SQLWCHAR *ucs2str)
 		;
 	return len;
 }
+
+/*
+ * The number of non-NUL ASCII characters at the head of 'wstr', at most 'len'.
+ */
+static SQLLEN ucs2_ascii_run(const SQLWCHAR *wstr, SQLLEN len)
+{
+	SQLLEN	i = 0;
+
+#ifdef	USE_SSE2
+	if (sizeof(SQLWCHAR) == 2)
+	{
+		const __m128i	zero = _mm_setzero_si128();
+		const __m128i	nonascii = _mm_set1_epi16((short) 0xff80);
+
+		for (; i + 8 <= len; i += 8)
+		{
+			__m128i	chunk = _mm_loadu_si128((const __m128i *) (wstr + i));
+			int	mask = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chunk, nonascii), zero)) &
+					~_mm_movemask_epi8(_mm_cmpeq_epi16(chunk, zero));
+
+			if (0xffff != mask)
+				return i + lowest_bit(~mask & 0xffff) / 2;
+		}
+	}
+#endif /* USE_SSE2 */
+	for (; i < len; i++)
+	{
+		if (0 == wstr[i] || 0 != (wstr[i] & 0xffffff80))
+			break;
+	}
+	return i;
+}
+
+/*
+ * Narrow 'len' ASCII characters to 'dst'.
+ */
+static void ucs2_to_ascii(const SQLWCHAR *src, SQLLEN len, char *dst)
+{
+	SQLLEN	i = 0;
+
+#ifdef	USE_SSE2
+	if (sizeof(SQLWCHAR) == 2)
+	{
+		for (; i + 8 <= len; i += 8)
+		{
+			__m128i	chunk = _mm_loadu_si128((const __m128i *) (src + i));
+
+			_mm_storel_epi64((__m128i *) (dst + i), _mm_packus_epi16(chunk, chunk));
+		}
+	}
+#endif /* USE_SSE2 */
+	for (; i < len; i++)
+		dst[i] = (char) src[i];
+}
+
+/*
+ * The number of non-NUL ASCII bytes at the head of 'str', at most 'len',
+ * also stopping at a LF if 'stoplf'.
+ */
+static SQLLEN utf8_ascii_run(const UCHAR *str, SQLLEN len, BOOL stoplf)
+{
+	SQLLEN	i = 0;
+
+#ifdef	USE_SSE2
+	{
+		const __m128i	zero = _mm_setzero_si128();
+		const __m128i	lf = _mm_set1_epi8(PG_LINEFEED);
+
+		for (; i + 16 <= len; i += 16)
+		{
+			__m128i	chunk = _mm_loadu_si128((const __m128i *) (str + i));
+			int	mask = _mm_movemask_epi8(chunk) |
+					_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero));
+
+			if (stoplf)
+				mask |= _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, lf));
+			if (0 != mask)
+				return i + lowest_bit(mask);
+		}
+	}
+#endif /* USE_SSE2 */
+	for (; i < len; i++)
+	{
+		if (0 != (str[i] & 0x80) || 0 == str[i] ||
+		    (stoplf && PG_LINEFEED == str[i]))
+			break;
+	}
+	return i;
+}
+
+/*
+ * Widen 'len' ASCII bytes to 'dst'.
+ */
+static void ascii_to_ucs2(const UCHAR *src, SQLLEN len, SQLWCHAR *dst)
+{
+	SQLLEN	i = 0;
+
+#ifdef	USE_SSE2
+	if (sizeof(SQLWCHAR) == 2)
+	{
+		const __m128i	zero = _mm_setzero_si128();
+
+		for (; i + 16 <= len; i += 16)
+		{
+			__m128i	chunk = _mm_loadu_si128((const __m128i *) (src + i));
+
+			_mm_storeu_si128((__m128i *) (dst + i), _mm_unpacklo_epi8(chunk, zero));
+			_mm_storeu_si128((__m128i *) (dst + i + 8), _mm_unpackhi_epi8(chunk, zero));
+		}
+	}
+#endif /* USE_SSE2 */
+	for (; i < len; i++)
+		dst[i] = src[i];
+}
+
 char *ucs2_to_utf8(const SQLWCHAR *ucs2str, SQLLEN ilen, SQLLEN *olen, BOOL lower_identifier)
 {
 	char *	utf8str;
@@ -76,7 +213,15 @@ char *ucs2_to_utf8(const SQLWCHAR *ucs2str, SQLLEN ilen, SQLLEN *olen, BOOL lowe
 				if (lower_identifier)
 					utf8str[len++] = (char) tolower(*wstr);
 				else
-					utf8str[len++] = (char) *wstr;
+				{
+					/* copy the whole run of ASCII characters */
+					int	run = (int) ucs2_ascii_run(wstr, ilen - i);
+
+					ucs2_to_ascii(wstr, run, utf8str + len);
+					len += run;
+					i += run - 1;
+					wstr += run - 1;
+				}
 			}
 			else if ((*wstr & byte3check) == 0)
 			{
@@ -189,6 +334,21 @@ utf8_to_ucs2_lf(const char *utf8str, SQLLEN ilen, BOOL lfconv,
 	{
 		if ((*str & 0x80) == 0)
 		{
+			/*
+			 * Copy the whole run of ASCII characters up to the next LF
+			 * to convert, if any.
+			 */
+			SQLLEN	run = utf8_ascii_run(str, ilen - i, lfconv);
+
+			if (run > 0)
+			{
+				if (ocount < bufcount)
+					ascii_to_ucs2(str, bufcount - ocount < (SQLULEN) run ? (SQLLEN) (bufcount - ocount) : run, ucs2str + ocount);
+				ocount += run;
+				i += (int) run;
+				str += run;
+				continue;
+			}
 			if (lfconv && PG_LINEFEED == *str &&
 			    (i == 0 || PG_CARRIAGE_RETURN != str[-1]))
 			{
@@ -305,6 +465,90 @@ cleanup:
 	return rtn;
 }
 
+/*
+ * Convert the next piece of the null-terminated UTF-8 string 'utf8str',
+ * from byte *pos, to at most 'bufcount' UCS-2 characters, for the pieces
+ * of a long value returned by SQLGetData. *pos is advanced past what was
+ * converted. The second half of a surrogate pair, or the LF after an
+ * inserted CR, that doesn't fit is kept in *pending and stored first by
+ * the next call. The pieces put together are what utf8_to_ucs2_lf()
+ * returns for the whole string. Returns the number of characters stored,
+ * without a terminator.
+ */
+SQLULEN
+utf8_to_ucs2_next(const char *utf8str, BOOL lfconv, SQLWCHAR *ucs2str,
+				  SQLULEN bufcount, SQLLEN *pos, SQLWCHAR *pending)
+{
+	const UCHAR *str = (const UCHAR *) utf8str;
+	SQLLEN		i = *pos, clen, run;
+	SQLULEN		ocount = 0, n;
+	SQLWCHAR	wbuf[3];
+
+	if (0 != *pending && ocount < bufcount)
+	{
+		ucs2str[ocount++] = *pending;
+		*pending = 0;
+	}
+	while (ocount < bufcount && 0 != str[i])
+	{
+		if (0 == (str[i] & 0x80))
+		{
+			run = utf8_ascii_run(str + i, (SQLLEN) (bufcount - ocount), lfconv);
+			if (run > 0)
+			{
+				ascii_to_ucs2(str + i, run, ucs2str + ocount);
+				ocount += run;
+				i += run;
+				continue;
+			}
+			if (lfconv && PG_LINEFEED == str[i] &&
+			    (i == 0 || PG_CARRIAGE_RETURN != str[i - 1]))
+			{
+				wbuf[0] = PG_CARRIAGE_RETURN;
+				wbuf[1] = PG_LINEFEED;
+				n = 2;
+			}
+			else
+			{
+				wbuf[0] = str[i];
+				n = 1;
+			}
+			clen = 1;
+		}
+		else
+		{
+			if (0xf0 == (str[i] & 0xf8))
+				clen = 4;
+			else if (0xe0 == (str[i] & 0xf0))
+				clen = 3;
+			else if (0xc0 == (str[i] & 0xe0))
+				clen = 2;
+			else
+				break;
+			for (n = 1; n < (SQLULEN) clen && 0 != str[i + n]; n++)
+				;
+			if (n < (SQLULEN) clen)
+				break;
+			n = utf8_to_ucs2_lf((const char *) str + i, clen, FALSE, wbuf, 3, FALSE);
+			if (0 == n)
+				break;
+		}
+		ucs2str[ocount++] = wbuf[0];
+		if (n > 1)
+		{
+			if (ocount < bufcount)
+				ucs2str[ocount++] = wbuf[1];
+			else
+				*pending = wbuf[1];
+		}
+		i += clen;
+	}
+	*pos = i;
+
+	return ocount;
+}
+
+
 int msgtowstr(const char *inmsg, int inlen, LPWSTR outmsg, int buflen)
 {
 	int	outlen;